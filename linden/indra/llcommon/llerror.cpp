@@ -60,6 +60,7 @@
 #include "llsd.h"
 #include "llsdserialize.h"
 #include "llstl.h"
+#include "llthread.h"
 #include "lltimer.h"
 
 extern apr_thread_mutex_t* gCallStacksLogMutexp;
@@ -351,7 +352,6 @@ namespace
 
 	typedef std::map<std::string, LLError::ELevel> LevelMap;
 	typedef std::vector<LLError::Recorder*> Recorders;
-	typedef std::vector<LLError::CallSite*> CallSiteVector;
 
 	class Globals
 	{
@@ -359,36 +359,29 @@ namespace
 		std::ostringstream messageStream;
 		bool messageStreamInUse;
 
-		void addCallSite(LLError::CallSite&);
 		void invalidateCallSites();
 		
 		static Globals& get();
 			// return the one instance of the globals
 
 	private:
-		CallSiteVector callSites;
-
 		Globals()
 			:	messageStreamInUse(false)
 			{ }
 		
 	};
 
-	void Globals::addCallSite(LLError::CallSite& site)
-	{
-		callSites.push_back(&site);
-	}
-	
 	void Globals::invalidateCallSites()
 	{
-		for (CallSiteVector::const_iterator i = callSites.begin();
-			 i != callSites.end();
-			 ++i)
+		// Rather than walking every call site that has ever cached a
+		// decision, start a new generation: each site notices on its next
+		// shouldLog() and re-evaluates exactly once.
+		++LLError::Log::sSettingsGeneration;
+		if (LLError::Log::sSettingsGeneration == 0)
 		{
-			(*i)->invalidate();
+			// 0 is reserved for "never evaluated"
+			LLError::Log::sSettingsGeneration = 1;
 		}
-		
-		callSites.clear();
 	}
 
 	Globals& Globals::get()
@@ -426,6 +419,7 @@ namespace LLError
 		Recorder* fileRecorder;
 		Recorder* fixedBufferRecorder;
 		std::string fileRecorderFileName;
+		bool asyncFileRecording;
 		
 		int shouldLogCallCounter;
 		
@@ -443,6 +437,7 @@ namespace LLError
 				timeFunction(NULL),
 				fileRecorder(NULL),
 				fixedBufferRecorder(NULL),
+				asyncFileRecording(false),
 				shouldLogCallCounter(0)
 			{ }
 		
@@ -513,13 +508,10 @@ namespace LLError
 					bool printOnce)
 		: mLevel(level), mFile(file), mLine(line),
 		  mClassInfo(class_info), mFunction(function),
-		  mCached(false), mShouldLog(false), 
+		  mCachedGeneration(0), mShouldLog(false), 
 		  mBroadTag(broadTag), mNarrowTag(narrowTag), mPrintOnce(printOnce)
 		{ }
 
-
-	void CallSite::invalidate()
-		{ mCached = false; }
 }
 
 namespace
@@ -788,8 +780,15 @@ namespace LLError
 		}
 
 		s.fileRecorderFileName = file_name;
-		s.fileRecorder = f;
-		addRecorder(f);
+		if (s.asyncFileRecording)
+		{
+			s.fileRecorder = new AsyncRecorder(f);
+		}
+		else
+		{
+			s.fileRecorder = f;
+		}
+		addRecorder(s.fileRecorder);
 	}
 	
 	void logToFixedBuffer(LLFixedBuffer* fixedBuffer)
@@ -814,6 +813,270 @@ namespace LLError
 		LLError::Settings& s = LLError::Settings::get();
 		return s.fileRecorderFileName;
 	}
+
+	void setAsyncFileRecording(bool async)
+	{
+		LLError::Settings& s = LLError::Settings::get();
+		if (s.asyncFileRecording == async)
+		{
+			return;
+		}
+		s.asyncFileRecording = async;
+
+		if (s.fileRecorder)
+		{
+			// reopen so the recorder gets (un)wrapped; the file is
+			// opened for append, so nothing already written is lost
+			std::string file_name = s.fileRecorderFileName;
+			logToFile(file_name);
+		}
+	}
+}
+
+namespace
+{
+	// Must be a power of two so the free running indices wrap cleanly.
+	const U32 ASYNC_RING_SIZE = 1024;
+	// Shutdown gives up on a writer that has made no progress for this long.
+	const U32 ASYNC_STALL_TIMEOUT_MS = 250;
+}
+
+namespace LLError
+{
+	class AsyncRecorder::Impl : public LLThread
+	{
+	public:
+		Impl(Recorder* target);
+		~Impl();
+
+		void push(ELevel level, const std::string& message);
+		void flush();
+		void stop();
+		U32 getQueuedCount();
+
+		Recorder* mTarget;
+		LLCondition* mCondition;
+			// guards everything below and is signalled whenever the
+			// head or tail moves. Producers normally hold gLogMutexp
+			// already, but LogLock gives up after a few tries, so the
+			// ring can't count on a single producer.
+		U32 mHead;				// next slot the producer fills
+		U32 mTail;				// next slot the consumer writes
+		bool mConsumerActive;	// set while run() owns the read side
+		bool mStopRequested;
+		U32 mOverflows;
+
+	private:
+		/*virtual*/ void run();
+		void drainLocked();
+			// writes everything queued from the calling thread; only
+			// for use once the consumer has gone
+
+		struct Entry
+		{
+			ELevel mLevel;
+			std::string mMessage;
+				// never cleared, so the string's buffer is reused and a
+				// steady stream of messages does not allocate
+		};
+		Entry mRing[ASYNC_RING_SIZE];
+			// slots in [mTail, mHead) belong to the consumer, the rest
+			// to the producer; ownership only changes under mCondition
+	};
+
+	AsyncRecorder::Impl::Impl(Recorder* target)
+		: LLThread("Log Writer"),
+		  mTarget(target),
+		  mCondition(new LLCondition),
+		  mHead(0),
+		  mTail(0),
+		  mConsumerActive(false),
+		  mStopRequested(false),
+		  mOverflows(0)
+	{
+	}
+
+	AsyncRecorder::Impl::~Impl()
+	{
+		delete mCondition;
+	}
+
+	void AsyncRecorder::Impl::push(ELevel level, const std::string& message)
+	{
+		LLMutexLock lock(mCondition);
+		if (mHead - mTail >= ASYNC_RING_SIZE)
+		{
+			mOverflows++;
+			while (mConsumerActive && mHead - mTail >= ASYNC_RING_SIZE)
+			{
+				mCondition->wait();
+			}
+			if (!mConsumerActive)
+			{
+				// the drain thread has gone; nobody else reads the
+				// ring, so it is safe to empty it here
+				drainLocked();
+			}
+		}
+
+		Entry& entry = mRing[mHead & (ASYNC_RING_SIZE - 1)];
+		entry.mLevel = level;
+		entry.mMessage.assign(message);
+		mHead++;
+		mCondition->broadcast();
+	}
+
+	void AsyncRecorder::Impl::drainLocked()
+	{
+		for ( ; mTail != mHead; ++mTail)
+		{
+			Entry& entry = mRing[mTail & (ASYNC_RING_SIZE - 1)];
+			mTarget->recordMessage(entry.mLevel, entry.mMessage);
+		}
+	}
+
+	void AsyncRecorder::Impl::flush()
+	{
+		LLMutexLock lock(mCondition);
+		while (mConsumerActive && mTail != mHead)
+		{
+			mCondition->wait();
+		}
+		if (!mConsumerActive)
+		{
+			drainLocked();
+		}
+	}
+
+	void AsyncRecorder::Impl::stop()
+	{
+		mCondition->lock();
+		mStopRequested = true;
+		mCondition->broadcast();
+		mCondition->unlock();
+
+		// Let the writer finish the backlog as long as it keeps moving,
+		// but don't hold up shutdown for one stuck in the target.
+		U32 last_tail = 0;
+		U32 stalled_ms = 0;
+		while (stalled_ms < ASYNC_STALL_TIMEOUT_MS)
+		{
+			mCondition->lock();
+			bool active = mConsumerActive;
+			U32 tail = mTail;
+			if (!active)
+			{
+				// picks up anything logged by the thread on its way out
+				drainLocked();
+			}
+			mCondition->unlock();
+			if (!active)
+			{
+				return;
+			}
+			stalled_ms = (tail == last_tail) ? stalled_ms + 1 : 0;
+			last_tail = tail;
+			ms_sleep(1);
+		}
+	}
+
+	U32 AsyncRecorder::Impl::getQueuedCount()
+	{
+		LLMutexLock lock(mCondition);
+		return mHead - mTail;
+	}
+
+	//virtual
+	void AsyncRecorder::Impl::run()
+	{
+		mCondition->lock();
+		while (true)
+		{
+			while (!mStopRequested && mTail == mHead)
+			{
+				mCondition->wait();
+			}
+			if (mTail == mHead)
+			{
+				break;
+			}
+
+			// Write the published slots without holding the lock; the
+			// producer won't touch them until mTail moves past them.
+			U32 tail = mTail;
+			U32 head = mHead;
+			mCondition->unlock();
+			for ( ; tail != head; ++tail)
+			{
+				Entry& entry = mRing[tail & (ASYNC_RING_SIZE - 1)];
+				mTarget->recordMessage(entry.mLevel, entry.mMessage);
+			}
+			mCondition->lock();
+			mTail = tail;
+			mCondition->broadcast();
+		}
+		mConsumerActive = false;
+		mCondition->broadcast();
+		mCondition->unlock();
+	}
+
+	AsyncRecorder::AsyncRecorder(Recorder* target)
+		: mImpl(new Impl(target))
+	{
+		// set before the thread exists so producers never see a gap
+		// where neither side owns the read end
+		mImpl->mConsumerActive = true;
+		mImpl->start();
+	}
+
+	AsyncRecorder::~AsyncRecorder()
+	{
+		mImpl->stop();
+		mImpl->mCondition->lock();
+		bool active = mImpl->mConsumerActive;
+		mImpl->mCondition->unlock();
+		if (active)
+		{
+			// The thread is wedged in the target; leak both rather than
+			// pull the recorder out from under it.
+			std::cerr << "AsyncRecorder: log writer thread did not stop" << std::endl;
+			return;
+		}
+		delete mImpl->mTarget;
+		delete mImpl;
+	}
+
+	//virtual
+	void AsyncRecorder::recordMessage(ELevel level, const std::string& message)
+	{
+		mImpl->push(level, message);
+		if (level == LEVEL_ERROR)
+		{
+			mImpl->flush();
+		}
+	}
+
+	//virtual
+	bool AsyncRecorder::wantsTime()
+	{
+		return mImpl->mTarget->wantsTime();
+	}
+
+	void AsyncRecorder::flush()
+	{
+		mImpl->flush();
+	}
+
+	U32 AsyncRecorder::getQueuedCount() const
+	{
+		return mImpl->getQueuedCount();
+	}
+
+	U32 AsyncRecorder::getOverflowCount() const
+	{
+		LLMutexLock lock(mImpl->mCondition);
+		return mImpl->mOverflows;
+	}
 }
 
 namespace
@@ -944,6 +1207,8 @@ namespace {
 
 namespace LLError
 {
+	U32 Log::sSettingsGeneration = 1;
+
 	bool Log::shouldLog(CallSite& site)
 	{
 		LogLock lock;
@@ -952,8 +1217,8 @@ namespace LLError
 			return false;
 		}
 		
-		Globals& g = Globals::get();
 		Settings& s = Settings::get();
+		U32 generation = sSettingsGeneration;
 		
 		s.shouldLogCallCounter += 1;
 		
@@ -976,9 +1241,9 @@ namespace LLError
 		|| checkLevelMap(s.fileLevelMap, abbreviateFile(site.mFile), compareLevel)
 		|| ((site.mBroadTag != NULL) ? checkLevelMap(s.tagLevelMap, site.mBroadTag, compareLevel) : false);
 
-		site.mCached = true;
-		g.addCallSite(site);
-		return site.mShouldLog = site.mLevel >= compareLevel;
+		site.mShouldLog = site.mLevel >= compareLevel;
+		site.mCachedGeneration = generation;
+		return site.mShouldLog;
 	}
 
 
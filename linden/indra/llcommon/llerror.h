@@ -138,6 +138,11 @@ namespace LLError
 		static std::ostringstream* out();
 		static void flush(std::ostringstream* out, char* message)  ;
 		static void flush(std::ostringstream*, const CallSite&);
+
+		static U32 sSettingsGeneration;
+			// bumped whenever the level settings change; a CallSite's
+			// cached decision is only valid for the generation it was
+			// computed in
 	};
 	
 	class LL_COMMON_API CallSite
@@ -150,11 +155,9 @@ namespace LLError
 				const std::type_info& class_info, const char* function, const char* broadTag, const char* narrowTag, bool printOnce);
 						
 		bool shouldLog()
-			{ return mCached ? mShouldLog : Log::shouldLog(*this); }
+			{ return (mCachedGeneration == Log::sSettingsGeneration) ? mShouldLog : Log::shouldLog(*this); }
 			// this member function needs to be in-line for efficiency
 		
-		void invalidate();
-		
 	private:
 		// these describe the call site and never change
 		const ELevel			mLevel;
@@ -167,7 +170,7 @@ namespace LLError
 		const bool			mPrintOnce;
 		
 		// these implement a cache of the call to shouldLog()
-		bool mCached;
+		U32 mCachedGeneration;
 		bool mShouldLog;
 		
 		friend class Log;
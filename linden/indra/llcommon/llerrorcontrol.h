@@ -130,6 +130,44 @@ namespace LLError
 	LL_COMMON_API std::string logFileName();
 		// returns name of current logging file, empty string if none
 
+	LL_COMMON_API void setAsyncFileRecording(bool async);
+		// When set, the file recorder installed by logToFile() is wrapped
+		// in an AsyncRecorder so that disk writes happen on a background
+		// thread.  Takes effect immediately if a log file is open.
+
+
+	class LL_COMMON_API AsyncRecorder : public Recorder
+	{
+		// Hands messages to a wrapped recorder on a background thread.
+		// recordMessage() copies the message into a fixed size ring and
+		// returns; the drain thread is the only reader.  Slots change
+		// hands under a mutex and the drain thread writes them to the
+		// target outside it.
+		// A LEVEL_ERROR message drains the ring before returning, so the
+		// log is complete when the fatal function runs.
+	public:
+		AsyncRecorder(Recorder* target);
+			// takes ownership of target
+		~AsyncRecorder();
+			// writes any queued messages, stops the thread and deletes
+			// the target; gives up after a short time if the thread
+			// stops making progress
+
+		virtual void recordMessage(LLError::ELevel, const std::string& message);
+		virtual bool wantsTime();
+
+		void flush();
+			// blocks until every queued message has been written
+
+		U32 getQueuedCount() const;
+		U32 getOverflowCount() const;
+			// number of times a producer had to wait for a full ring
+
+	private:
+		class Impl;
+		Impl* mImpl;
+	};
+
 
 	/*
 		Utilities for use by the unit tests of LLError itself.
@@ -33,6 +33,11 @@
 
 #include "llfasttimer.h"
 
+#include <ostream>
+#include <vector>
+
+#include "llthread.h"
+
 #include "llprocessor.h"
 
 
@@ -51,19 +56,45 @@
 // statics
 
 
-LLFastTimer::EFastTimerType LLFastTimer::sCurType = LLFastTimer::FTM_OTHER;
-int LLFastTimer::sCurDepth = 0;
-U64 LLFastTimer::sStart[LLFastTimer::FTM_MAX_DEPTH];
-U64 LLFastTimer::sCounter[LLFastTimer::FTM_NUM_TYPES];
-U64 LLFastTimer::sCountHistory[LLFastTimer::FTM_HISTORY_NUM][LLFastTimer::FTM_NUM_TYPES];
-U64 LLFastTimer::sCountAverage[LLFastTimer::FTM_NUM_TYPES];
-U64 LLFastTimer::sCalls[LLFastTimer::FTM_NUM_TYPES];
-U64 LLFastTimer::sCallHistory[LLFastTimer::FTM_HISTORY_NUM][LLFastTimer::FTM_NUM_TYPES];
-U64 LLFastTimer::sCallAverage[LLFastTimer::FTM_NUM_TYPES];
+U64 LLFastTimer::sCounter[LLFastTimer::FTM_MAX_TIMERS];
+U64 LLFastTimer::sCountHistory[LLFastTimer::FTM_HISTORY_NUM][LLFastTimer::FTM_MAX_TIMERS];
+U64 LLFastTimer::sCountAverage[LLFastTimer::FTM_MAX_TIMERS];
+U64 LLFastTimer::sCalls[LLFastTimer::FTM_MAX_TIMERS];
+U64 LLFastTimer::sCallHistory[LLFastTimer::FTM_HISTORY_NUM][LLFastTimer::FTM_MAX_TIMERS];
+U64 LLFastTimer::sCallAverage[LLFastTimer::FTM_MAX_TIMERS];
 S32 LLFastTimer::sCurFrameIndex = -1;
 S32 LLFastTimer::sLastFrameIndex = -1;
 int LLFastTimer::sPauseHistory = 0;
 int LLFastTimer::sResetHistory = 0;
+bool LLFastTimer::sTracing = false;
+
+// Timer names and the thread state registry are function statics so
+// that they exist before any DeclareTimer or thread local data is
+// constructed.
+static std::vector<std::string>& timer_names()
+{
+	static std::vector<std::string> names(LLFastTimer::FTM_MAX_TIMERS);
+	return names;
+}
+
+static S32 sNamedTimerCount = 0;
+
+typedef std::vector<LLFastTimerThreadState*> thread_state_list_t;
+static thread_state_list_t& thread_states()
+{
+	static thread_state_list_t states;
+	return states;
+}
+
+// Guards the thread state list and the trace rings. Created by the
+// first createThreadState(), which AIThreadLocalData::init() calls on
+// the main thread before any other thread exists.
+static LLMutex* sThreadStateMutex = NULL;
+
+// The main thread runs nearly all timers, so its state is kept here to
+// save it the thread local data lookup in every LLFastTimer.
+static LLFastTimerThreadState* sMainThreadState = NULL;
+static apr_os_thread_t sMainThreadID;
 
 F64 LLFastTimer::sCPUClockFrequency = 0.0;
 
@@ -156,10 +187,12 @@ void LLFastTimer::reset()
 {
 	countsPerSecond(); // good place to calculate clock frequency
 	
-	if (sCurDepth != 0)
+	LLFastTimerThreadState* state = getThreadState();
+	if (state->mCurDepth != 0)
 	{
 		llerrs << "LLFastTimer::Reset() when sCurDepth != 0" << llendl;
 	}
+	flushEvents(state);
 	if (sPauseHistory)
 	{
 		sResetHistory = 1;
@@ -172,7 +205,7 @@ void LLFastTimer::reset()
 	else if (sCurFrameIndex >= 0)
 	{
 		int hidx = sCurFrameIndex % FTM_HISTORY_NUM;
-		for (S32 i=0; i<FTM_NUM_TYPES; i++)
+		for (S32 i=0; i<FTM_MAX_TIMERS; i++)
 		{
 			sCountHistory[hidx][i] = sCounter[i];
 			sCountAverage[i] = (sCountAverage[i]*sCurFrameIndex + sCounter[i]) / (sCurFrameIndex+1);
@@ -183,7 +216,7 @@ void LLFastTimer::reset()
 	}
 	else
 	{
-		for (S32 i=0; i<FTM_NUM_TYPES; i++)
+		for (S32 i=0; i<FTM_MAX_TIMERS; i++)
 		{
 			sCountAverage[i] = 0;
 			sCallAverage[i] = 0;
@@ -192,12 +225,265 @@ void LLFastTimer::reset()
 	
 	sCurFrameIndex++;
 	
-	for (S32 i=0; i<FTM_NUM_TYPES; i++)
+	for (S32 i=0; i<FTM_MAX_TIMERS; i++)
 	{
 		sCounter[i] = 0;
 		sCalls[i] = 0;
 	}
-	sCurDepth = 0;
+	state->mCurDepth = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Named timers
+//
+
+LLFastTimer::DeclareTimer::DeclareTimer(const std::string& name)
+{
+	if (sNamedTimerCount < FTM_MAX_NAMED_TIMERS)
+	{
+		mIndex = FTM_NUM_TYPES + sNamedTimerCount++;
+		timer_names()[mIndex] = name;
+	}
+	else
+	{
+		// Out of slots; this usually runs before logging is up, so
+		// just lump the time in with everything else.
+		mIndex = FTM_OTHER;
+	}
+}
+
+//static
+void LLFastTimer::setTimerName(S32 index, const std::string& name)
+{
+	if (index >= 0 && index < FTM_MAX_TIMERS)
+	{
+		timer_names()[index] = name;
+	}
+}
+
+//static
+std::string LLFastTimer::getTimerName(S32 index)
+{
+	if (index >= 0 && index < FTM_MAX_TIMERS && !timer_names()[index].empty())
+	{
+		return timer_names()[index];
+	}
+	return llformat("Timer %d", index);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Per thread state
+//
+
+//static
+LLFastTimerThreadState* LLFastTimer::createThreadState(const std::string& name, bool is_main_thread)
+{
+	if (!sThreadStateMutex)
+	{
+		sThreadStateMutex = new LLMutex(AIAPRRootPool::get());
+	}
+	LLMutexLock lock(sThreadStateMutex);
+
+	// Reuse the state of a thread that has gone away, so a program
+	// which keeps starting short lived threads doesn't grow this list.
+	LLFastTimerThreadState* state = NULL;
+	thread_state_list_t& states = thread_states();
+	for (thread_state_list_t::iterator iter = states.begin(); iter != states.end(); ++iter)
+	{
+		if ((*iter)->mReleased)
+		{
+			state = *iter;
+			break;
+		}
+	}
+	if (!state)
+	{
+		state = new LLFastTimerThreadState;
+		state->mThreadIndex = (S32)states.size();
+		states.push_back(state);
+	}
+	state->mCurDepth = 0;
+	state->mIsMainThread = is_main_thread;
+	state->mReleased = false;
+	state->mName = name;
+	state->mPendingCount = 0;
+	state->mEventCount = 0;
+	if (is_main_thread)
+	{
+		sMainThreadState = state;
+		sMainThreadID = apr_os_thread_current();
+	}
+	return state;
+}
+
+//static
+void LLFastTimer::releaseThreadState(LLFastTimerThreadState* state)
+{
+	if (state && sThreadStateMutex)
+	{
+		// Called on the exiting thread, so its batch can still be moved.
+		flushEvents(state);
+		LLMutexLock lock(sThreadStateMutex);
+		state->mReleased = true;
+	}
+}
+
+//static
+LLFastTimerThreadState* LLFastTimer::getThreadState()
+{
+	if (sMainThreadState && apr_os_thread_equal(sMainThreadID, apr_os_thread_current()))
+	{
+		return sMainThreadState;
+	}
+	return AIThreadLocalData::tldata().mFastTimerState;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// Tracing
+//
+
+//static
+void LLFastTimer::setTracing(bool enabled)
+{
+	sTracing = enabled;
+}
+
+//static
+void LLFastTimer::recordEvent(LLFastTimerThreadState* state, S32 index, U64 start, U64 duration, S32 depth)
+{
+	LLFastTimerEvent& event = state->mPending[state->mPendingCount++];
+	event.mStart = start;
+	event.mDuration = duration;
+	event.mType = index;
+	event.mDepth = depth;
+	event.mFrame = sCurFrameIndex;
+	if (state->mPendingCount == FTM_TRACE_BATCH)
+	{
+		flushEvents(state);
+	}
+}
+
+// Must be called on the thread that owns state.
+//static
+void LLFastTimer::flushEvents(LLFastTimerThreadState* state)
+{
+	if (!state->mPendingCount)
+	{
+		return;
+	}
+	if (!sThreadStateMutex)
+	{
+		state->mPendingCount = 0;
+		return;
+	}
+	LLMutexLock lock(sThreadStateMutex);
+	if (!state->mEvents)
+	{
+		state->mEvents = new LLFastTimerEvent[FTM_TRACE_EVENTS];
+	}
+	for (U32 i = 0; i < state->mPendingCount; ++i)
+	{
+		state->mEvents[state->mEventCount % FTM_TRACE_EVENTS] = state->mPending[i];
+		state->mEventCount++;
+	}
+	state->mPendingCount = 0;
+}
+
+// Quotes, backslashes and control characters can't appear raw in a
+// JSON string.
+static std::string json_escape(const std::string& str)
+{
+	std::string escaped;
+	escaped.reserve(str.size());
+	for (std::string::const_iterator iter = str.begin(); iter != str.end(); ++iter)
+	{
+		char c = *iter;
+		if (c == '"' || c == '\\')
+		{
+			escaped += '\\';
+			escaped += c;
+		}
+		else if ((unsigned char)c < 0x20)
+		{
+			escaped += llformat("\\u%04x", (U32)(unsigned char)c);
+		}
+		else
+		{
+			escaped += c;
+		}
+	}
+	return escaped;
+}
+
+//static
+void LLFastTimer::writeChromeTrace(std::ostream& out, S32 frames)
+{
+	out << "{\"traceEvents\":[";
+	if (!sThreadStateMutex)
+	{
+		out << "]}\n";
+		return;
+	}
+
+	// Other threads' batches show up once they fill or the thread exits.
+	flushEvents(getThreadState());
+
+	LLMutexLock lock(sThreadStateMutex);
+	const S32 first_frame = sCurFrameIndex - frames;
+	const F64 usec_per_count = 1000000.0 / (F64)countsPerSecond();
+
+	// Find the earliest event so timestamps start near zero.
+	U64 base = 0;
+	bool have_base = false;
+	thread_state_list_t& states = thread_states();
+	thread_state_list_t::iterator iter;
+	for (iter = states.begin(); iter != states.end(); ++iter)
+	{
+		LLFastTimerThreadState* state = *iter;
+		U32 count = llmin(state->mEventCount, (U32)FTM_TRACE_EVENTS);
+		for (U32 i = state->mEventCount - count; i < state->mEventCount; ++i)
+		{
+			const LLFastTimerEvent& event = state->mEvents[i % FTM_TRACE_EVENTS];
+			if (event.mFrame >= first_frame && (!have_base || event.mStart < base))
+			{
+				base = event.mStart;
+				have_base = true;
+			}
+		}
+	}
+
+	bool first = true;
+	for (iter = states.begin(); iter != states.end(); ++iter)
+	{
+		LLFastTimerThreadState* state = *iter;
+		if (!state->mEvents)
+		{
+			continue;
+		}
+
+		out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+			<< state->mThreadIndex << ",\"args\":{\"name\":\"" << json_escape(state->mName) << "\"}}";
+		first = false;
+
+		U32 count = llmin(state->mEventCount, (U32)FTM_TRACE_EVENTS);
+		for (U32 i = state->mEventCount - count; i < state->mEventCount; ++i)
+		{
+			const LLFastTimerEvent& event = state->mEvents[i % FTM_TRACE_EVENTS];
+			if (event.mFrame < first_frame)
+			{
+				continue;
+			}
+			out << ",\n{\"name\":\"" << json_escape(getTimerName(event.mType))
+				<< "\",\"cat\":\"fasttimer\",\"ph\":\"X\",\"pid\":1,\"tid\":" << state->mThreadIndex
+				<< ",\"ts\":" << llformat("%.3f", (F64)(event.mStart - base) * usec_per_count)
+				<< ",\"dur\":" << llformat("%.3f", (F64)event.mDuration * usec_per_count)
+				<< ",\"args\":{\"frame\":" << event.mFrame << ",\"depth\":" << event.mDepth << "}}";
+		}
+	}
+	out << "\n]}\n";
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -35,6 +35,12 @@
 
 #define FAST_TIMER_ON 1
 
+#include <iosfwd>
+#include <string>
+
+class LLMutex;
+class LLFastTimerThreadState;
+
 LL_COMMON_API U64 get_cpu_clock_count();
 
 class LL_COMMON_API LLFastTimer
@@ -193,58 +199,87 @@ public:
 	};
 	enum { FTM_HISTORY_NUM = 60 };
 	enum { FTM_MAX_DEPTH = 64 };
-	
-public:
-	static EFastTimerType sCurType;
+	// Timers declared with DeclareTimer are numbered after the fixed
+	// ones above.
+	enum { FTM_MAX_NAMED_TIMERS = 64 };
+	enum { FTM_MAX_TIMERS = FTM_NUM_TYPES + FTM_MAX_NAMED_TIMERS };
+	// Events kept per thread for trace export.
+	enum { FTM_TRACE_EVENTS = 32768 };
+	// Events a thread collects before handing them to its trace ring.
+	enum { FTM_TRACE_BATCH = 256 };
+
+	/**
+	 * A timer which doesn't need an entry in EFastTimerType:
+	 *
+	 *   static LLFastTimer::DeclareTimer FTM_DECODE("Image Decode");
+	 *   ...
+	 *   LLFastTimer t(FTM_DECODE);
+	 *
+	 * Declare these at file scope so that they are all registered
+	 * before any thread starts timing.
+	 */
+	class LL_COMMON_API DeclareTimer
+	{
+	public:
+		DeclareTimer(const std::string& name);
+		S32 getIndex() const { return mIndex; }
+	private:
+		S32 mIndex;
+	};
 
+public:
 	LLFastTimer(EFastTimerType type)
 	{
 #if FAST_TIMER_ON
-		mType = type;
-		sCurType = type;
-		// These don't get counted, because they use CPU clockticks
-		//gTimerBins[gCurTimerBin]++;
-		//LLTimer::sNumTimerCalls++;
-
-		U64 cpu_clocks = get_cpu_clock_count();
-
-		sStart[sCurDepth] = cpu_clocks;
-		sCurDepth++;
+		start(type);
 #endif
-	};
+	}
+	LLFastTimer(const DeclareTimer& timer)
+	{
+#if FAST_TIMER_ON
+		start(timer.getIndex());
+#endif
+	}
 	~LLFastTimer()
 	{
 #if FAST_TIMER_ON
-		U64 end,delta;
-		int i;
-
-		// These don't get counted, because they use CPU clockticks
-		//gTimerBins[gCurTimerBin]++;
-		//LLTimer::sNumTimerCalls++;
-		end = get_cpu_clock_count();
-
-		sCurDepth--;
-		delta = end - sStart[sCurDepth];
-		sCounter[mType] += delta;
-		sCalls[mType]++;
-		// Subtract delta from parents
-		for (i=0; i<sCurDepth; i++)
-			sStart[i] += delta;
+		stop();
 #endif
 	}
 
 	static void reset();
 	static U64 countsPerSecond();
 
+	// Timer names, used for trace export. Fixed timers have no name
+	// until the display code gives them one.
+	static void setTimerName(S32 index, const std::string& name);
+	static std::string getTimerName(S32 index);
+
+	// Per thread timer stacks, created and released by AIThreadLocalData
+	// as threads come and go.
+	static LLFastTimerThreadState* createThreadState(const std::string& name, bool is_main_thread);
+	static void releaseThreadState(LLFastTimerThreadState* state);
+
+	/**
+	 * While tracing, every timer records a begin/duration event on its
+	 * own thread. Events are batched up without locking and moved to
+	 * the thread's trace ring when the batch fills, at the end of each
+	 * main thread frame and when the thread exits. writeChromeTrace()
+	 * writes the last frames worth of events from all threads in the
+	 * Chrome trace event (JSON) format, for chrome://tracing.
+	 */
+	static void setTracing(bool enabled);
+	static bool isTracing() { return sTracing; }
+	static void writeChromeTrace(std::ostream& out, S32 frames);
+
 public:
-	static int sCurDepth;
-	static U64 sStart[FTM_MAX_DEPTH];
-	static U64 sCounter[FTM_NUM_TYPES];
-	static U64 sCalls[FTM_NUM_TYPES];
-	static U64 sCountAverage[FTM_NUM_TYPES];
-	static U64 sCallAverage[FTM_NUM_TYPES];
-	static U64 sCountHistory[FTM_HISTORY_NUM][FTM_NUM_TYPES];
-	static U64 sCallHistory[FTM_HISTORY_NUM][FTM_NUM_TYPES];
+	// Only the main thread's timers feed these.
+	static U64 sCounter[FTM_MAX_TIMERS];
+	static U64 sCalls[FTM_MAX_TIMERS];
+	static U64 sCountAverage[FTM_MAX_TIMERS];
+	static U64 sCallAverage[FTM_MAX_TIMERS];
+	static U64 sCountHistory[FTM_HISTORY_NUM][FTM_MAX_TIMERS];
+	static U64 sCallHistory[FTM_HISTORY_NUM][FTM_MAX_TIMERS];
 	static S32 sCurFrameIndex;
 	static S32 sLastFrameIndex;
 	static int sPauseHistory;
@@ -253,8 +288,87 @@ public:
     static U64 sClockResolution;
 	
 private:
-	EFastTimerType mType;
+	void start(S32 index);
+	void stop();
+
+	static LLFastTimerThreadState* getThreadState();
+	static void flushEvents(LLFastTimerThreadState* state);
+	static void recordEvent(LLFastTimerThreadState* state, S32 index, U64 start, U64 duration, S32 depth);
+
+	static bool sTracing;
+
+	S32 mType;
+	LLFastTimerThreadState* mState;
+};
+
+struct LLFastTimerEvent
+{
+	U64 mStart;
+	U64 mDuration;
+	S32 mType;
+	S32 mDepth;
+	S32 mFrame;
+};
+
+class LLFastTimerThreadState
+{
+public:
+	LLFastTimerThreadState() : mCurDepth(0), mIsMainThread(false), mReleased(false),
+		mPendingCount(0), mEvents(NULL), mEventCount(0) {}
+
+	S32 mCurDepth;
+	U64 mStart[LLFastTimer::FTM_MAX_DEPTH];
+	// Time spent in timers nested inside each level of the stack.
+	U64 mChildTime[LLFastTimer::FTM_MAX_DEPTH];
+	bool mIsMainThread;
+	bool mReleased;
+	S32 mThreadIndex;
+	std::string mName;
+
+	// Events not yet moved to the ring. Only touched by the owning thread.
+	LLFastTimerEvent mPending[LLFastTimer::FTM_TRACE_BATCH];
+	U32 mPendingCount;
+
+	// Trace ring, allocated on first use. Guarded by the thread state
+	// mutex in llfasttimer.cpp.
+	LLFastTimerEvent* mEvents;
+	U32 mEventCount;
 };
 
+#if FAST_TIMER_ON
+inline void LLFastTimer::start(S32 index)
+{
+	mType = index;
+	mState = getThreadState();
+	S32 depth = mState->mCurDepth++;
+	llassert(depth < FTM_MAX_DEPTH);
+	mState->mChildTime[depth] = 0;
+	// These don't get counted, because they use CPU clockticks
+	//gTimerBins[gCurTimerBin]++;
+	//LLTimer::sNumTimerCalls++;
+	mState->mStart[depth] = get_cpu_clock_count();
+}
+
+inline void LLFastTimer::stop()
+{
+	U64 end = get_cpu_clock_count();
+	S32 depth = --mState->mCurDepth;
+	U64 total = end - mState->mStart[depth];
+	// Parents only get charged for time not spent in their children.
+	if (depth > 0)
+	{
+		mState->mChildTime[depth - 1] += total;
+	}
+	if (mState->mIsMainThread)
+	{
+		sCounter[mType] += total - mState->mChildTime[depth];
+		sCalls[mType]++;
+	}
+	if (sTracing)
+	{
+		recordEvent(mState, mType, mState->mStart[depth], total, depth);
+	}
+}
+#endif
 
 #endif // LL_LLFASTTIMER_H
@@ -37,6 +37,7 @@
 #include "llthread.h"
 
 #include "lltimer.h"
+#include "llfasttimer.h"
 
 #if LL_LINUX || LL_SOLARIS
 #include <sched.h>
@@ -285,7 +286,9 @@ void AIThreadLocalData::init(void)
 //static
 void AIThreadLocalData::destroy(void* thread_local_data)
 {
-	delete reinterpret_cast<AIThreadLocalData*>(thread_local_data);
+	AIThreadLocalData* tld = reinterpret_cast<AIThreadLocalData*>(thread_local_data);
+	LLFastTimer::releaseThreadState(tld->mFastTimerState);
+	delete tld;
 }
 
 //static
@@ -296,6 +299,7 @@ void AIThreadLocalData::create(LLThread* threadp)
 	{
 		threadp->mThreadLocalData = new_tld;
 	}
+	new_tld->mFastTimerState = LLFastTimer::createThreadState(threadp ? threadp->mName : "main", !threadp);
 	apr_status_t status = apr_threadkey_private_set(new_tld, sThreadLocalDataKey);
 	llassert_always(status == APR_SUCCESS);
 }
@@ -43,6 +43,7 @@
 class LLThread;
 class LLMutex;
 class LLCondition;
+class LLFastTimerThreadState;
 
 class LL_COMMON_API AIThreadLocalData
 {
@@ -50,10 +51,15 @@ private:
 	static apr_threadkey_t* sThreadLocalDataKey;
 
 public:
+	AIThreadLocalData() : mFastTimerState(NULL) { }
+
 	// Thread-local memory pool.
 	AIAPRRootPool mRootPool;
 	AIVolatileAPRPool mVolatileAPRPool;
 
+	// This thread's fast timer stack.
+	LLFastTimerThreadState* mFastTimerState;
+
 	static void init(void);
 	static void destroy(void* thread_local_data);
 	static void create(LLThread* pthread);
@@ -45,6 +45,7 @@
 #include "llimagepng.h"
 #include "llimagedxt.h"
 #include "llimageworker.h"
+#include "llv4math.h"
 
 //---------------------------------------------------------------------------
 // LLImage
@@ -736,10 +737,12 @@ void LLImageRaw::copyScaled3onto4(LLImageRaw* src)
 {
 	llassert( (3 == src->getComponents()) && (4 == getComponents()) );
 
-	// Slow, but simple.  Optimize later if needed.
-	LLImageRaw temp( src->getWidth(), src->getHeight(), 4);
-	temp.copyUnscaled3onto4( src );
-	copyScaled( &temp );
+	// Scale the three color channels first, then add the opaque alpha.
+	// The filter treats channels independently, so this matches scaling
+	// an expanded copy without filtering a constant alpha channel.
+	LLImageRaw temp( getWidth(), getHeight(), 3);
+	temp.copyScaled( src );
+	copyUnscaled3onto4( &temp );
 }
 
 
@@ -820,10 +823,14 @@ void LLImageRaw::copyScaled( LLImageRaw* src )
 	std::vector<U8> temp_buffer(temp_data_size);
 
 	// Vertical
+#if LL_SCALE_IMAGE_ROWS
+	copyRowsScaled( src->getData(), &temp_buffer[0], getComponents() * src->getWidth(), src->getHeight(), dst->getHeight() );
+#else
 	for( S32 col = 0; col < src->getWidth(); col++ )
 	{
 		copyLineScaled( src->getData() + (getComponents() * col), &temp_buffer[0] + (getComponents() * col), src->getHeight(), dst->getHeight(), src->getWidth(), src->getWidth() );
 	}
+#endif
 
 	// Horizontal
 	for( S32 row = 0; row < dst->getHeight(); row++ )
@@ -900,10 +907,14 @@ BOOL LLImageRaw::scale( S32 new_width, S32 new_height, BOOL scale_image_data )
 		std::vector<U8> temp_buffer(temp_data_size);
 
 		// Vertical
+#if LL_SCALE_IMAGE_ROWS
+		copyRowsScaled( getData(), &temp_buffer[0], getComponents() * old_width, old_height, new_height );
+#else
 		for( S32 col = 0; col < old_width; col++ )
 		{
 			copyLineScaled( getData() + (getComponents() * col), &temp_buffer[0] + (getComponents() * col), old_height, new_height, old_width, old_width );
 		}
+#endif
 
 		deleteData();
 
@@ -1062,6 +1073,66 @@ void LLImageRaw::copyLineScaled( U8* in, U8* out, S32 in_pixel_len, S32 out_pixe
 	}
 }
 
+void LLImageRaw::copyRowsScaled( U8* in, U8* out, S32 row_bytes, S32 in_rows, S32 out_rows )
+{
+	const F32 ratio = F32(in_rows) / out_rows; // ratio of old to new
+	const F32 norm_factor = 1.f / ratio;
+
+	std::vector<F32> accum(row_bytes);
+
+	for( S32 y = 0; y < out_rows; y++ )
+	{
+		// Same sample interval arithmetic as copyLineScaled(), so results match it exactly.
+		const F32 sample0 = y * ratio;
+		const F32 sample1 = (y+1) * ratio;
+		const S32 index0 = llfloor(sample0);			// top integer (floor)
+		const S32 index1 = llfloor(sample1);			// bottom integer (floor)
+		const F32 fract0 = 1.f - (sample0 - F32(index0));	// spill over on top
+		const F32 fract1 = sample1 - F32(index1);			// spill-over on bottom
+
+		U8* outp = out + y * row_bytes;
+		if( index0 == index1 )
+		{
+			// Interval is embedded in one input row
+			memcpy(outp, in + index0 * row_bytes, row_bytes);		/* Flawfinder: ignore */
+			continue;
+		}
+
+		// Top straddle
+		const U8* inp = in + index0 * row_bytes;
+		for( S32 i = 0; i < row_bytes; i++ )
+		{
+			accum[i] = inp[i] * fract0;
+		}
+
+		// Central interval
+		for( S32 v = index0 + 1; v < index1; v++ )
+		{
+			inp = in + v * row_bytes;
+			for( S32 i = 0; i < row_bytes; i++ )
+			{
+				accum[i] += inp[i];
+			}
+		}
+
+		// Bottom straddle
+		// Watch out for reading off of end of input array.
+		if( fract1 && index1 < in_rows )
+		{
+			inp = in + index1 * row_bytes;
+			for( S32 i = 0; i < row_bytes; i++ )
+			{
+				accum[i] += inp[i] * fract1;
+			}
+		}
+
+		for( S32 i = 0; i < row_bytes; i++ )
+		{
+			outp[i] = U8(llround(accum[i] * norm_factor));
+		}
+	}
+}
+
 void LLImageRaw::compositeRowScaled4onto3( U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len )
 {
 	llassert( getComponents() == 3 );
@@ -1647,33 +1718,73 @@ static void avg4_colors2(const U8* a, const U8* b, const U8* c, const U8* d, U8*
 void LLImageBase::generateMip(const U8* indata, U8* mipdata, S32 width, S32 height, S32 nchannels)
 {
 	llassert(width > 0 && height > 0);
+	if (nchannels < 1 || nchannels > 4)
+	{
+		llerrs << "generateMmip called with bad num channels" << llendl;
+		return;
+	}
+
 	U8* data = mipdata;
 	S32 in_width = width*2;
+	const S32 in_stride = nchannels*in_width;
 	for (S32 h=0; h<height; h++)
 	{
-		for (S32 w=0; w<width; w++)
+		S32 w = 0;
+		switch(nchannels)
 		{
-			switch(nchannels)
+		  case 4:
+#if LL_VECTORIZE_SSE2
+			{
+				// Two output pixels per iteration, each the truncated average of a 2x2 block.
+				const __m128i zero = _mm_setzero_si128();
+				for ( ; w + 2 <= width; w += 2)
+				{
+					__m128i top = _mm_loadu_si128((const __m128i*)indata);
+					__m128i bottom = _mm_loadu_si128((const __m128i*)(indata + in_stride));
+					__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+					__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+					lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+					hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+					__m128i sum = _mm_srli_epi16(_mm_unpacklo_epi64(lo, hi), 2);
+					_mm_storel_epi64((__m128i*)data, _mm_packus_epi16(sum, sum));
+					indata += 16;
+					data += 8;
+				}
+			}
+#endif
+			for ( ; w<width; w++)
+			{
+				avg4_colors4(indata, indata+4, indata+in_stride, indata+in_stride+4, data);
+				indata += 8;
+				data += 4;
+			}
+			break;
+		  case 3:
+			for ( ; w<width; w++)
+			{
+				avg4_colors3(indata, indata+3, indata+in_stride, indata+in_stride+3, data);
+				indata += 6;
+				data += 3;
+			}
+			break;
+		  case 2:
+			for ( ; w<width; w++)
+			{
+				avg4_colors2(indata, indata+2, indata+in_stride, indata+in_stride+2, data);
+				indata += 4;
+				data += 2;
+			}
+			break;
+		  case 1:
+			for ( ; w<width; w++)
 			{
-			  case 4:
-				avg4_colors4(indata, indata+4, indata+4*in_width, indata+4*in_width+4, data);
-				break;
-			  case 3:
-				avg4_colors3(indata, indata+3, indata+3*in_width, indata+3*in_width+3, data);
-				break;
-			  case 2:
-				avg4_colors2(indata, indata+2, indata+2*in_width, indata+2*in_width+2, data);
-				break;
-			  case 1:
-				*(U8*)data = (U8)(((U32)(indata[0]) + indata[1] + indata[in_width] + indata[in_width+1])>>2);
-				break;
-			  default:
-				llerrs << "generateMmip called with bad num channels" << llendl;
+				*data = (U8)(((U32)(indata[0]) + indata[1] + indata[in_width] + indata[in_width+1])>>2);
+				indata += 2;
+				data += 1;
 			}
-			indata += nchannels*2;
-			data += nchannels;
+			break;
 		}
-		indata += nchannels*in_width; // skip odd lines
+		indata += in_stride; // skip odd lines
 	}
 }
 
@@ -55,6 +55,17 @@ const S32 MAX_IMAGE_DATA_SIZE = MAX_IMAGE_AREA * MAX_IMAGE_COMPONENTS;
 const S32 FIRST_PACKET_SIZE = 600;
 const S32 MAX_IMG_PACKET_SIZE = 1000;
 
+// copyRowsScaled() keeps its running sums in memory as F32, copyLineScaled()
+// keeps them in registers. They only round alike where float math is done
+// in SSE registers; x87 holds register sums at extended precision, so those
+// builds keep scaling vertically a column at a time.
+#if (LL_GNUC && defined(__SSE_MATH__)) \
+	|| (LL_MSVC && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#define LL_SCALE_IMAGE_ROWS 1
+#else
+#define LL_SCALE_IMAGE_ROWS 0
+#endif
+
 // Base classes for images.
 // There are two major parts for the image:
 // The compressed representation, and the decompressed representation.
@@ -243,6 +254,9 @@ protected:
 	bool createFromFile(const std::string& filename, bool j2c_lowest_mip_only = false);
 
 	void copyLineScaled( U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len, S32 in_pixel_step, S32 out_pixel_step );
+	// Same filter as copyLineScaled() applied to every column at once, walking whole rows of row_bytes.
+	// Only used on builds that do float math in SSE registers, see LL_SCALE_IMAGE_ROWS.
+	void copyRowsScaled( U8* in, U8* out, S32 row_bytes, S32 in_rows, S32 out_rows );
 	void compositeRowScaled4onto3( U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len );
 
 	U8	fastFractionalMult(U8 a,U8 b);
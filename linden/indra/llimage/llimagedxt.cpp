@@ -409,6 +409,248 @@ BOOL LLImageDXT::encode(const LLImageRaw* raw_image, F32 time)
 	return encodeDXT(raw_image, time, false);
 }
 
+//============================================================================
+// Block compression: bounding box endpoints inset by 1/16th of the range,
+// then the nearest palette entry per texel. Fast enough to run on every
+// decoded texture; not meant to compete with offline compressors.
+
+static void fetch_block(const U8* data, S32 width, S32 height, S32 ncomponents,
+						S32 bx, S32 by, U8 block[16][4])
+{
+	for (S32 y = 0; y < 4; y++)
+	{
+		// Mips smaller than a block repeat their edge texels
+		const U8* row = data + llmin(by + y, height - 1) * width * ncomponents;
+		for (S32 x = 0; x < 4; x++)
+		{
+			const U8* texel = row + llmin(bx + x, width - 1) * ncomponents;
+			U8* out = block[y * 4 + x];
+			out[0] = texel[0];
+			out[1] = texel[1];
+			out[2] = texel[2];
+			out[3] = (ncomponents == 4) ? texel[3] : 255;
+		}
+	}
+}
+
+static inline U16 pack_565(const U8* color)
+{
+	return (U16)(((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3));
+}
+
+static inline void unpack_565(U16 packed, S32* color)
+{
+	S32 r = (packed >> 11) & 0x1f;
+	S32 g = (packed >> 5) & 0x3f;
+	S32 b = packed & 0x1f;
+	color[0] = (r << 3) | (r >> 2);
+	color[1] = (g << 2) | (g >> 4);
+	color[2] = (b << 3) | (b >> 2);
+}
+
+static void compress_color_block(const U8 block[16][4], U8* out)
+{
+	U8 min_color[3] = { 255, 255, 255 };
+	U8 max_color[3] = { 0, 0, 0 };
+	for (S32 i = 0; i < 16; i++)
+	{
+		for (S32 c = 0; c < 3; c++)
+		{
+			min_color[c] = llmin(min_color[c], block[i][c]);
+			max_color[c] = llmax(max_color[c], block[i][c]);
+		}
+	}
+	for (S32 c = 0; c < 3; c++)
+	{
+		U8 inset = (max_color[c] - min_color[c]) >> 4;
+		min_color[c] += inset;
+		max_color[c] -= inset;
+	}
+
+	U16 color0 = pack_565(max_color);
+	U16 color1 = pack_565(min_color);
+	if (color0 < color1)
+	{
+		std::swap(color0, color1);
+	}
+
+	U32 indices = 0;
+	if (color0 != color1)
+	{
+		// color0 > color1 selects the four color mode
+		S32 palette[4][3];
+		unpack_565(color0, palette[0]);
+		unpack_565(color1, palette[1]);
+		for (S32 c = 0; c < 3; c++)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		for (S32 i = 0; i < 16; i++)
+		{
+			U32 best = 0;
+			S32 best_dist = S32_MAX;
+			for (U32 p = 0; p < 4; p++)
+			{
+				S32 dr = block[i][0] - palette[p][0];
+				S32 dg = block[i][1] - palette[p][1];
+				S32 db = block[i][2] - palette[p][2];
+				S32 dist = dr * dr + dg * dg + db * db;
+				if (dist < best_dist)
+				{
+					best_dist = dist;
+					best = p;
+				}
+			}
+			indices |= best << (i * 2);
+		}
+	}
+
+	out[0] = color0 & 0xff;
+	out[1] = color0 >> 8;
+	out[2] = color1 & 0xff;
+	out[3] = color1 >> 8;
+	out[4] = indices & 0xff;
+	out[5] = (indices >> 8) & 0xff;
+	out[6] = (indices >> 16) & 0xff;
+	out[7] = indices >> 24;
+}
+
+static void compress_alpha_block(const U8 block[16][4], U8* out)
+{
+	U8 alpha0 = 0;
+	U8 alpha1 = 255;
+	for (S32 i = 0; i < 16; i++)
+	{
+		alpha0 = llmax(alpha0, block[i][3]);
+		alpha1 = llmin(alpha1, block[i][3]);
+	}
+
+	U64 indices = 0;
+	if (alpha0 != alpha1)
+	{
+		// alpha0 > alpha1 selects the eight alpha mode
+		S32 palette[8];
+		palette[0] = alpha0;
+		palette[1] = alpha1;
+		for (S32 p = 1; p < 7; p++)
+		{
+			palette[p + 1] = ((7 - p) * alpha0 + p * alpha1) / 7;
+		}
+		for (S32 i = 0; i < 16; i++)
+		{
+			U64 best = 0;
+			S32 best_dist = S32_MAX;
+			for (U32 p = 0; p < 8; p++)
+			{
+				S32 dist = llabs(block[i][3] - palette[p]);
+				if (dist < best_dist)
+				{
+					best_dist = dist;
+					best = p;
+				}
+			}
+			indices |= best << (i * 3);
+		}
+	}
+
+	out[0] = alpha0;
+	out[1] = alpha1;
+	for (S32 b = 0; b < 6; b++)
+	{
+		out[2 + b] = (U8)(indices >> (b * 8));
+	}
+}
+
+static void compress_mip(const U8* data, S32 width, S32 height, S32 ncomponents, U8* out)
+{
+	U8 block[16][4];
+	for (S32 by = 0; by < height; by += 4)
+	{
+		for (S32 bx = 0; bx < width; bx += 4)
+		{
+			fetch_block(data, width, height, ncomponents, bx, by, block);
+			if (ncomponents == 4)
+			{
+				compress_alpha_block(block, out);
+				out += 8;
+			}
+			compress_color_block(block, out);
+			out += 8;
+		}
+	}
+}
+
+BOOL LLImageDXT::encodeCompressed(const LLImageRaw* raw_image)
+{
+	llassert_always(raw_image);
+
+	S32 ncomponents = raw_image->getComponents();
+	EFileFormat format;
+	switch (ncomponents)
+	{
+	  case 3:
+		format = FORMAT_DXR1;
+		break;
+	  case 4:
+		format = FORMAT_DXR5;
+		break;
+	  default:
+		setLastError("LLImageDXT::encodeCompressed needs 3 or 4 channels");
+		return FALSE;
+	}
+
+	S32 width = raw_image->getWidth();
+	S32 height = raw_image->getHeight();
+	if (width <= 0 || height <= 0 || (width & (width - 1)) || (height & (height - 1)))
+	{
+		setLastError("LLImageDXT::encodeCompressed needs power of two dimensions");
+		return FALSE;
+	}
+
+	setSize(width, height, ncomponents);
+	mHeaderSize = sizeof(dxtfile_header_t);
+	mFileFormat = format;
+
+	S32 nmips = calcNumMips(width, height);
+	if (!allocateData(calcDataSize(0)))
+	{
+		return FALSE;
+	}
+
+	U8* data = getData();
+	dxtfile_header_t* header = (dxtfile_header_t*)data;
+	memset(header, 0, mHeaderSize);
+	header->fourcc = 0x20534444;
+	header->pixel_fmt.fourcc = getFourCC(format);
+	header->num_mips = nmips;
+	header->maxwidth = width;
+	header->maxheight = height;
+
+	// Mips are stored smallest first, so getMipOffset(mip) walks backwards
+	std::vector<U8> prev_mip;
+	std::vector<U8> cur_mip;
+	const U8* mip_data = raw_image->getData();
+	S32 w = width;
+	S32 h = height;
+	for (S32 mip = 0; mip < nmips; mip++)
+	{
+		if (mip > 0)
+		{
+			cur_mip.resize(w * h * ncomponents);
+			LLImageBase::generateMip(mip_data, &cur_mip[0], w, h, ncomponents);
+			prev_mip.swap(cur_mip);
+			mip_data = &prev_mip[0];
+		}
+		compress_mip(mip_data, w, h, ncomponents, data + getMipOffset(mip));
+		w >>= 1;
+		h >>= 1;
+	}
+	setDiscardLevel(0);
+
+	return TRUE;
+}
+
 // virtual
 bool LLImageDXT::convertToDXR()
 {
@@ -108,6 +108,9 @@ public:
 
 	/*virtual*/ BOOL decode(LLImageRaw* raw_image, F32 decode_time);
 	/*virtual*/ BOOL encode(const LLImageRaw* raw_image, F32 encode_time);
+	// Compresses raw_image and its mips to DXR1 (3 channels) or DXR5 (4 channels).
+	// encode() stores uncompressed data.
+	BOOL encodeCompressed(const LLImageRaw* raw_image);
 
 	/*virtual*/ S32 calcHeaderSize();
 	/*virtual*/ S32 calcDataSize(S32 discard_level = 0);
@@ -34,6 +34,10 @@
 
 #include "llimageworker.h"
 #include "llimagedxt.h"
+#include "llfasttimer.h"
+
+static LLFastTimer::DeclareTimer FTM_IMAGE_DECODE_THREAD("Image Decode Thread");
+static LLFastTimer::DeclareTimer FTM_IMAGE_ENCODE_THREAD("Image Encode Thread");
 
 //----------------------------------------------------------------------------
 
@@ -117,6 +121,7 @@ LLImageDecodeThread::ImageRequest::~ImageRequest()
 // Returns true when done, whether or not decode was successful.
 bool LLImageDecodeThread::ImageRequest::processRequest()
 {
+	LLFastTimer t(FTM_IMAGE_DECODE_THREAD);
 	const F32 decode_time_slice = .1f;
 	bool done = true;
 	if (!mDecodedRaw && mFormattedImage.notNull())
@@ -176,3 +181,98 @@ bool LLImageDecodeThread::ImageRequest::tut_isOK()
 {
 	return mResponder.notNull();
 }
+
+//----------------------------------------------------------------------------
+
+// MAIN THREAD
+LLImageEncodeThread::LLImageEncodeThread(bool threaded)
+	: LLQueuedThread("imageencode", threaded)
+{
+}
+
+// MAIN THREAD
+LLImageEncodeThread::handle_t LLImageEncodeThread::encodeImage(LLImageRaw* raw_image, LLImageJ2C* image,
+	const std::string& comment, U32 priority, Responder* responder)
+{
+	if (isQuitting())
+	{
+		// Nothing will complete it now; letting go of the pointer frees the responder.
+		LLPointer<Responder> dropped(responder);
+		llwarns << "Dropping image encode requested after LLImageEncodeThread shutdown" << llendl;
+		return nullHandle();
+	}
+	handle_t handle = generateHandle();
+	llverify(addRequest(new EncodeRequest(handle, this, raw_image, image, comment, priority, responder)));
+	return handle;
+}
+
+// MAIN THREAD
+S32 LLImageEncodeThread::update(U32 max_time_ms)
+{
+	S32 res = LLQueuedThread::update(max_time_ms);
+
+	completed_list_t completed;
+	{
+		LLMutexLock lock(&mCompletedMutex);
+		completed.swap(mCompletedList);
+	}
+	for (completed_list_t::iterator iter = completed.begin();
+		 iter != completed.end(); ++iter)
+	{
+		iter->responder->completed(iter->success, iter->image);
+	}
+	return res;
+}
+
+// WORKER THREAD
+void LLImageEncodeThread::addCompleted(Responder* responder, LLImageJ2C* image, bool success)
+{
+	LLMutexLock lock(&mCompletedMutex);
+	mCompletedList.push_back(completed_info(responder, image, success));
+}
+
+LLImageEncodeThread::Responder::~Responder()
+{
+}
+
+//----------------------------------------------------------------------------
+
+LLImageEncodeThread::EncodeRequest::EncodeRequest(handle_t handle, LLImageEncodeThread* thread,
+												  LLImageRaw* raw_image, LLImageJ2C* image, const std::string& comment,
+												  U32 priority, LLImageEncodeThread::Responder* responder)
+	: LLQueuedThread::QueuedRequest(handle, priority, FLAG_AUTO_COMPLETE),
+	  mThread(thread),
+	  mRawImage(raw_image),
+	  mComment(comment),
+	  mFormattedImage(image),
+	  mEncoded(FALSE),
+	  mResponder(responder)
+{
+}
+
+LLImageEncodeThread::EncodeRequest::~EncodeRequest()
+{
+	mRawImage = NULL;
+	mFormattedImage = NULL;
+}
+
+// Returns true when done, whether or not encode was successful.
+bool LLImageEncodeThread::EncodeRequest::processRequest()
+{
+	LLFastTimer t(FTM_IMAGE_ENCODE_THREAD);
+	if (mRawImage.notNull() && mFormattedImage.notNull())
+	{
+		const char* comment = mComment.empty() ? NULL : mComment.c_str();
+		mEncoded = mFormattedImage->encode(mRawImage, comment);
+	}
+	return true;
+}
+
+void LLImageEncodeThread::EncodeRequest::finishRequest(bool completed)
+{
+	if (mResponder.notNull())
+	{
+		mThread->addCompleted(mResponder, mFormattedImage, completed && mEncoded);
+	}
+	// Will automatically be deleted
+}
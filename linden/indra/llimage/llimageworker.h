@@ -34,6 +34,7 @@
 #define LL_LLIMAGEWORKER_H
 
 #include "llimage.h"
+#include "llimagej2c.h"
 #include "llworkerthread.h"
 
 class LLImageDecodeThread : public LLQueuedThread
@@ -104,4 +105,66 @@ private:
 	LLMutex mCreationMutex;
 };
 
+// Encodes raw images to JPEG2000 off the main thread.
+// Responders are called back on the main thread from update().
+class LLImageEncodeThread : public LLQueuedThread
+{
+public:
+	class Responder : public LLThreadSafeRefCount
+	{
+	protected:
+		virtual ~Responder();
+	public:
+		virtual void completed(bool success, LLImageJ2C* image) = 0;
+	};
+
+	class EncodeRequest : public LLQueuedThread::QueuedRequest
+	{
+	protected:
+		virtual ~EncodeRequest(); // use deleteRequest()
+
+	public:
+		EncodeRequest(handle_t handle, LLImageEncodeThread* thread,
+					  LLImageRaw* raw_image, LLImageJ2C* image, const std::string& comment,
+					  U32 priority, LLImageEncodeThread::Responder* responder);
+
+		/*virtual*/ bool processRequest();
+		/*virtual*/ void finishRequest(bool completed);
+
+	private:
+		LLImageEncodeThread* mThread;
+		// input
+		LLPointer<LLImageRaw> mRawImage;
+		std::string mComment;
+		// output
+		LLPointer<LLImageJ2C> mFormattedImage;
+		BOOL mEncoded;
+		LLPointer<LLImageEncodeThread::Responder> mResponder;
+	};
+
+public:
+	LLImageEncodeThread(bool threaded = true);
+	// raw_image must not be modified until the responder is called
+	// Returns nullHandle() and drops the responder once the thread is shutting down
+	handle_t encodeImage(LLImageRaw* raw_image, LLImageJ2C* image, const std::string& comment,
+						 U32 priority, Responder* responder);
+	S32 update(U32 max_time_ms);
+
+private:
+	void addCompleted(Responder* responder, LLImageJ2C* image, bool success);
+
+	struct completed_info
+	{
+		LLPointer<Responder> responder;
+		LLPointer<LLImageJ2C> image;
+		bool success;
+		completed_info(Responder* r, LLImageJ2C* i, bool s)
+			: responder(r), image(i), success(s)
+		{}
+	};
+	typedef std::list<completed_info> completed_list_t;
+	completed_list_t mCompletedList;
+	LLMutex mCompletedMutex;
+};
+
 #endif
@@ -108,6 +108,28 @@ typedef __m128	V4F32;
 
 #endif
 
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// LLV4MATH - SSE2 integer code
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+
+// Like LL_VECTORIZE, only set when the entire build may use SSE2. MSVC
+// sets _M_IX86_FP to 2 for /arch:SSE2 and always targets SSE2 on x64,
+// where it doesn't define _M_IX86_FP at all.
+#if (LL_GNUC && defined(__SSE2__)) \
+	|| (LL_MSVC && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+
+#define			LL_VECTORIZE_SSE2				1
+
+#include <emmintrin.h>
+
+#else
+
+#define			LL_VECTORIZE_SSE2				0
+
+#endif
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 // LLV4MATH - default - no vectorization
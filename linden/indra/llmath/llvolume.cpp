@@ -1661,7 +1661,8 @@ LLProfile::~LLProfile()
 }
 
 
-S32 LLVolume::sNumMeshPoints = 0;
+// Zero through static initialization; no APR call needed before main().
+LLAtomicS32 LLVolume::sNumMeshPoints;
 
 LLVolume::LLVolume(const LLVolumeParams &params, const F32 detail, const BOOL generate_single_face, const BOOL is_unique)
 	: mParams(params)
@@ -1672,6 +1673,8 @@ LLVolume::LLVolume(const LLVolumeParams &params, const F32 detail, const BOOL ge
 	mFaceMask = 0x0;
 	mDetail = detail;
 	mSculptLevel = -2;
+	mSculptWidth = 0;
+	mSculptHeight = 0;
 	
 	// set defaults
 	if (mParams.getPathParams().getCurveType() == LL_PCODE_PATH_FLEXIBLE)
@@ -2191,19 +2194,11 @@ void sculpt_calc_mesh_resolution(U16 width, U16 height, U8 type, F32 detail, S32
 	s = vertices / t;
 }
 
-// sculpt replaces generate() for sculpted surfaces
-void LLVolume::sculpt(U16 sculpt_width, U16 sculpt_height, S8 sculpt_components, const U8* sculpt_data, S32 sculpt_level)
+// generates the path and profile for a sculpt map of the given size and
+// sizes the mesh to match
+void LLVolume::sculptResizeMesh(U16 sculpt_width, U16 sculpt_height)
 {
-	LLMemType m1(LLMemType::MTYPE_VOLUME);
-    U8 sculpt_type = mParams.getSculptType();
-
-	BOOL data_is_empty = FALSE;
-
-	if (sculpt_width == 0 || sculpt_height == 0 || sculpt_components < 3 || sculpt_data == NULL)
-	{
-		sculpt_level = -1;
-		data_is_empty = TRUE;
-	}
+	U8 sculpt_type = mParams.getSculptType();
 
 	S32 requested_sizeS = 0;
 	S32 requested_sizeT = 0;
@@ -2232,6 +2227,41 @@ void LLVolume::sculpt(U16 sculpt_width, U16 sculpt_height, S8 sculpt_components,
 	mMesh.resize(sizeS * sizeT);
 	sNumMeshPoints += mMesh.size();
 
+	mSculptWidth = sculpt_width;
+	mSculptHeight = sculpt_height;
+}
+
+void LLVolume::sculptCreateFaces(S32 sculpt_level)
+{
+	for (S32 i = 0; i < (S32)mProfilep->mFaces.size(); i++)
+	{
+		mFaceMask |= mProfilep->mFaces[i].mFaceID;
+	}
+
+	mSculptLevel = sculpt_level;
+
+	// Delete any existing faces so that they get regenerated
+	mVolumeFaces.clear();
+	
+	createVolumeFaces();
+}
+
+// sculpt replaces generate() for sculpted surfaces
+void LLVolume::sculpt(U16 sculpt_width, U16 sculpt_height, S8 sculpt_components, const U8* sculpt_data, S32 sculpt_level)
+{
+	LLMemType m1(LLMemType::MTYPE_VOLUME);
+    U8 sculpt_type = mParams.getSculptType();
+
+	BOOL data_is_empty = FALSE;
+
+	if (sculpt_width == 0 || sculpt_height == 0 || sculpt_components < 3 || sculpt_data == NULL)
+	{
+		sculpt_level = -1;
+		data_is_empty = TRUE;
+	}
+
+	sculptResizeMesh(sculpt_width, sculpt_height);
+
 	//generate vertex positions
 	if (!data_is_empty)
 	{
@@ -2248,24 +2278,49 @@ void LLVolume::sculpt(U16 sculpt_width, U16 sculpt_height, S8 sculpt_components,
 		sculptGeneratePlaceholder();
 	}
 
+	sculptCreateFaces(sculpt_level);
+}
 
-	
-	for (S32 i = 0; i < (S32)mProfilep->mFaces.size(); i++)
+BOOL LLVolume::sculptFromMesh(U16 sculpt_width, U16 sculpt_height, const LLVector3* points, S32 num_points, S32 sculpt_level)
+{
+	LLMemType m1(LLMemType::MTYPE_VOLUME);
+
+	sculptResizeMesh(sculpt_width, sculpt_height);
+	if ((S32)mMesh.size() != num_points)
 	{
-		mFaceMask |= mProfilep->mFaces[i].mFaceID;
+		// the mesh would have been generated differently; start over
+		sNumMeshPoints -= mMesh.size();
+		mMesh.clear();
+		mSculptLevel = -2;
+		return FALSE;
 	}
 
-	mSculptLevel = sculpt_level;
+	for (S32 i = 0; i < num_points; i++)
+	{
+		mMesh[i].mPos = points[i];
+	}
 
-	// Delete any existing faces so that they get regenerated
-	mVolumeFaces.clear();
-	
-	createVolumeFaces();
+	sculptCreateFaces(sculpt_level);
+	return TRUE;
 }
 
 
 
 
+void LLVolume::swapSculptData(LLVolume& volume)
+{
+	llassert(mParams == volume.mParams);
+	std::swap(mPathp, volume.mPathp);
+	std::swap(mProfilep, volume.mProfilep);
+	mMesh.swap(volume.mMesh);
+	mVolumeFaces.swap(volume.mVolumeFaces);
+	std::swap(mFaceMask, volume.mFaceMask);
+	std::swap(mLODScaleBias, volume.mLODScaleBias);
+	std::swap(mSculptLevel, volume.mSculptLevel);
+	std::swap(mSculptWidth, volume.mSculptWidth);
+	std::swap(mSculptHeight, volume.mSculptHeight);
+}
+
 BOOL LLVolume::isCap(S32 face)
 {
 	return mProfilep->mFaces[face].mCap; 
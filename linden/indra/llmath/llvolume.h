@@ -53,6 +53,7 @@ class LLVolume;
 #include "llstrider.h"
 #include "v4coloru.h"
 #include "llmemory.h"
+#include "llapr.h"
 #include "llfile.h"
 
 //============================================================================
@@ -899,6 +900,8 @@ public:
 	BOOL isUnique() const									{ return mUnique; }
 
 	S32 getSculptLevel() const                              { return mSculptLevel; }
+	U16 getSculptWidth() const								{ return mSculptWidth; }
+	U16 getSculptHeight() const								{ return mSculptHeight; }
 	
 	S32 *getTriangleIndices(U32 &num_indices) const;
 
@@ -938,7 +941,8 @@ public:
 	LLFaceID generateFaceMask();
 
 	BOOL isFaceMaskValid(LLFaceID face_mask);
-	static S32 sNumMeshPoints;
+	// Sculpted volumes are also built on LLVolumeMgr's worker thread.
+	static LLAtomicS32 sNumMeshPoints;
 
 	friend std::ostream& operator<<(std::ostream &s, const LLVolume &volume);
 	friend std::ostream& operator<<(std::ostream &s, const LLVolume *volumep);		// HACK to bypass Windoze confusion over 
@@ -952,10 +956,21 @@ public:
 
 	F32 sculptGetSurfaceArea();
 
+	// Rebuilds a sculpt from the mesh of an earlier sculpt() of the same
+	// parameters and map size, without the sculpt map. Returns FALSE if
+	// the points don't fit the mesh that map size calls for.
+	BOOL sculptFromMesh(U16 sculpt_width, U16 sculpt_height, const LLVector3* points, S32 num_points, S32 sculpt_level);
+
+	// Exchanges geometry with a volume of the same parameters that was
+	// sculpted elsewhere, e.g. on a worker thread.
+	void swapSculptData(LLVolume& volume);
+
 private:
 	void sculptGenerateMapVertices(U16 sculpt_width, U16 sculpt_height, S8 sculpt_components, const U8* sculpt_data, U8 sculpt_type);
 	void sculptGeneratePlaceholder();
 	void sculptCalcMeshResolution(U16 width, U16 height, U8 type, S32& s, S32& t);
+	void sculptResizeMesh(U16 sculpt_width, U16 sculpt_height);
+	void sculptCreateFaces(S32 sculpt_level);
 
 	
 protected:
@@ -966,6 +981,8 @@ protected:
 	BOOL mUnique;
 	F32 mDetail;
 	S32 mSculptLevel;
+	U16 mSculptWidth;		// size of the map the sculpt was built from
+	U16 mSculptHeight;
 	
 	LLVolumeParams mParams;
 	LLPath *mPathp;
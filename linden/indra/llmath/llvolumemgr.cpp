@@ -50,8 +50,76 @@ F32 LLVolumeLODGroup::mDetailScales[NUM_LODS] = {1.f, 1.5f, 2.5f, 4.f};
 
 //============================================================================
 
+// Builds a fresh volume with the same parameters and sculpts it. Only
+// the request's own data is touched off the main thread.
+class LLVolumeMgr::SculptRequest : public LLQueuedThread::QueuedRequest
+{
+protected:
+	virtual ~SculptRequest() {} // use deleteRequest()
+
+public:
+	SculptRequest(LLQueuedThread::handle_t handle, const LLVolumeParams& params, F32 detail,
+				  U16 sculpt_width, U16 sculpt_height, S8 sculpt_components,
+				  const U8* sculpt_data, S32 sculpt_level)
+		: LLQueuedThread::QueuedRequest(handle, LLQueuedThread::PRIORITY_NORMAL),
+		  mParams(params),
+		  mDetail(detail),
+		  mWidth(sculpt_width),
+		  mHeight(sculpt_height),
+		  mComponents(sculpt_components),
+		  mSculptLevel(sculpt_level)
+	{
+		if (sculpt_data)
+		{
+			mData.assign(sculpt_data, sculpt_data + sculpt_width * sculpt_height * sculpt_components);
+		}
+	}
+
+	/*virtual*/ bool processRequest()
+	{
+		mVolume = new LLVolume(mParams, mDetail);
+		mVolume->sculpt(mWidth, mHeight, mComponents, mData.empty() ? NULL : &mData[0], mSculptLevel);
+		return true;
+	}
+
+	LLPointer<LLVolume> mVolume;
+
+private:
+	LLVolumeParams mParams;
+	F32 mDetail;
+	U16 mWidth;
+	U16 mHeight;
+	S8 mComponents;
+	std::vector<U8> mData;
+	S32 mSculptLevel;
+};
+
+class LLVolumeMgr::BuildThread : public LLQueuedThread
+{
+public:
+	BuildThread(bool threaded) : LLQueuedThread("volumebuild", threaded) {}
+
+	// MAIN THREAD
+	handle_t sculpt(const LLVolume* volumep, U16 sculpt_width, U16 sculpt_height,
+					S8 sculpt_components, const U8* sculpt_data, S32 sculpt_level)
+	{
+		if (isQuitting())
+		{
+			return nullHandle();
+		}
+		handle_t handle = generateHandle();
+		llverify(addRequest(new SculptRequest(handle, volumep->getParams(), volumep->getDetail(),
+											  sculpt_width, sculpt_height, sculpt_components,
+											  sculpt_data, sculpt_level)));
+		return handle;
+	}
+};
+
+//----------------------------------------------------------------------------
+
 LLVolumeMgr::LLVolumeMgr()
-:	mDataMutex(NULL)
+:	mDataMutex(NULL),
+	mBuildThread(NULL)
 {
 	// the LLMutex magic interferes with easy unit testing,
 	// so you now must manually call useMutex() to use it
@@ -60,6 +128,15 @@ LLVolumeMgr::LLVolumeMgr()
 
 LLVolumeMgr::~LLVolumeMgr()
 {
+	if (mBuildThread)
+	{
+		mBuildThread->shutdown();
+		delete mBuildThread;
+		mBuildThread = NULL;
+	}
+	mSculptBuilds.clear();
+	mStaleSculptBuilds.clear();
+
 	cleanup();
 
 	delete mDataMutex;
@@ -226,6 +303,122 @@ void LLVolumeMgr::useMutex()
 	}
 }
 
+//----------------------------------------------------------------------------
+
+void LLVolumeMgr::startBuildThread(bool threaded)
+{
+	if (!mBuildThread)
+	{
+		mBuildThread = new BuildThread(threaded);
+	}
+}
+
+S32 LLVolumeMgr::updateBuildThread(U32 max_time_ms)
+{
+	return mBuildThread ? mBuildThread->update(max_time_ms) : 0;
+}
+
+void LLVolumeMgr::pauseBuildThread()
+{
+	if (mBuildThread)
+	{
+		mBuildThread->pause();
+	}
+}
+
+bool LLVolumeMgr::requestSculpt(LLVolume* volumep, U16 sculpt_width, U16 sculpt_height,
+								S8 sculpt_components, const U8* sculpt_data, S32 sculpt_level)
+{
+	if (!mBuildThread || volumep->isUnique())
+	{
+		return false;
+	}
+
+	sculpt_build_map_t::iterator iter = mSculptBuilds.find(volumep);
+	if (iter != mSculptBuilds.end())
+	{
+		if (iter->second.mSculptLevel == sculpt_level)
+		{
+			return true; // already on its way
+		}
+		mBuildThread->abortRequest(iter->second.mHandle, false);
+		mStaleSculptBuilds.push_back(iter->second.mHandle);
+		mSculptBuilds.erase(iter);
+	}
+
+	LLQueuedThread::handle_t handle = mBuildThread->sculpt(volumep, sculpt_width, sculpt_height,
+														   sculpt_components, sculpt_data, sculpt_level);
+	if (handle == LLQueuedThread::nullHandle())
+	{
+		return false;
+	}
+
+	SculptBuild& build = mSculptBuilds[volumep];
+	build.mVolume = volumep;
+	build.mHandle = handle;
+	build.mSculptLevel = sculpt_level;
+	return true;
+}
+
+S32 LLVolumeMgr::updateSculptBuilds(std::vector<LLPointer<LLVolume> >& built)
+{
+	if (!mBuildThread)
+	{
+		return 0;
+	}
+
+	for (std::vector<LLQueuedThread::handle_t>::iterator iter = mStaleSculptBuilds.begin();
+		 iter != mStaleSculptBuilds.end(); )
+	{
+		LLQueuedThread::status_t status = mBuildThread->getRequestStatus(*iter);
+		if (status == LLQueuedThread::STATUS_QUEUED || status == LLQueuedThread::STATUS_INPROGRESS)
+		{
+			++iter;
+			continue;
+		}
+		mBuildThread->completeRequest(*iter);
+		iter = mStaleSculptBuilds.erase(iter);
+	}
+
+	for (sculpt_build_map_t::iterator iter = mSculptBuilds.begin();
+		 iter != mSculptBuilds.end(); )
+	{
+		sculpt_build_map_t::iterator cur = iter++;
+		SculptBuild& build = cur->second;
+		LLQueuedThread::status_t status = mBuildThread->getRequestStatus(build.mHandle);
+		if (status == LLQueuedThread::STATUS_QUEUED || status == LLQueuedThread::STATUS_INPROGRESS)
+		{
+			continue;
+		}
+		if (status == LLQueuedThread::STATUS_COMPLETE)
+		{
+			SculptRequest* req = (SculptRequest*)mBuildThread->getRequest(build.mHandle);
+			if (req->mVolume.notNull())
+			{
+				build.mVolume->swapSculptData(*req->mVolume);
+				// the old geometry now lives in the request's volume;
+				// free it here rather than on the worker thread
+				req->mVolume = NULL;
+				built.push_back(build.mVolume);
+			}
+		}
+		mBuildThread->completeRequest(build.mHandle);
+		mSculptBuilds.erase(cur);
+	}
+
+	return (S32)mSculptBuilds.size();
+}
+
+S32 LLVolumeMgr::getPendingSculptLevel(const LLVolume* volumep) const
+{
+	sculpt_build_map_t::const_iterator iter = mSculptBuilds.find(volumep);
+	if (iter != mSculptBuilds.end())
+	{
+		return iter->second.mSculptLevel;
+	}
+	return volumep->getSculptLevel();
+}
+
 std::ostream& operator<<(std::ostream& s, const LLVolumeMgr& volume_mgr)
 {
 	s << "{ numLODgroups=" << volume_mgr.mVolumeLODGroups.size() << ", ";
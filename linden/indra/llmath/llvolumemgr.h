@@ -38,6 +38,7 @@
 #include "llvolume.h"
 #include "llmemory.h"
 #include "llthread.h"
+#include "llqueuedthread.h"
 
 class LLVolumeParams;
 class LLVolumeLODGroup;
@@ -100,6 +101,26 @@ public:
 	// manually call this for mutex magic
 	void useMutex();
 
+	// Sculpted volumes can be built on a worker thread. Call this once to
+	// start it; without it requestSculpt() always returns false. Like the
+	// other queued threads it is driven by updateBuildThread() from the
+	// main loop, which does the work itself when threaded is false.
+	void startBuildThread(bool threaded);
+	S32 updateBuildThread(U32 max_time_ms);
+	void pauseBuildThread();
+
+	// Queues a rebuild of volumep from a copy of the sculpt map. volumep
+	// keeps its current geometry until updateSculptBuilds() swaps in the
+	// result. Returns false if the caller has to sculpt inline instead.
+	bool requestSculpt(LLVolume* volumep, U16 sculpt_width, U16 sculpt_height,
+					   S8 sculpt_components, const U8* sculpt_data, S32 sculpt_level);
+	// MAIN THREAD: swaps finished builds into their volumes and appends
+	// those volumes to built. Returns the number of builds still pending.
+	S32 updateSculptBuilds(std::vector<LLPointer<LLVolume> >& built);
+	// Sculpt level volumep will have once its pending build lands
+	S32 getPendingSculptLevel(const LLVolume* volumep) const;
+	S32 getNumPendingSculpts() const { return (S32)mSculptBuilds.size(); }
+
 	friend std::ostream& operator<<(std::ostream& s, const LLVolumeMgr& volume_mgr);
 
 protected:
@@ -112,6 +133,20 @@ protected:
 	volume_lod_group_map_t mVolumeLODGroups;
 
 	LLMutex* mDataMutex;
+
+	class SculptRequest;
+	class BuildThread;
+	struct SculptBuild
+	{
+		LLPointer<LLVolume> mVolume;
+		LLQueuedThread::handle_t mHandle;
+		S32 mSculptLevel;
+	};
+	typedef std::map<const LLVolume*, SculptBuild> sculpt_build_map_t;
+	sculpt_build_map_t mSculptBuilds;
+	// superseded requests, completed once the thread is done with them
+	std::vector<LLQueuedThread::handle_t> mStaleSculptBuilds;
+	BuildThread* mBuildThread;
 };
 
 #endif // LL_LLVOLUMEMGR_H
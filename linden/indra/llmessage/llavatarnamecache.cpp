@@ -31,6 +31,7 @@
 #include "llcachename.h"		// we wrap this system
 #include "llframetimer.h"
 #include "llhttpclient.h"
+#include "llnamecachefile.h"
 #include "llsd.h"
 #include "llsdserialize.h"
 
@@ -81,6 +82,14 @@ namespace LLAvatarNameCache
 	// only need per-frame timing resolution
 	LLFrameTimer sRequestTimer;
 
+	// Request coalescing, see setRequestBatching()
+	U32 sMaxBatchSize = 64;
+	F32 sMaxBatchLatency = 0.1f;
+
+	// Lookup statistics
+	U32 sHitCount = 0;
+	U32 sMissCount = 0;
+
 	// Periodically clean out expired entries from the cache
 	//LLFrameTimer sEraseExpiredTimer;
 
@@ -388,7 +397,8 @@ void LLAvatarNameCache::requestNamesViaCapability()
 		// mark request as pending
 		sPendingQueue[agent_id] = now;
 
-		if (url.size() > NAME_URL_SEND_THRESHOLD)
+		if (url.size() > NAME_URL_SEND_THRESHOLD
+			|| agent_ids.size() >= sMaxBatchSize)
 		{
 			//llinfos << "requestNames " << url << llendl;
 			LLHTTPClient::get(url, new LLAvatarNameResponder(agent_ids));
@@ -480,6 +490,44 @@ void LLAvatarNameCache::importFile(std::istream& istr)
 	llinfos << "loaded " << sCache.size() << llendl;
 }
 
+void LLAvatarNameCache::importFile(LLNameCacheFile& file)
+{
+	LLAvatarName av_name;
+	LLNameCacheFile::Record record;
+	file.rewind();
+	while (file.nextRecord(record))
+	{
+		if (record.mType != LLNameCacheFile::RECORD_DISPLAY_NAME) continue;
+
+		av_name.mUsername = record.mFirst;
+		av_name.mDisplayName = record.mLast;
+		av_name.mLegacyFirstName = record.mLegacyFirst;
+		av_name.mLegacyLastName = record.mLegacyLast;
+		av_name.mIsDisplayNameDefault = record.mIsDisplayNameDefault;
+		av_name.mIsDummy = false;
+		av_name.mExpires = record.mExpires;
+		av_name.mNextUpdate = record.mNextUpdate;
+		sCache[record.mID] = av_name;
+	}
+	// entries may have expired since we last ran the viewer, just
+	// clean them out now
+	eraseExpired();
+	llinfos << "loaded " << sCache.size() << llendl;
+}
+
+void LLAvatarNameCache::exportFile(LLNameCacheFile& file)
+{
+	cache_t::const_iterator it = sCache.begin();
+	for ( ; it != sCache.end(); ++it)
+	{
+		const LLAvatarName& av_name = it->second;
+		if (!av_name.mIsDummy)
+		{
+			file.addAvatarName(it->first, av_name);
+		}
+	}
+}
+
 void LLAvatarNameCache::exportFile(std::ostream& ostr)
 {
 	LLSD agents;
@@ -514,17 +562,6 @@ void LLAvatarNameCache::idle()
 	// By convention, start running at first idle() call
 	sRunning = true;
 
-	// *TODO: Possibly re-enabled this based on People API load measurements
-	// 100 ms is the threshold for "user speed" operations, so we can
-	// stall for about that long to batch up requests.
-	//const F32 SECS_BETWEEN_REQUESTS = 0.1f;
-	//if (!sRequestTimer.checkExpirationAndReset(SECS_BETWEEN_REQUESTS))
-	//{
-	//	return;
-	//}
-
-	// Must be large relative to above
-
 	// No longer deleting expired entries, just re-requesting in the get
 	// this way first synchronous get call on an expired entry won't return
 	// legacy name.  LF
@@ -540,6 +577,15 @@ void LLAvatarNameCache::idle()
 		return;
 	}
 
+	// Let asks pile up into a batch unless one is already full or the
+	// oldest could have been waiting longer than the latency budget.
+	if (sAskQueue.size() < sMaxBatchSize
+		&& sRequestTimer.getElapsedTimeF32() < sMaxBatchLatency)
+	{
+		return;
+	}
+	sRequestTimer.reset();
+
 	if (useDisplayNames())
 	{
 		requestNamesViaCapability();
@@ -551,6 +597,38 @@ void LLAvatarNameCache::idle()
 	}
 }
 
+void LLAvatarNameCache::setRequestBatching(U32 max_batch_size, F32 max_latency)
+{
+	sMaxBatchSize = llmax(max_batch_size, 1U);
+	sMaxBatchLatency = llmax(max_latency, 0.f);
+}
+
+U32 LLAvatarNameCache::getHitCount()
+{
+	return sHitCount;
+}
+
+U32 LLAvatarNameCache::getMissCount()
+{
+	return sMissCount;
+}
+
+U32 LLAvatarNameCache::getOutstandingCount()
+{
+	return sPendingQueue.size();
+}
+
+void LLAvatarNameCache::dumpStats()
+{
+	llinfos << "LLAvatarNameCache:"
+			<< " Cache=" << sCache.size()
+			<< " Ask=" << sAskQueue.size()
+			<< " Pending=" << sPendingQueue.size()
+			<< " Hits=" << sHitCount
+			<< " Misses=" << sMissCount
+			<< llendl;
+}
+
 bool LLAvatarNameCache::isRequestPending(const LLUUID& agent_id)
 {
 	const F64 PENDING_TIMEOUT_SECS = 5.0 * 60.0;
@@ -617,6 +695,7 @@ bool LLAvatarNameCache::get(const LLUUID& agent_id, LLAvatarName *av_name)
 					}
 				}
 				
+				++sHitCount;
 				return true;
 			}
 		}
@@ -627,11 +706,13 @@ bool LLAvatarNameCache::get(const LLUUID& agent_id, LLAvatarName *av_name)
 			if (gCacheName->getFullName(agent_id, full_name))
 			{
 				buildLegacyName(full_name, av_name);
+				++sHitCount;
 				return true;
 			}
 		}
 	}
 
+	++sMissCount;
 	if (!isRequestPending(agent_id))
 	{
 		sAskQueue.insert(agent_id);
@@ -665,6 +746,7 @@ void LLAvatarNameCache::get(const LLUUID& agent_id, callback_slot_t slot)
 				if (av_name.mExpires > LLFrameTimer::getTotalSeconds())
 				{
 					// ...name already exists in cache, fire callback now
+					++sHitCount;
 					fireSignal(agent_id, slot, av_name);
 
 					return;
@@ -679,12 +761,15 @@ void LLAvatarNameCache::get(const LLUUID& agent_id, callback_slot_t slot)
 			{
 				LLAvatarName av_name;
 				buildLegacyName(full_name, &av_name);
+				++sHitCount;
 				fireSignal(agent_id, slot, av_name);
 				return;
 			}
 		}
 	}
 
+	++sMissCount;
+
 	// schedule a request
 	if (!isRequestPending(agent_id))
 	{
@@ -35,6 +35,7 @@
 // We have display names support (this is for use by patches)
 #define LL_DISPLAY_NAMES
 
+class LLNameCacheFile;
 class LLSD;
 class LLUUID;
 
@@ -52,6 +53,10 @@ namespace LLAvatarNameCache
 	void importFile(std::istream& istr);
 	void exportFile(std::ostream& ostr);
 
+	// binary cache shared with LLCacheName, see llnamecachefile.h
+	void importFile(LLNameCacheFile& file);
+	void exportFile(LLNameCacheFile& file);
+
 	// On the viewer, usually a simulator capabilitity
 	// If empty, name cache will fall back to using legacy name
 	// lookup system
@@ -65,6 +70,17 @@ namespace LLAvatarNameCache
 	// cache.  Call once per frame.
 	void idle();
 
+	// Requests are coalesced until max_batch_size IDs are queued or
+	// max_latency seconds have passed since the last batch went out, and
+	// each HTTP request carries at most max_batch_size IDs.
+	void setRequestBatching(U32 max_batch_size, F32 max_latency);
+
+	// Lookup statistics, for debugging and tuning the batching above
+	U32 getHitCount();
+	U32 getMissCount();
+	U32 getOutstandingCount();
+	void dumpStats();
+
 	// If name is in cache, returns true and fills in provided LLAvatarName
 	// otherwise returns false
 	bool get(const LLUUID& agent_id, LLAvatarName *av_name);
@@ -38,6 +38,13 @@
 #include "llmath.h"
 #include "llmemtype.h"
 #include "llstl.h"
+#include "llthread.h"
+
+// Size of the buffers the buffer arrays make on demand.
+const S32 DEFAULT_HEAP_BUFFER_SIZE = 16384;
+
+// Most free blocks the pool will hold on to, 1MB of default buffers.
+const S32 MAX_POOLED_HEAP_BLOCKS = 64;
 
 /** 
  * LLSegment
@@ -108,7 +115,6 @@ LLHeapBuffer::LLHeapBuffer() :
 	mReclaimedBytes(0)
 {
 	LLMemType m1(LLMemType::MTYPE_IO_BUFFER);
-	const S32 DEFAULT_HEAP_BUFFER_SIZE = 16384;
 	allocate(DEFAULT_HEAP_BUFFER_SIZE);
 }
 
@@ -143,7 +149,7 @@ LLHeapBuffer::LLHeapBuffer(const U8* src, S32 len) :
 LLHeapBuffer::~LLHeapBuffer()
 {
 	LLMemType m1(LLMemType::MTYPE_IO_BUFFER);
-	delete[] mBuffer;
+	freeBlock(mBuffer, mSize);
 	mBuffer = NULL;
 	mSize = 0;
 	mNextFree = NULL;
@@ -217,7 +223,7 @@ void LLHeapBuffer::allocate(S32 size)
 {
 	LLMemType m1(LLMemType::MTYPE_IO_BUFFER);
 	mReclaimedBytes = 0;	
-	mBuffer = new U8[size];
+	mBuffer = allocateBlock(size);
 	if(mBuffer)
 	{
 		mSize = size;
@@ -225,6 +231,92 @@ void LLHeapBuffer::allocate(S32 size)
 	}
 }
 
+LLMutex* LLHeapBuffer::sPoolMutex = NULL;
+std::vector<U8*> LLHeapBuffer::sFreeBlocks;
+S32 LLHeapBuffer::sAllocationCount = 0;
+S32 LLHeapBuffer::sPoolHitCount = 0;
+
+// static
+void LLHeapBuffer::initClass()
+{
+	if(!sPoolMutex)
+	{
+		sPoolMutex = new LLMutex;
+	}
+}
+
+// static
+void LLHeapBuffer::cleanupClass()
+{
+	if(!sPoolMutex)
+	{
+		return;
+	}
+	llinfos << "LLHeapBuffer pool: " << sAllocationCount << " blocks allocated, "
+		<< sPoolHitCount << " reused" << llendl;
+	{
+		LLMutexLock lock(sPoolMutex);
+		std::vector<U8*>::iterator iter = sFreeBlocks.begin();
+		std::vector<U8*>::iterator end = sFreeBlocks.end();
+		for(; iter != end; ++iter)
+		{
+			delete[] *iter;
+		}
+		sFreeBlocks.clear();
+	}
+	delete sPoolMutex;
+	sPoolMutex = NULL;
+}
+
+// static
+S32 LLHeapBuffer::getAllocationCount()
+{
+	return sAllocationCount;
+}
+
+// static
+S32 LLHeapBuffer::getPoolHitCount()
+{
+	return sPoolHitCount;
+}
+
+// static
+U8* LLHeapBuffer::allocateBlock(S32 size)
+{
+	if(sPoolMutex && (DEFAULT_HEAP_BUFFER_SIZE == size))
+	{
+		LLMutexLock lock(sPoolMutex);
+		if(!sFreeBlocks.empty())
+		{
+			U8* block = sFreeBlocks.back();
+			sFreeBlocks.pop_back();
+			++sPoolHitCount;
+			return block;
+		}
+		++sAllocationCount;
+	}
+	return new U8[size];
+}
+
+// static
+void LLHeapBuffer::freeBlock(U8* block, S32 size)
+{
+	if(!block)
+	{
+		return;
+	}
+	if(sPoolMutex && (DEFAULT_HEAP_BUFFER_SIZE == size))
+	{
+		LLMutexLock lock(sPoolMutex);
+		if((S32)sFreeBlocks.size() < MAX_POOLED_HEAP_BLOCKS)
+		{
+			sFreeBlocks.push_back(block);
+			return;
+		}
+	}
+	delete[] block;
+}
+
 
 /** 
  * LLBufferArray
@@ -238,7 +330,12 @@ LLBufferArray::LLBufferArray() :
 LLBufferArray::~LLBufferArray()
 {
 	LLMemType m1(LLMemType::MTYPE_IO_BUFFER);
-	std::for_each(mBuffers.begin(), mBuffers.end(), DeletePointer());
+	buffer_iterator_t iter = mBuffers.begin();
+	buffer_iterator_t end = mBuffers.end();
+	for(; iter != end; ++iter)
+	{
+		(*iter)->unref();
+	}
 }
 
 // static
@@ -732,6 +829,57 @@ bool LLBufferArray::takeContents(LLBufferArray& source)
 	return true;
 }
 
+S32 LLBufferArray::splice(S32 channel, LLBufferArray& source, S32 source_channel)
+{
+	LLMemType m1(LLMemType::MTYPE_IO_BUFFER);
+	if(&source == this)
+	{
+		return 0;
+	}
+	S32 moved = 0;
+	segment_iterator_t it = source.mSegments.begin();
+	segment_iterator_t end = source.mSegments.end();
+	while(it != end)
+	{
+		if(!(*it).isOnChannel(source_channel))
+		{
+			++it;
+			continue;
+		}
+
+		// Share the buffer holding this segment if we do not
+		// already have it.
+		buffer_iterator_t buf_it = source.mBuffers.begin();
+		buffer_iterator_t buf_end = source.mBuffers.end();
+		for(; buf_it != buf_end; ++buf_it)
+		{
+			if((*buf_it)->containsSegment(*it))
+			{
+				if(std::find(mBuffers.begin(), mBuffers.end(), *buf_it) == mBuffers.end())
+				{
+					(*buf_it)->ref();
+					mBuffers.push_back(*buf_it);
+				}
+				break;
+			}
+		}
+		if(buf_it == buf_end)
+		{
+			llwarns << "LLBufferArray::splice() segment not in any source buffer."
+				<< llendl;
+			++it;
+			continue;
+		}
+
+		LLSegment segment(*it);
+		segment.setChannel(channel);
+		mSegments.push_back(segment);
+		moved += segment.size();
+		source.mSegments.erase(it++);
+	}
+	return moved;
+}
+
 LLBufferArray::segment_iterator_t LLBufferArray::makeSegment(
 	S32 channel,
 	S32 len)
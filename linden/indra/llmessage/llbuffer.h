@@ -45,6 +45,8 @@
 #include <list>
 #include <vector>
 
+class LLMutex;
+
 /** 
  * @class LLChannelDescriptors
  * @brief A way simple interface to accesss channels inside a buffer
@@ -141,12 +143,29 @@ protected:
 class LLBuffer
 {
 public:
+	/** 
+	 * @brief Buffers start life with a single reference held by the
+	 * buffer array which created them.
+	 */
+	LLBuffer() : mRefCount(1) {}
+
 	/** 
 	 * @brief The buffer base class should have no responsibilities
 	 * other than an interface.
 	 */ 
 	virtual ~LLBuffer() {}
 
+	/** 
+	 * @brief Reference counting for buffers shared between buffer arrays.
+	 *
+	 * A buffer is shared when segments are spliced from one buffer
+	 * array into another. The count is not thread safe, so arrays
+	 * sharing buffers must be used from the same thread.
+	 */
+	void ref() { ++mRefCount; }
+	void unref() { if(0 == --mRefCount) delete this; }
+	S32 getNumRefs() const { return mRefCount; }
+
 	/** 
 	 * @brief Generate a segment for this buffer.
 	 *
@@ -190,6 +209,9 @@ public:
 	 * necessarily a good idea to use it for anything else.
 	 */
 	virtual S32 capacity() const = 0;
+
+private:
+	S32 mRefCount;
 };
 
 /** 
@@ -281,6 +303,28 @@ public:
 	 */
 	virtual S32 capacity() const { return mSize; }
 
+	/* @name Block pool
+	 *
+	 * Default sized buffers, which is what the buffer arrays make
+	 * when they run out of room, recycle their memory through a small
+	 * pool instead of going back to the heap every time. The pool is
+	 * only used between initClass() and cleanupClass().
+	 */
+	//@{
+	static void initClass();
+	static void cleanupClass();
+
+	/** 
+	 * @brief Number of buffer blocks obtained with new[].
+	 */
+	static S32 getAllocationCount();
+
+	/** 
+	 * @brief Number of buffer blocks handed out from the pool.
+	 */
+	static S32 getPoolHitCount();
+	//@}
+
 protected:
 	U8* mBuffer;
 	S32 mSize;
@@ -293,6 +337,14 @@ private:
 	 * intertnal state of this buffer.
 	 */ 
 	void allocate(S32 size);
+
+	static U8* allocateBlock(S32 size);
+	static void freeBlock(U8* block, S32 size);
+
+	static LLMutex* sPoolMutex;
+	static std::vector<U8*> sFreeBlocks;
+	static S32 sAllocationCount;
+	static S32 sPoolHitCount;
 };
 
 /** 
@@ -470,6 +522,21 @@ public:
 	 * @return Returns true if the operation succeeded.
 	 */
 	bool takeContents(LLBufferArray& source);
+
+	/** 
+	 * @brief Move one channel of another buffer array into this one
+	 *
+	 * Every segment on source_channel in the source is removed from
+	 * the source and appended to this buffer array on channel,
+	 * without copying any data. Buffers holding those segments are
+	 * shared between both arrays until both are done with them. The
+	 * other channels in the source are left alone.
+	 * @param channel The channel for the data in this buffer array.
+	 * @param source The source buffer array.
+	 * @param source_channel The channel to take from the source.
+	 * @return Returns the number of bytes moved.
+	 */
+	S32 splice(S32 channel, LLBufferArray& source, S32 source_channel);
 	//@}
 
 	/* @name Segment methods
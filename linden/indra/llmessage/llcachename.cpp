@@ -38,6 +38,7 @@
 #include "lldbstrings.h"
 #include "llframetimer.h"
 #include "llhost.h"
+#include "llnamecachefile.h"
 #include "llrand.h"
 #include "llsdserialize.h"
 #include "lluuid.h"
@@ -215,6 +216,10 @@ public:
 
 	LLFrameTimer		mProcessTimer;
 
+	U32					mHits;
+	U32					mMisses;
+		// lookup counters, reported by dumpStats()
+
 	Impl(LLMessageSystem* msg);
 	~Impl();
 
@@ -256,7 +261,7 @@ LLCacheName::~LLCacheName()
 }
 
 LLCacheName::Impl::Impl(LLMessageSystem* msg)
-	: mMsg(msg), mUpstreamHost(LLHost::invalid)
+	: mMsg(msg), mUpstreamHost(LLHost::invalid), mHits(0), mMisses(0)
 {
 	mMsg->setHandlerFuncFast(
 		_PREHASH_UUIDNameRequest, handleUUIDNameRequest, (void**)this);
@@ -452,6 +457,73 @@ bool LLCacheName::importFile(std::istream& istr)
 	return true;
 }
 
+void LLCacheName::importFile(LLNameCacheFile& file)
+{
+	// We'll expire entries more than a week old
+	U32 now = (U32)time(NULL);
+	const U32 SECS_PER_DAY = 60 * 60 * 24;
+	U32 delete_before_time = now - (7 * SECS_PER_DAY);
+
+	S32 agent_count = 0;
+	S32 group_count = 0;
+	LLNameCacheFile::Record record;
+	file.rewind();
+	while (file.nextRecord(record))
+	{
+		bool is_group = (record.mType == LLNameCacheFile::RECORD_GROUP);
+		if (!is_group && record.mType != LLNameCacheFile::RECORD_AGENT) continue;
+		if (record.mCreateTime < delete_before_time) continue;
+
+		LLCacheNameEntry* entry = get_ptr_in_map(impl.mCache, record.mID);
+		if (!entry)
+		{
+			entry = new LLCacheNameEntry();
+			impl.mCache[record.mID] = entry;
+		}
+		entry->mIsGroup = is_group;
+		entry->mCreateTime = record.mCreateTime;
+		if (is_group)
+		{
+			entry->mGroupName = record.mFirst;
+			++group_count;
+		}
+		else
+		{
+			entry->mFirstName = record.mFirst;
+			entry->mLastName = record.mLast;
+			++agent_count;
+		}
+	}
+	llinfos << "LLCacheName loaded " << agent_count << " agent names and "
+			<< group_count << " group names" << llendl;
+}
+
+void LLCacheName::exportFile(LLNameCacheFile& file)
+{
+	Cache::iterator iter = impl.mCache.begin();
+	Cache::iterator end = impl.mCache.end();
+	for( ; iter != end; ++iter)
+	{
+		// Same filtering as the LLSD export below.
+		LLCacheNameEntry* entry = iter->second;
+		if(!entry
+		   || (std::string::npos != entry->mFirstName.find('?'))
+		   || (std::string::npos != entry->mGroupName.find('?')))
+		{
+			continue;
+		}
+
+		if(!entry->mFirstName.empty() && !entry->mLastName.empty())
+		{
+			file.addAgent(iter->first, entry->mCreateTime, entry->mFirstName, entry->mLastName);
+		}
+		else if(entry->mIsGroup && !entry->mGroupName.empty())
+		{
+			file.addGroup(iter->first, entry->mCreateTime, entry->mGroupName);
+		}
+	}
+}
+
 void LLCacheName::exportFile(std::ostream& ostr)
 {
 	LLSD data;
@@ -500,12 +572,14 @@ BOOL LLCacheName::getName(const LLUUID& id, std::string& first, std::string& las
 	LLCacheNameEntry* entry = get_ptr_in_map(impl.mCache, id );
 	if (entry)
 	{
+		++impl.mHits;
 		first = entry->mFirstName;
 		last =  entry->mLastName;
 		return TRUE;
 	}
 	else
 	{
+		++impl.mMisses;
 		first = CN_WAITING;
 		last.clear();
 		if (!impl.isRequestPending(id))
@@ -545,11 +619,13 @@ BOOL LLCacheName::getGroupName(const LLUUID& id, std::string& group)
 
 	if (entry)
 	{
+		++impl.mHits;
 		group = entry->mGroupName;
 		return TRUE;
 	}
 	else 
 	{
+		++impl.mMisses;
 		group = CN_WAITING;
 		if (!impl.isRequestPending(id))
 		{
@@ -572,6 +648,7 @@ void LLCacheName::get(const LLUUID& id, BOOL is_group, LLCacheNameCallback callb
 	LLCacheNameEntry* entry = get_ptr_in_map(impl.mCache, id );
 	if (entry)
 	{
+		++impl.mHits;
 		// id found in map therefore we can call the callback immediately.
 		if (entry->mIsGroup)
 		{
@@ -584,6 +661,7 @@ void LLCacheName::get(const LLUUID& id, BOOL is_group, LLCacheNameCallback callb
 	}
 	else
 	{
+		++impl.mMisses;
 		// id not found in map so we must queue the callback call until available.
 		if (!impl.isRequestPending(id))
 		{
@@ -684,6 +762,8 @@ void LLCacheName::dumpStats()
 			<< " Pending=" << impl.mPendingQueue.size()
 			<< " Reply=" << impl.mReplyQueue.size()
 			<< " Observers=" << impl.mObservers.size()
+			<< " Hits=" << impl.mHits
+			<< " Misses=" << impl.mMisses
 			<< llendl;
 }
 
@@ -37,6 +37,7 @@
 
 class LLMessageSystem;
 class LLHost;
+class LLNameCacheFile;
 class LLUUID;
 
 // agent_id/group_id, first_name, last_name, is_group, user_data
@@ -73,6 +74,10 @@ public:
 	bool importFile(std::istream& istr);
 	void exportFile(std::ostream& ostr);
 
+	// binary cache shared with LLAvatarNameCache, see llnamecachefile.h
+	void importFile(LLNameCacheFile& file);
+	void exportFile(LLNameCacheFile& file);
+
 	// If available, copies the first and last name into the strings provided.
 	// first must be at least DB_FIRST_NAME_BUF_SIZE characters.
 	// last must be at least DB_LAST_NAME_BUF_SIZE characters.
@@ -68,10 +68,15 @@
 	rather than create and destroy them with each request.  This
 	code does this.
 
-	Furthermore, it would behoove us to keep track of which
-	hosts an easy handle was used for and pick an easy handle
-	that matches the next request.  This code does not current
-	do this.
+	Note that once an easy handle is added to a multi handle,
+	curl uses the multi handle's connection cache instead, so
+	which free easy handle a request gets makes no difference to
+	connection reuse.  What does matter is that the multi handle
+	outlives the request; LLCurlRequest keeps its active multi
+	handle and only retires older ones once they have drained.
+
+	Multi::setMaxHostConnections() caps the connections a multi
+	handle opens to any one host (libcurl 7.30.0 and later).
  */
 
 //////////////////////////////////////////////////////////////////////////////
@@ -91,6 +96,8 @@ S32 gCurlMultiCount = 0;
 std::vector<LLMutex*> LLCurl::sSSLMutex;
 std::string LLCurl::sCAPath;
 std::string LLCurl::sCAFile;
+LLMutex* LLCurl::sHostStatsMutex = NULL;
+LLCurl::host_stats_map_t LLCurl::sHostStats;
 
 //static
 void LLCurl::setCAPath(const std::string& path)
@@ -226,6 +233,10 @@ public:
 	
 	const char* getErrorBuffer();
 
+	// "host:port" of the current request, for the host statistics
+	const std::string& getHost() const { return mHost; }
+	void setHost(const std::string& host) { mHost = host; }
+
 	std::stringstream& getInput() { return mInput; }
 	std::stringstream& getHeaderOutput() { return mHeaderOutput; }
 	LLIOPipe::buffer_ptr_t& getOutput() { return mOutput; }
@@ -243,6 +254,7 @@ private:
 	std::stringstream	mInput;
 	std::stringstream	mHeaderOutput;
 	char				mErrorBuffer[CURL_ERROR_SIZE];
+	std::string			mHost;
 
 	// Note: char*'s not strings since we pass pointers to curl
 	std::vector<char*>	mStrings;
@@ -376,6 +388,10 @@ U32 LLCurl::Easy::report(CURLcode code)
 		responseCode = 499;
 		responseReason = strerror(code) + " : " + mErrorBuffer;
 	}
+
+	LLCurl::TransferInfo info;
+	getTransferInfo(&info);
+	LLCurl::recordTransfer(mHost, LLCurl::Responder::isGoodStatus(responseCode), info);
 		
 	if (mResponder)
 	{	
@@ -499,6 +515,7 @@ void LLCurl::Easy::prepRequest(const std::string& url,
 	setopt(CURLOPT_TIMEOUT, CURL_REQUEST_TIMEOUT);
 
 	setoptString(CURLOPT_URL, url);
+	mHost = LLCurl::getHostKey(url);
 
 	mResponder = responder;
 
@@ -530,6 +547,9 @@ public:
 	
 	void removeEasy(Easy* easy);
 
+	void setPipelining(bool pipelining);
+	void setMaxHostConnections(S32 max_connections);
+
 	S32 process();
 	S32 perform();
 	
@@ -700,6 +720,20 @@ void LLCurl::Multi::removeEasy(Easy* easy)
 	easyFree(easy);
 }
 
+void LLCurl::Multi::setPipelining(bool pipelining)
+{
+#if LIBCURL_VERSION_NUM >= 0x071000 // 7.16.0
+	curl_multi_setopt(mCurlMultiHandle, CURLMOPT_PIPELINING, pipelining ? 1L : 0L);
+#endif
+}
+
+void LLCurl::Multi::setMaxHostConnections(S32 max_connections)
+{
+#if LIBCURL_VERSION_NUM >= 0x071e00 // 7.30.0
+	curl_multi_setopt(mCurlMultiHandle, CURLMOPT_MAX_HOST_CONNECTIONS, (long)max_connections);
+#endif
+}
+
 //static
 std::string LLCurl::strerror(CURLcode errorcode)
 {
@@ -714,13 +748,100 @@ std::string LLCurl::strerror(CURLcode errorcode)
 #endif // LL_DARWIN
 }
 
+//static
+std::string LLCurl::getHostKey(const std::string& url)
+{
+	// Called for every request, so just scan for the authority rather
+	// than building an LLURI.
+	std::string::size_type start = url.find("://");
+	if (start == std::string::npos)
+	{
+		return std::string();
+	}
+	std::string scheme = url.substr(0, start);
+	start += 3;
+	std::string::size_type end = url.find_first_of("/?#", start);
+	if (end == std::string::npos)
+	{
+		end = url.size();
+	}
+	std::string::size_type at = url.rfind('@', end);
+	if (at != std::string::npos && at >= start)
+	{
+		start = at + 1;
+	}
+	std::string host = url.substr(start, end - start);
+
+	// Append the default port if there is none; a colon inside an IPv6
+	// literal doesn't count.
+	std::string::size_type colon = host.rfind(':');
+	std::string::size_type bracket = host.rfind(']');
+	if (colon == std::string::npos
+		|| (bracket != std::string::npos && colon < bracket))
+	{
+		host += (scheme == "https") ? ":443" : ":80";
+	}
+	return host;
+}
+
+//static
+void LLCurl::recordTransfer(const std::string& host, bool success, const TransferInfo& info)
+{
+	if (!sHostStatsMutex || host.empty())
+	{
+		return;
+	}
+	LLMutexLock lock(sHostStatsMutex);
+	HostStats& stats = sHostStats[host];
+	++stats.mRequests;
+	if (!success)
+	{
+		++stats.mFailures;
+	}
+	stats.mBytes += info.mSizeDownload;
+	stats.mSeconds += info.mTotalTime;
+}
+
+//static
+void LLCurl::getHostStats(host_stats_map_t& stats)
+{
+	if (!sHostStatsMutex)
+	{
+		stats.clear();
+		return;
+	}
+	LLMutexLock lock(sHostStatsMutex);
+	stats = sHostStats;
+}
+
+//static
+void LLCurl::dumpHostStats()
+{
+	host_stats_map_t stats;
+	getHostStats(stats);
+	for (host_stats_map_t::const_iterator iter = stats.begin();
+		 iter != stats.end(); ++iter)
+	{
+		const HostStats& host = iter->second;
+		F64 kbps = host.mSeconds > 0.0 ? (host.mBytes * 8.0 / 1024.0) / host.mSeconds : 0.0;
+		llinfos << iter->first
+				<< " requests: " << host.mRequests
+				<< " failures: " << host.mFailures
+				<< " bytes: " << (U64)host.mBytes
+				<< " avg kbps: " << kbps
+				<< llendl;
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////
 // For generating a simple request for data
 // using one multi and one easy per request 
 
 LLCurlRequest::LLCurlRequest() :
 	mActiveMulti(NULL),
-	mActiveRequestCount(0)
+	mActiveRequestCount(0),
+	mPipelining(false),
+	mMaxHostConnections(0)
 {
 	mThreadID = LLThread::currentID();
 }
@@ -735,6 +856,8 @@ void LLCurlRequest::addMulti()
 {
 	llassert_always(mThreadID == LLThread::currentID());
 	LLCurl::Multi* multi = new LLCurl::Multi();
+	multi->setPipelining(mPipelining);
+	multi->setMaxHostConnections(mMaxHostConnections);
 	mMultiSet.insert(multi);
 	mActiveMulti = multi;
 	mActiveRequestCount = 0;
@@ -943,6 +1066,7 @@ void LLCurlEasyRequest::sendRequest(const std::string& url)
 	{
 		mEasy->setHeaders();
 		mEasy->setoptString(CURLOPT_URL, url);
+		mEasy->setHost(LLCurl::getHostKey(url));
 		mMulti->addEasy(mEasy);
 	}
 }
@@ -1011,9 +1135,12 @@ CURLMsg* LLCurlEasyRequest::info_read(S32* q, LLCurl::TransferInfo* info)
 		CURLMsg* curlmsg = mMulti->info_read(q);
 		if (curlmsg && curlmsg->msg == CURLMSG_DONE)
 		{
+			LLCurl::TransferInfo transfer_info;
+			mEasy->getTransferInfo(&transfer_info);
+			LLCurl::recordTransfer(mEasy->getHost(), curlmsg->data.result == CURLE_OK, transfer_info);
 			if (info)
 			{
-				mEasy->getTransferInfo(info);
+				*info = transfer_info;
 			}
 		}
 		return curlmsg;
@@ -1065,10 +1192,16 @@ void LLCurl::initClass()
 	CRYPTO_set_id_callback(&LLCurl::ssl_thread_id);
 	CRYPTO_set_locking_callback(&LLCurl::ssl_locking_callback);
 #endif
+
+	sHostStatsMutex = new LLMutex;
 }
 
 void LLCurl::cleanupClass()
 {
+	dumpHostStats();
+	delete sHostStatsMutex;
+	sHostStatsMutex = NULL;
+
 #if SAFE_SSL
 	CRYPTO_set_locking_callback(NULL);
 	for_each(sSSLMutex.begin(), sSSLMutex.end(), DeletePointer());
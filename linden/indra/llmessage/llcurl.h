@@ -37,6 +37,7 @@
 
 #include "linden_common.h"
 
+#include <map>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -68,6 +69,18 @@ public:
 		F64 mTotalTime;
 		F64 mSpeedDownload;
 	};
+
+	// Accumulated per-host transfer statistics, keyed by URL authority
+	// ("host:port"). Updated from whichever thread completes the request.
+	struct HostStats
+	{
+		HostStats() : mRequests(0), mFailures(0), mBytes(0.0), mSeconds(0.0) {}
+		U32 mRequests;
+		U32 mFailures;
+		F64 mBytes;
+		F64 mSeconds;
+	};
+	typedef std::map<std::string, HostStats> host_stats_map_t;
 	
 	class Responder
 	{
@@ -165,6 +178,25 @@ public:
 	 * @ brief curl error code -> string
 	 */
 	static std::string strerror(CURLcode errorcode);
+
+	/**
+	 * @ brief Returns the "host:port" part of url, used to key the host
+	 * statistics.
+	 */
+	static std::string getHostKey(const std::string& url);
+
+	/**
+	 * @ brief Copy out the per-host transfer statistics.
+	 */
+	static void getHostStats(host_stats_map_t& stats);
+
+	/**
+	 * @ brief Log the per-host transfer statistics.
+	 */
+	static void dumpHostStats();
+
+	// Called by Easy when a request completes
+	static void recordTransfer(const std::string& host, bool success, const TransferInfo& info);
 	
 	// For OpenSSL callbacks
 	static std::vector<LLMutex*> sSSLMutex;
@@ -176,6 +208,9 @@ public:
 private:
 	static std::string sCAPath;
 	static std::string sCAFile;
+
+	static LLMutex* sHostStatsMutex;
+	static host_stats_map_t sHostStats;
 };
 
 namespace boost
@@ -199,6 +234,14 @@ public:
 	S32  process();
 	S32  getQueued();
 
+	// Allow GETs to the same host to be pipelined on one connection.
+	// Only affects multi handles created after the call.
+	void setPipelining(bool pipelining) { mPipelining = pipelining; }
+	// Cap on connections to any one host per multi handle, 0 for no
+	// limit. Needs libcurl 7.30.0; ignored with older versions. Only
+	// affects multi handles created after the call.
+	void setMaxHostConnections(S32 max_connections) { mMaxHostConnections = max_connections; }
+
 private:
 	void addMulti();
 	LLCurl::Easy* allocEasy();
@@ -209,6 +252,8 @@ private:
 	curlmulti_set_t mMultiSet;
 	LLCurl::Multi* mActiveMulti;
 	S32 mActiveRequestCount;
+	bool mPipelining;
+	S32 mMaxHostConnections;
 	U32 mThreadID; // debug
 };
 
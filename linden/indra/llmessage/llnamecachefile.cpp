@@ -0,0 +1,295 @@
+/** 
+ * @file llnamecachefile.cpp
+ * @brief Compact binary on-disk store shared by LLCacheName and
+ * LLAvatarNameCache.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llnamecachefile.h"
+
+#include "llavatarname.h"
+
+#include <iostream>
+
+// Bump when the record layout changes; older files are then ignored and
+// the caches refill from the network.
+static const U32 NAME_CACHE_FILE_VERSION = 1;
+static const char NAME_CACHE_FILE_MAGIC[4] = { 'L', 'L', 'N', 'C' };
+
+// Files are only ever read back on the machine that wrote them, so values
+// are stored in native byte order. The marker rejects a cache copied
+// between machines of different endianness.
+static const U32 NAME_CACHE_BYTE_ORDER = 0x01020304;
+
+static const S32 NAME_CACHE_HEADER_SIZE = 16;
+
+// Display name record flags
+static const U8 FLAG_DISPLAY_NAME_DEFAULT = 0x01;
+
+LLNameCacheFile::LLNameCacheFile()
+:	mReadPos(0),
+	mRecordCount(0)
+{
+}
+
+bool LLNameCacheFile::read(std::istream& istr)
+{
+	mData.clear();
+	mReadPos = 0;
+	mRecordCount = 0;
+
+	istr.seekg(0, std::ios::end);
+	std::streamoff size = istr.tellg();
+	istr.seekg(0, std::ios::beg);
+	if (size < NAME_CACHE_HEADER_SIZE)
+	{
+		return false;
+	}
+
+	char header[NAME_CACHE_HEADER_SIZE];
+	istr.read(header, NAME_CACHE_HEADER_SIZE);
+	if (!istr.good()
+		|| memcmp(header, NAME_CACHE_FILE_MAGIC, sizeof(NAME_CACHE_FILE_MAGIC)))
+	{
+		return false;
+	}
+
+	U32 version, byte_order, count;
+	memcpy(&version, header + 4, sizeof(U32));
+	memcpy(&byte_order, header + 8, sizeof(U32));
+	memcpy(&count, header + 12, sizeof(U32));
+	if (version != NAME_CACHE_FILE_VERSION
+		|| byte_order != NAME_CACHE_BYTE_ORDER)
+	{
+		llinfos << "Ignoring name cache file version " << version << llendl;
+		return false;
+	}
+
+	// One read for the whole body; records are copied out of it by nextRecord().
+	mData.resize((size_t)(size - NAME_CACHE_HEADER_SIZE));
+	if (!mData.empty())
+	{
+		istr.read((char*)&mData[0], mData.size());
+		if ((size_t)istr.gcount() != mData.size())
+		{
+			llwarns << "Truncated name cache file" << llendl;
+			mData.clear();
+			return false;
+		}
+	}
+
+	// Walk every record up front so a corrupt file is rejected as a whole
+	// instead of half importing.
+	Record record;
+	U32 found = 0;
+	while (nextRecord(record))
+	{
+		++found;
+	}
+	if (mReadPos != mData.size() || found != count)
+	{
+		llwarns << "Discarding corrupt name cache file" << llendl;
+		mData.clear();
+		mReadPos = 0;
+		return false;
+	}
+	rewind();
+	mRecordCount = (S32)count;
+	return true;
+}
+
+void LLNameCacheFile::write(std::ostream& ostr) const
+{
+	U32 version = NAME_CACHE_FILE_VERSION;
+	U32 byte_order = NAME_CACHE_BYTE_ORDER;
+	U32 count = (U32)mRecordCount;
+	ostr.write(NAME_CACHE_FILE_MAGIC, sizeof(NAME_CACHE_FILE_MAGIC));
+	ostr.write((const char*)&version, sizeof(U32));
+	ostr.write((const char*)&byte_order, sizeof(U32));
+	ostr.write((const char*)&count, sizeof(U32));
+	if (!mData.empty())
+	{
+		ostr.write((const char*)&mData[0], mData.size());
+	}
+}
+
+void LLNameCacheFile::addAgent(const LLUUID& id, U32 create_time,
+							   const std::string& first, const std::string& last)
+{
+	packU8(RECORD_AGENT);
+	packUUID(id);
+	packU32(create_time);
+	packString(first);
+	packString(last);
+	++mRecordCount;
+}
+
+void LLNameCacheFile::addGroup(const LLUUID& id, U32 create_time, const std::string& name)
+{
+	packU8(RECORD_GROUP);
+	packUUID(id);
+	packU32(create_time);
+	packString(name);
+	++mRecordCount;
+}
+
+void LLNameCacheFile::addAvatarName(const LLUUID& id, const LLAvatarName& av_name)
+{
+	packU8(RECORD_DISPLAY_NAME);
+	packUUID(id);
+	packU8(av_name.mIsDisplayNameDefault ? FLAG_DISPLAY_NAME_DEFAULT : 0);
+	packF64(av_name.mExpires);
+	packF64(av_name.mNextUpdate);
+	packString(av_name.mUsername);
+	packString(av_name.mDisplayName);
+	packString(av_name.mLegacyFirstName);
+	packString(av_name.mLegacyLastName);
+	++mRecordCount;
+}
+
+bool LLNameCacheFile::nextRecord(Record& record)
+{
+	if (mReadPos >= mData.size())
+	{
+		return false;
+	}
+
+	bool ok = unpackU8(record.mType) && unpackUUID(record.mID);
+	if (ok)
+	{
+		switch (record.mType)
+		{
+		case RECORD_AGENT:
+			ok = unpackU32(record.mCreateTime)
+				&& unpackString(record.mFirst)
+				&& unpackString(record.mLast);
+			break;
+		case RECORD_GROUP:
+			ok = unpackU32(record.mCreateTime)
+				&& unpackString(record.mFirst);
+			record.mLast.clear();
+			break;
+		case RECORD_DISPLAY_NAME:
+		{
+			U8 flags = 0;
+			ok = unpackU8(flags)
+				&& unpackF64(record.mExpires)
+				&& unpackF64(record.mNextUpdate)
+				&& unpackString(record.mFirst)
+				&& unpackString(record.mLast)
+				&& unpackString(record.mLegacyFirst)
+				&& unpackString(record.mLegacyLast);
+			record.mIsDisplayNameDefault = (flags & FLAG_DISPLAY_NAME_DEFAULT) != 0;
+			break;
+		}
+		default:
+			ok = false;
+			break;
+		}
+	}
+
+	if (!ok)
+	{
+		// Can't resynchronize past a bad record, drop the remainder.
+		llwarns << "Corrupt name cache record at offset " << mReadPos << llendl;
+		mReadPos = mData.size();
+	}
+	return ok;
+}
+
+void LLNameCacheFile::packU8(U8 value)
+{
+	mData.push_back(value);
+}
+
+void LLNameCacheFile::packU32(U32 value)
+{
+	const U8* bytes = (const U8*)&value;
+	mData.insert(mData.end(), bytes, bytes + sizeof(U32));
+}
+
+void LLNameCacheFile::packF64(F64 value)
+{
+	const U8* bytes = (const U8*)&value;
+	mData.insert(mData.end(), bytes, bytes + sizeof(F64));
+}
+
+void LLNameCacheFile::packString(const std::string& value)
+{
+	packU32((U32)value.size());
+	mData.insert(mData.end(), value.begin(), value.end());
+}
+
+void LLNameCacheFile::packUUID(const LLUUID& value)
+{
+	mData.insert(mData.end(), value.mData, value.mData + UUID_BYTES);
+}
+
+bool LLNameCacheFile::unpackU8(U8& value)
+{
+	if (1 > mData.size() - mReadPos) return false;
+	value = mData[mReadPos++];
+	return true;
+}
+
+bool LLNameCacheFile::unpackU32(U32& value)
+{
+	if (sizeof(U32) > mData.size() - mReadPos) return false;
+	memcpy(&value, &mData[mReadPos], sizeof(U32));
+	mReadPos += sizeof(U32);
+	return true;
+}
+
+bool LLNameCacheFile::unpackF64(F64& value)
+{
+	if (sizeof(F64) > mData.size() - mReadPos) return false;
+	memcpy(&value, &mData[mReadPos], sizeof(F64));
+	mReadPos += sizeof(F64);
+	return true;
+}
+
+bool LLNameCacheFile::unpackString(std::string& value)
+{
+	U32 length = 0;
+	if (!unpackU32(length)) return false;
+	if (length > mData.size() - mReadPos) return false;
+	value.assign((const char*)&mData[0] + mReadPos, length);
+	mReadPos += length;
+	return true;
+}
+
+bool LLNameCacheFile::unpackUUID(LLUUID& value)
+{
+	if ((size_t)UUID_BYTES > mData.size() - mReadPos) return false;
+	memcpy(value.mData, &mData[mReadPos], UUID_BYTES);
+	mReadPos += UUID_BYTES;
+	return true;
+}
@@ -0,0 +1,128 @@
+/** 
+ * @file llnamecachefile.h
+ * @brief Compact binary on-disk store shared by LLCacheName and
+ * LLAvatarNameCache.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLNAMECACHEFILE_H
+#define LL_LLNAMECACHEFILE_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "lluuid.h"
+
+class LLAvatarName;
+
+// Both name caches used to round-trip through pretty-printed LLSD XML,
+// which dominated login time for users with large caches. This is a flat,
+// versioned record stream instead: the whole file is pulled in with a
+// single read and each record is then copied out of that buffer into a
+// Record by nextRecord().
+//
+// Writing:
+//   LLNameCacheFile file;
+//   gCacheName->exportFile(file);
+//   LLAvatarNameCache::exportFile(file);
+//   file.write(ostr);
+//
+// Reading:
+//   LLNameCacheFile file;
+//   if (file.read(istr))
+//   {
+//       gCacheName->importFile(file);
+//       LLAvatarNameCache::importFile(file);
+//   }
+class LLNameCacheFile
+{
+public:
+	enum ERecordType
+	{
+		RECORD_AGENT = 1,			// legacy first/last name
+		RECORD_GROUP = 2,			// group name
+		RECORD_DISPLAY_NAME = 3		// LLAvatarName
+	};
+
+	// One decoded record. Which members are meaningful depends on mType.
+	struct Record
+	{
+		U8			mType;
+		LLUUID		mID;
+		U32			mCreateTime;		// agent and group records
+		F64			mExpires;			// display name records
+		F64			mNextUpdate;		// display name records
+		bool		mIsDisplayNameDefault;
+		std::string	mFirst;				// first name, group name or username
+		std::string	mLast;				// last name or display name
+		std::string	mLegacyFirst;		// display name records
+		std::string	mLegacyLast;		// display name records
+	};
+
+	LLNameCacheFile();
+
+	// Reads the entire stream into memory. Returns false if the stream
+	// is empty, truncated, was written by a different file version or
+	// holds a corrupt record; nothing is kept in that case.
+	bool read(std::istream& istr);
+	void write(std::ostream& ostr) const;
+
+	// Appending records for write()
+	void addAgent(const LLUUID& id, U32 create_time,
+				  const std::string& first, const std::string& last);
+	void addGroup(const LLUUID& id, U32 create_time, const std::string& name);
+	void addAvatarName(const LLUUID& id, const LLAvatarName& av_name);
+
+	// Iterating records after read(). Each cache walks the records it
+	// cares about, so rewind() before handing the file to the next one.
+	void rewind()				{ mReadPos = 0; }
+	bool nextRecord(Record& record);
+
+	S32 getRecordCount() const	{ return mRecordCount; }
+
+private:
+	void packU8(U8 value);
+	void packU32(U32 value);
+	void packF64(F64 value);
+	void packString(const std::string& value);
+	void packUUID(const LLUUID& value);
+
+	bool unpackU8(U8& value);
+	bool unpackU32(U32& value);
+	bool unpackF64(F64& value);
+	bool unpackString(std::string& value);
+	bool unpackUUID(LLUUID& value);
+
+	std::vector<U8>	mData;
+	size_t			mReadPos;
+	S32				mRecordCount;
+};
+
+#endif // LL_LLNAMECACHEFILE_H
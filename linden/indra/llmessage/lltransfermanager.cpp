@@ -47,6 +47,28 @@
 const S32 MAX_PACKET_DATA_SIZE = 2048;
 const S32 MAX_PARAMS_SIZE = 1024;
 
+// Bounds on the number of requests a target channel keeps outstanding with
+// its source.  The window starts at the default and adapts between the
+// bounds once round trip and throughput samples are in.
+const S32 LL_TRANSFER_MIN_WINDOW = 4;
+const S32 LL_TRANSFER_DEFAULT_WINDOW = 8;
+const S32 LL_TRANSFER_MAX_WINDOW = 32;
+
+// Requests at or above this priority (asset storage asks for 101 for
+// is_priority requests and 100 otherwise) go out ahead of the queue and
+// may use a few slots beyond the window, so a user-visible fetch never
+// waits behind a full window of bulk downloads.
+const F32 LL_TRANSFER_URGENT_PRIORITY = 101.f;
+const S32 LL_TRANSFER_URGENT_SLOTS = 2;
+
+// Weight of the newest sample in the channel's running averages.
+const F32 LL_TRANSFER_AVERAGE_ALPHA = 0.25f;
+
+// A sent transfer that hasn't heard from the source for this long stops
+// counting against the window.  The transfer itself is left alone, since
+// the source may just be serving higher priority transfers first.
+const F32 LL_TRANSFER_SLOT_TIMEOUT = 30.f;
+
 LLTransferManager gTransferManager;
 LLTransferSource::stype_scfunc_map LLTransferSource::sSourceCreateMap;
 
@@ -347,6 +369,7 @@ void LLTransferManager::processTransferInfo(LLMessageSystem *msgp, void **)
 	llinfos << "Receiving " << transfer_id << ", size " << size << " bytes" << llendl;
 	ttp->setSize(size);
 	ttp->setGotInfo(TRUE);
+	ttp->mLastActivityTime = ttp->mTimer.getElapsedTimeF32();
 
 	// OK, at this point we to handle any delayed transfer packets (which could happen
 	// if this packet was lost)
@@ -392,6 +415,7 @@ void LLTransferManager::processTransferInfo(LLMessageSystem *msgp, void **)
 		if (ret_code == LLTS_OK)
 		{
 			ttp->setLastPacketID(packet_id);
+			ttp->mBytesReceived += size;
 		}
 
 		if (status != LLTS_OK)
@@ -445,6 +469,7 @@ void LLTransferManager::processTransferPacket(LLMessageSystem *msgp, void **)
 			<< " from " << msgp->getSender() << llendl;
 		return;
 	}
+	ttp->mLastActivityTime = ttp->mTimer.getElapsedTimeF32();
 
 	size = msgp->getSize("TransferData", "Data");
 
@@ -516,6 +541,7 @@ void LLTransferManager::processTransferPacket(LLMessageSystem *msgp, void **)
 		if (ret_code == LLTS_OK)
 		{
 			ttp->setLastPacketID(packet_id);
+			ttp->mBytesReceived += size;
 		}
 
 		if (status != LLTS_OK)
@@ -671,6 +697,12 @@ void LLTransferConnection::updateTransfers()
 	// (large packet gaps that don't appear to be getting filled in, most likely)
 	// Probably should NOT be doing timeouts for other things, as new priority scheme
 	// means that a high priority transfer COULD block a transfer for a long time.
+	// For now, just send any queued requests the window has grown room for.
+	ttc_iter ttc_iter_cur;
+	for (ttc_iter_cur = mTransferTargetChannels.begin(); ttc_iter_cur != mTransferTargetChannels.end(); ttc_iter_cur++)
+	{
+		(*ttc_iter_cur)->updateTransfers();
+	}
 }
 
 
@@ -922,7 +954,10 @@ BOOL LLTransferSourceChannel::deleteTransfer(LLTransferSource *tsp)
 
 LLTransferTargetChannel::LLTransferTargetChannel(const LLTransferChannelType channel_type, const LLHost &host) :
 	mChannelType(channel_type),
-	mHost(host)
+	mHost(host),
+	mRequestSequence(0),
+	mThroughput(0.f),
+	mAvgTransferSize(0.f)
 {
 }
 
@@ -931,11 +966,12 @@ LLTransferTargetChannel::~LLTransferTargetChannel()
 	tt_iter iter;
 	for (iter = mTransferTargets.begin(); iter != mTransferTargets.end(); iter++)
 	{
-		// Abort all of the current transfers
+		// Abort all of the current transfers, queued ones included
 		(*iter)->abortTransfer();
 		delete *iter;
 	}
 	mTransferTargets.clear();
+	mQueuedRequests.clear();
 }
 
 
@@ -957,14 +993,117 @@ void LLTransferTargetChannel::requestTransfer(
 	}
 
 	ttp->applyParams(target_params);
+
+	// Queued targets are in mTransferTargets as well, so they can be
+	// found, aborted and deleted like any other.
 	addTransferTarget(ttp);
 
-	sendTransferRequest(ttp, source_params, priority);
+	// Queue the request rather than sending it straight away, so that a
+	// burst of requests doesn't all hit the source at once and bury the
+	// ones that matter behind it.
+	U8 tmp[MAX_PARAMS_SIZE];
+	LLDataPackerBinaryBuffer dp(tmp, MAX_PARAMS_SIZE);
+	source_params.packParams(dp);
+	S32 len = dp.getCurrentSize();
+
+	LLQueuedRequest& request = mQueuedRequests[request_key_t(priority, mRequestSequence++)];
+	request.mTargetp = ttp;
+	request.mSourceType = source_params.getType();
+	request.mPriority = priority;
+	request.mParams.assign(tmp, tmp + len);
+
+	updateTransfers();
+}
+
+
+void LLTransferTargetChannel::updateTransfers()
+{
+	if (mQueuedRequests.empty())
+	{
+		return;
+	}
+
+	// Count the sent transfers still holding a slot.
+	S32 in_flight = 0;
+	tt_iter tt_it;
+	for (tt_it = mTransferTargets.begin(); tt_it != mTransferTargets.end(); tt_it++)
+	{
+		LLTransferTarget *ttp = *tt_it;
+		if (ttp->mRequestSent
+			&& (ttp->mTimer.getElapsedTimeF32() - ttp->mLastActivityTime < LL_TRANSFER_SLOT_TIMEOUT))
+		{
+			in_flight++;
+		}
+	}
+
+	const S32 window = getRequestWindow();
+	while (!mQueuedRequests.empty())
+	{
+		request_queue_t::iterator iter = mQueuedRequests.begin();
+		const bool urgent = (iter->second.mPriority >= LL_TRANSFER_URGENT_PRIORITY);
+		const S32 limit = urgent ? window + LL_TRANSFER_URGENT_SLOTS : window;
+		if (in_flight >= limit)
+		{
+			break;
+		}
+
+		LLQueuedRequest request = iter->second;
+		mQueuedRequests.erase(iter);
+
+		LLTransferTarget *ttp = request.mTargetp;
+		ttp->mRequestSent = true;
+		ttp->mSentTime = ttp->mTimer.getElapsedTimeF32();
+		ttp->mLastActivityTime = ttp->mSentTime;
+		in_flight++;
+		sendTransferRequest(ttp,
+							request.mSourceType,
+							request.mParams.empty() ? NULL : &request.mParams[0],
+							(S32)request.mParams.size(),
+							request.mPriority);
+	}
+}
+
+
+S32 LLTransferTargetChannel::getRequestWindow() const
+{
+	F32 rtt_secs = 0.f;
+	if (gMessageSystem)
+	{
+		LLCircuitData *cdp = gMessageSystem->mCircuitInfo.findCircuit(mHost);
+		if (cdp)
+		{
+			rtt_secs = cdp->getPingDelayAveraged() * 0.001f;
+		}
+	}
+	return computeRequestWindow(rtt_secs, mThroughput, mAvgTransferSize);
+}
+
+
+//static
+S32 LLTransferTargetChannel::computeRequestWindow(const F32 rtt_secs,
+												  const F32 bytes_per_sec,
+												  const F32 avg_transfer_bytes)
+{
+	if ((rtt_secs <= 0.f) || (bytes_per_sec <= 0.f) || (avg_transfer_bytes <= 0.f))
+	{
+		// No samples yet.
+		return LL_TRANSFER_DEFAULT_WINDOW;
+	}
+
+	// Each transfer spends a round trip on the request/info exchange before
+	// any data moves.  Keep enough extra transfers outstanding to cover the
+	// data that could have arrived in that time.
+	F32 extra = rtt_secs * bytes_per_sec / avg_transfer_bytes;
+	extra = llmin(extra, (F32)LL_TRANSFER_MAX_WINDOW);
+	return llclamp(LL_TRANSFER_MIN_WINDOW + llceil(extra),
+				   LL_TRANSFER_MIN_WINDOW,
+				   LL_TRANSFER_MAX_WINDOW);
 }
 
 
 void LLTransferTargetChannel::sendTransferRequest(LLTransferTarget *targetp,
-												  const LLTransferSourceParams &params,
+												  const LLTransferSourceType source_type,
+												  const U8 *params, const S32 params_size,
 												  const F32 priority)
 {
 	//
@@ -977,15 +1116,10 @@ void LLTransferTargetChannel::sendTransferRequest(LLTransferTarget *targetp,
 	gMessageSystem->newMessage("TransferRequest");
 	gMessageSystem->nextBlock("TransferInfo");
 	gMessageSystem->addUUID("TransferID", targetp->getID());
-	gMessageSystem->addS32("SourceType", params.getType());
+	gMessageSystem->addS32("SourceType", source_type);
 	gMessageSystem->addS32("ChannelType", getChannelType());
 	gMessageSystem->addF32("Priority", priority);
-
-	U8 tmp[MAX_PARAMS_SIZE];
-	LLDataPackerBinaryBuffer dp(tmp, MAX_PARAMS_SIZE);
-	params.packParams(dp);
-	S32 len = dp.getCurrentSize();
-	gMessageSystem->addBinaryData("Params", tmp, len);
+	gMessageSystem->addBinaryData("Params", params, params_size);
 
 	gMessageSystem->sendReliable(mHost);
 }
@@ -1020,8 +1154,19 @@ BOOL LLTransferTargetChannel::deleteTransfer(LLTransferTarget *ttp)
 	{
 		if (*iter == ttp)
 		{
+			if (ttp->mRequestSent)
+			{
+				recordCompletion(ttp);
+			}
+			else
+			{
+				removeQueuedRequest(ttp);
+			}
 			delete ttp;
 			mTransferTargets.erase(iter);
+
+			// A slot just opened up.
+			updateTransfers();
 			return TRUE;
 		}
 	}
@@ -1031,6 +1176,53 @@ BOOL LLTransferTargetChannel::deleteTransfer(LLTransferTarget *ttp)
 }
 
 
+void LLTransferTargetChannel::removeQueuedRequest(LLTransferTarget *ttp)
+{
+	request_queue_t::iterator iter;
+	for (iter = mQueuedRequests.begin(); iter != mQueuedRequests.end(); iter++)
+	{
+		if (iter->second.mTargetp == ttp)
+		{
+			mQueuedRequests.erase(iter);
+			return;
+		}
+	}
+}
+
+
+void LLTransferTargetChannel::recordCompletion(LLTransferTarget *ttp)
+{
+	const F32 now = ttp->mTimer.getElapsedTimeF32();
+	const F32 queued_secs = ttp->mSentTime;
+	const F32 transfer_secs = now - ttp->mSentTime;
+	const S32 bytes = ttp->mBytesReceived;
+
+	if ((bytes <= 0) || (transfer_secs <= 0.f))
+	{
+		lldebugs << "Transfer " << ttp->getID() << " from " << mHost
+				 << " ended with no data after " << transfer_secs << " sec" << llendl;
+		return;
+	}
+
+	const F32 bytes_per_sec = (F32)bytes / transfer_secs;
+	lldebugs << "Transfer " << ttp->getID() << " from " << mHost << ": "
+			 << bytes << " bytes in " << transfer_secs << " sec ("
+			 << (bytes_per_sec * 8.f / 1024.f) << " kbps), queued "
+			 << queued_secs << " sec" << llendl;
+
+	if (mThroughput <= 0.f)
+	{
+		mThroughput = bytes_per_sec;
+		mAvgTransferSize = (F32)bytes;
+	}
+	else
+	{
+		mThroughput = lerp(mThroughput, bytes_per_sec, LL_TRANSFER_AVERAGE_ALPHA);
+		mAvgTransferSize = lerp(mAvgTransferSize, (F32)bytes, LL_TRANSFER_AVERAGE_ALPHA);
+	}
+}
+
+
 //
 // LLTransferSource implementation
 //
@@ -1195,9 +1387,14 @@ LLTransferTarget::LLTransferTarget(
 	mType(type),
 	mSourceType(source_type),
 	mID(transfer_id),
+	mChannelp(NULL),
 	mGotInfo(FALSE),
 	mSize(0),
-	mLastPacketID(-1)
+	mLastPacketID(-1),
+	mRequestSent(false),
+	mSentTime(0.f),
+	mLastActivityTime(0.f),
+	mBytesReceived(0)
 {
 }
 
@@ -1221,11 +1418,16 @@ void LLTransferTarget::abortTransfer()
 {
 	// Send a message up, call the completion callback
 	llinfos << "LLTransferTarget::Aborting transfer " << getID() << " from " << mChannelp->getHost() << llendl;
-	gMessageSystem->newMessage("TransferAbort");
-	gMessageSystem->nextBlock("TransferInfo");
-	gMessageSystem->addUUID("TransferID", getID());
-	gMessageSystem->addS32("ChannelType", mChannelp->getChannelType());
-	gMessageSystem->sendReliable(mChannelp->getHost());
+	if (mRequestSent)
+	{
+		// A request still waiting in the channel queue was never seen
+		// by the source.
+		gMessageSystem->newMessage("TransferAbort");
+		gMessageSystem->nextBlock("TransferInfo");
+		gMessageSystem->addUUID("TransferID", getID());
+		gMessageSystem->addS32("ChannelType", mChannelp->getChannelType());
+		gMessageSystem->sendReliable(mChannelp->getHost());
+	}
 
 	completionCallback(LLTS_ABORT);
 }
@@ -36,12 +36,14 @@
 
 #include <map>
 #include <list>
+#include <vector>
 
 #include "llhost.h"
 #include "lluuid.h"
 #include "llthrottle.h"
 #include "llpriqueuemap.h"
 #include "llassettype.h"
+#include "lltimer.h"
 
 //
 // Definition of the manager class for the new LLXfer replacement.
@@ -240,25 +242,73 @@ public:
 	LLTransferTarget		*findTransferTarget(const LLUUID &transfer_id);
 	BOOL					deleteTransfer(LLTransferTarget *ttp);
 
+	// Sends queued requests to the source while there is room in the
+	// request window.  Called per frame and whenever a transfer finishes.
+	void					updateTransfers();
 
 	LLTransferChannelType	getChannelType() const		{ return mChannelType; }
 	LLHost					getHost() const				{ return mHost; }
 
+	// Transfers sent to the source, and those still waiting to be sent.
+	// Both kinds are in mTransferTargets.
+	S32						getNumActiveTransfers() const	{ return (S32)(mTransferTargets.size() - mQueuedRequests.size()); }
+	S32						getNumQueuedTransfers() const	{ return (S32)mQueuedRequests.size(); }
+	F32						getThroughput() const			{ return mThroughput; }	// bytes/sec per transfer, averaged
+	S32						getRequestWindow() const;
+
+	// Number of transfers to keep outstanding so that the request/info
+	// round trip of one transfer overlaps the data phase of the others.
+	static S32				computeRequestWindow(const F32 rtt_secs,
+												 const F32 bytes_per_sec,
+												 const F32 avg_transfer_bytes);
+
 protected:
 	void sendTransferRequest(LLTransferTarget *targetp,
-							 const LLTransferSourceParams &params,
+							 const LLTransferSourceType source_type,
+							 const U8 *params, const S32 params_size,
 							 const F32 priority);
 
 	void					addTransferTarget(LLTransferTarget *targetp);
+	void					removeQueuedRequest(LLTransferTarget *ttp);
+	void					recordCompletion(LLTransferTarget *ttp);
 
 	friend class LLTransferTarget;
 	friend class LLTransferManager;
 protected:
 	typedef std::list<LLTransferTarget *>::iterator tt_iter;
 
+	// A request that has been accepted from the caller but not yet sent
+	// to the source.  The source params are packed up front since the
+	// caller's params object does not outlive requestTransfer().
+	struct LLQueuedRequest
+	{
+		LLTransferTarget		*mTargetp;
+		LLTransferSourceType	mSourceType;
+		F32						mPriority;
+		std::vector<U8>			mParams;
+	};
+
+	// Highest priority first, FIFO within a priority.
+	typedef std::pair<F32, U32> request_key_t;
+	struct request_key_less
+	{
+		bool operator()(const request_key_t &a, const request_key_t &b) const
+		{
+			return (a.first > b.first) || ((a.first == b.first) && (a.second < b.second));
+		}
+	};
+	typedef std::map<request_key_t, LLQueuedRequest, request_key_less> request_queue_t;
+
 	LLTransferChannelType			mChannelType;
 	LLHost							mHost;
 	std::list<LLTransferTarget *>	mTransferTargets;
+
+	request_queue_t					mQueuedRequests;
+	U32								mRequestSequence;
+
+	// Running averages over completed transfers, fed to computeRequestWindow().
+	F32								mThroughput;
+	F32								mAvgTransferSize;
 };
 
 
@@ -435,6 +485,15 @@ protected:
 	S32						mSize;
 	S32						mLastPacketID;
 
+	// Per-transfer metrics.  mTimer runs from the time the request is
+	// queued; mSentTime is when it was actually sent to the source and
+	// mLastActivityTime when the source was last heard from.
+	bool					mRequestSent;
+	LLTimer					mTimer;
+	F32						mSentTime;
+	F32						mLastActivityTime;
+	S32						mBytesReceived;
+
 	transfer_packet_map		mDelayedPacketMap; // Packets that are waiting because of missing/out of order issues
 };
 
@@ -294,8 +294,11 @@ S32 LLXfer::processEOF()
 
 	if (LL_ERR_NOERR == mCallbackResult)
 	{
+		F32 xfer_secs = mXferTimer.getElapsedTimeF32();
+		F32 kbps = (xfer_secs > 0.f) ? ((F32)mXferSize * 8.f / 1024.f / xfer_secs) : 0.f;
 		llinfos << "xfer from " << mRemoteHost << " complete: " << getFileName()
-				<< llendl;
+				<< " (" << mXferSize << " bytes in " << xfer_secs << " sec, "
+				<< kbps << " kbps)" << llendl;
 	}
 	else
 	{
@@ -78,6 +78,8 @@ class LLXfer
 	LLTimer ACKTimer;
 	S32 mRetries;
 
+	LLTimer mXferTimer;		// Runs from the time the download was started
+
 	static const U32 XFER_FILE;
 	static const U32 XFER_VFILE;
 	static const U32 XFER_MEM;
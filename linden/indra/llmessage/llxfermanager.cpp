@@ -1160,6 +1160,7 @@ void LLXferManager::startPendingDownloads()
 			xferp = *iter;
 			if (start_count-- <= 0)
 				break;
+			xferp->mXferTimer.reset();
 			result = xferp->startDownload();
 			if(result)
 			{
@@ -1039,7 +1039,8 @@ S32 LLPrimitive::unpackTEField(U8 *cur_ptr, U8 *buffer_end, U8 *data_ptr, U8 dat
 
 		i |= *cur_ptr++;
 
-		for (S32 j = 0; j < face_count; j++)
+		// Stop once the remaining mask bits are all clear.
+		for (S32 j = 0; j < face_count && i != 0; j++)
 		{
 			if (i & 0x01)
 			{
@@ -1239,27 +1240,11 @@ S32 LLPrimitive::unpackTEMessage(LLMessageSystem *mesgsys, char *block_name, con
 {
 	// use a negative block_num to indicate a single-block read (a non-variable block)
 	S32 retval = 0;
-	const U32 MAX_TES = 32;
-
-	// Avoid construction of 32 UUIDs per call. JC
 
-	U8     image_data[MAX_TES*16];
-	U8	  colors[MAX_TES*4];
-	F32    scale_s[MAX_TES];
-	F32    scale_t[MAX_TES];
-	S16    offset_s[MAX_TES];
-	S16    offset_t[MAX_TES];
-	S16    image_rot[MAX_TES];
-	U8	   bump[MAX_TES];
-	U8	   media_flags[MAX_TES];
-    U8     glow[MAX_TES];
-	
 	const U32 MAX_TE_BUFFER = 4096;
 	U8 packed_buffer[MAX_TE_BUFFER];
-	U8 *cur_ptr = packed_buffer;
 
 	U32 size;
-	U32 face_count = 0;
 
 	if (block_num < 0)
 	{
@@ -1284,82 +1269,21 @@ S32 LLPrimitive::unpackTEMessage(LLMessageSystem *mesgsys, char *block_name, con
 		mesgsys->getBinaryDataFast(block_name, _PREHASH_TextureEntry, packed_buffer, 0, block_num, MAX_TE_BUFFER);
 	}
 
-	face_count = getNumTEs();
-
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)image_data, 16, face_count, MVT_LLUUID);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)colors, 4, face_count, MVT_U8);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)scale_s, 4, face_count, MVT_F32);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)scale_t, 4, face_count, MVT_F32);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)offset_s, 2, face_count, MVT_S16Array);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)offset_t, 2, face_count, MVT_S16Array);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)image_rot, 2, face_count, MVT_S16Array);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)bump, 1, face_count, MVT_U8);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)media_flags, 1, face_count, MVT_U8);
-	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)glow, 1, face_count, MVT_U8);
-	
-	LLColor4 color;
-	LLColor4U coloru;
-	for (U32 i = 0; i < face_count; i++)
-	{
-		retval |= setTETexture(i, ((LLUUID*)image_data)[i]);
-		retval |= setTEScale(i, scale_s[i], scale_t[i]);
-		retval |= setTEOffset(i, (F32)offset_s[i] / (F32)0x7FFF, (F32) offset_t[i] / (F32) 0x7FFF);
-		retval |= setTERotation(i, ((F32)image_rot[i] / TEXTURE_ROTATION_PACK_FACTOR) * F_TWO_PI);
-		retval |= setTEBumpShinyFullbright(i, bump[i]);
-		retval |= setTEMediaTexGen(i, media_flags[i]);
-		retval |= setTEGlow(i, (F32)glow[i] / (F32)0xFF);
-		coloru = LLColor4U(colors + 4*i);
-
-		// Note:  This is an optimization to send common colors (1.f, 1.f, 1.f, 1.f)
-		// as all zeros.  However, the subtraction and addition must be done in unsigned
-		// byte space, not in float space, otherwise off-by-one errors occur. JC
-		color.mV[VRED]		= F32(255 - coloru.mV[VRED])   / 255.f;
-		color.mV[VGREEN]	= F32(255 - coloru.mV[VGREEN]) / 255.f;
-		color.mV[VBLUE]		= F32(255 - coloru.mV[VBLUE])  / 255.f;
-		color.mV[VALPHA]	= F32(255 - coloru.mV[VALPHA]) / 255.f;
-
-		retval |= setTEColor(i, color);
-
-	}
+	LLTEContents tec;
+	parseTEMessage(packed_buffer, (S32)llmin(size, MAX_TE_BUFFER), tec);
+	retval = applyParsedTEMessage(tec);
 
 	return retval;
 }
 
 S32 LLPrimitive::unpackTEMessage(LLDataPacker &dp)
 {
-	// use a negative block_num to indicate a single-block read (a non-variable block)
 	S32 retval = 0;
-	const U32 MAX_TES = 32;
-
-	// Avoid construction of 32 UUIDs per call
-	static LLUUID image_ids[MAX_TES];
-
-	U8     image_data[MAX_TES*16];
-	U8	   colors[MAX_TES*4];
-	F32    scale_s[MAX_TES];
-	F32    scale_t[MAX_TES];
-	S16    offset_s[MAX_TES];
-	S16    offset_t[MAX_TES];
-	S16    image_rot[MAX_TES];
-	U8	   bump[MAX_TES];
-	U8	   media_flags[MAX_TES];
-    U8     glow[MAX_TES];
 
 	const U32 MAX_TE_BUFFER = 4096;
 	U8 packed_buffer[MAX_TE_BUFFER];
-	U8 *cur_ptr = packed_buffer;
 
 	S32 size;
-	U32 face_count = 0;
 
 	if (!dp.unpackBinaryData(packed_buffer, size, "TextureEntry"))
 	{
@@ -1373,55 +1297,111 @@ S32 LLPrimitive::unpackTEMessage(LLDataPacker &dp)
 		return retval;
 	}
 
-	face_count = getNumTEs();
-	U32 i;
+	LLTEContents tec;
+	parseTEMessage(packed_buffer, size, tec);
+	retval = applyParsedTEMessage(tec);
+
+	return retval;
+}
+
+void LLPrimitive::parseTEMessage(U8 *packed_buffer, S32 size, LLTEContents& tec)
+{
+	U8 *cur_ptr = packed_buffer;
+	U8 *buffer_end = packed_buffer + size;
+
+	tec.mFaceCount = llmin((U32)getNumTEs(), LLTEContents::MAX_TES);
+	if (tec.mFaceCount == 0)
+	{
+		return;
+	}
 
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)image_data, 16, face_count, MVT_LLUUID);
+	const U8 face_count = (U8)tec.mFaceCount;
+
+	cur_ptr += unpackTEField(cur_ptr, buffer_end, (U8 *)tec.mImageData, 16, face_count, MVT_LLUUID);
 	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)colors, 4, face_count, MVT_U8);
+	cur_ptr += unpackTEField(cur_ptr, buffer_end, (U8 *)tec.mColors, 4, face_count, MVT_U8);
 	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)scale_s, 4, face_count, MVT_F32);
+	cur_ptr += unpackTEField(cur_ptr, buffer_end, (U8 *)tec.mScaleS, 4, face_count, MVT_F32);
 	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)scale_t, 4, face_count, MVT_F32);
+	cur_ptr += unpackTEField(cur_ptr, buffer_end, (U8 *)tec.mScaleT, 4, face_count, MVT_F32);
 	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)offset_s, 2, face_count, MVT_S16Array);
+	cur_ptr += unpackTEField(cur_ptr, buffer_end, (U8 *)tec.mOffsetS, 2, face_count, MVT_S16Array);
 	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)offset_t, 2, face_count, MVT_S16Array);
+	cur_ptr += unpackTEField(cur_ptr, buffer_end, (U8 *)tec.mOffsetT, 2, face_count, MVT_S16Array);
 	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)image_rot, 2, face_count, MVT_S16Array);
+	cur_ptr += unpackTEField(cur_ptr, buffer_end, (U8 *)tec.mImageRot, 2, face_count, MVT_S16Array);
 	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)bump, 1, face_count, MVT_U8);
+	cur_ptr += unpackTEField(cur_ptr, buffer_end, (U8 *)tec.mBump, 1, face_count, MVT_U8);
 	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)media_flags, 1, face_count, MVT_U8);
+	cur_ptr += unpackTEField(cur_ptr, buffer_end, (U8 *)tec.mMediaFlags, 1, face_count, MVT_U8);
 	cur_ptr++;
-	cur_ptr += unpackTEField(cur_ptr, packed_buffer+size, (U8 *)glow, 1, face_count, MVT_U8);
+	cur_ptr += unpackTEField(cur_ptr, buffer_end, (U8 *)tec.mGlow, 1, face_count, MVT_U8);
+}
+
+S32 LLPrimitive::applyParsedTEMessage(const LLTEContents& tec)
+{
+	S32 retval = 0;
+	const U32 face_count = llmin(tec.mFaceCount, (U32)getNumTEs());
+
+	// Convert the packed fields to their float forms up front, a field at a
+	// time, so each loop runs over contiguous arrays.
+	F32 offset_s[LLTEContents::MAX_TES];
+	F32 offset_t[LLTEContents::MAX_TES];
+	F32 rotation[LLTEContents::MAX_TES];
+	F32 glow[LLTEContents::MAX_TES];
+	F32 colors[LLTEContents::MAX_TES*4];
+	U32 i;
 
 	for (i = 0; i < face_count; i++)
 	{
-		memcpy(image_ids[i].mData,&image_data[i*16],16);	/* Flawfinder: ignore */ 	
+		offset_s[i] = (F32)tec.mOffsetS[i] / (F32)0x7FFF;
+		offset_t[i] = (F32)tec.mOffsetT[i] / (F32)0x7FFF;
+		rotation[i] = ((F32)tec.mImageRot[i] / TEXTURE_ROTATION_PACK_FACTOR) * F_TWO_PI;
+		glow[i] = (F32)tec.mGlow[i] / (F32)0xFF;
 	}
-	
+
+	// Note:  This is an optimization to send common colors (1.f, 1.f, 1.f, 1.f)
+	// as all zeros.  However, the subtraction and addition must be done in unsigned
+	// byte space, not in float space, otherwise off-by-one errors occur. JC
+	for (i = 0; i < face_count*4; i++)
+	{
+		colors[i] = F32(255 - tec.mColors[i]) / 255.f;
+	}
+
+	LLUUID image_id;
 	LLColor4 color;
-	LLColor4U coloru;
 	for (i = 0; i < face_count; i++)
 	{
-		retval |= setTETexture(i, image_ids[i]);
-		retval |= setTEScale(i, scale_s[i], scale_t[i]);
-		retval |= setTEOffset(i, (F32)offset_s[i] / (F32)0x7FFF, (F32) offset_t[i] / (F32) 0x7FFF);
-		retval |= setTERotation(i, ((F32)image_rot[i] / TEXTURE_ROTATION_PACK_FACTOR) * F_TWO_PI);
-		retval |= setTEBumpShinyFullbright(i, bump[i]);
-		retval |= setTEMediaTexGen(i, media_flags[i]);
-		retval |= setTEGlow(i, (F32)glow[i] / (F32)0xFF);
-		coloru = LLColor4U(colors + 4*i);
-
-		// Note:  This is an optimization to send common colors (1.f, 1.f, 1.f, 1.f)
-		// as all zeros.  However, the subtraction and addition must be done in unsigned
-		// byte space, not in float space, otherwise off-by-one errors occur. JC
-		color.mV[VRED]		= F32(255 - coloru.mV[VRED])   / 255.f;
-		color.mV[VGREEN]	= F32(255 - coloru.mV[VGREEN]) / 255.f;
-		color.mV[VBLUE]		= F32(255 - coloru.mV[VBLUE])  / 255.f;
-		color.mV[VALPHA]	= F32(255 - coloru.mV[VALPHA]) / 255.f;
+		memcpy(image_id.mData, &tec.mImageData[i*16], 16);	/* Flawfinder: ignore */
+		color.setVec(colors + 4*i);
+
+		// Most updates resend every face unchanged; skip those rather than
+		// make eight virtual setTE*() calls that would each find nothing to do.
+		// Null image ids are always passed through, since subclasses reapply them.
+		const LLTextureEntry* te = getTE(i);
+		if (te
+			&& image_id.notNull()
+			&& te->getID() == image_id
+			&& te->mScaleS == tec.mScaleS[i]
+			&& te->mScaleT == tec.mScaleT[i]
+			&& te->mOffsetS == offset_s[i]
+			&& te->mOffsetT == offset_t[i]
+			&& te->mRotation == rotation[i]
+			&& te->getBumpShinyFullbright() == tec.mBump[i]
+			&& te->getMediaTexGen() == tec.mMediaFlags[i]
+			&& te->getGlow() == glow[i]
+			&& te->getColor() == color)
+		{
+			continue;
+		}
 
+		retval |= setTETexture(i, image_id);
+		retval |= setTEScale(i, tec.mScaleS[i], tec.mScaleT[i]);
+		retval |= setTEOffset(i, offset_s[i], offset_t[i]);
+		retval |= setTERotation(i, rotation[i]);
+		retval |= setTEBumpShinyFullbright(i, tec.mBump[i]);
+		retval |= setTEMediaTexGen(i, tec.mMediaFlags[i]);
+		retval |= setTEGlow(i, glow[i]);
 		retval |= setTEColor(i, color);
 	}
 
@@ -291,6 +291,25 @@ public:
 	
 };
 
+// Flat per-face copy of a decoded TextureEntry block.
+// See LLPrimitive::parseTEMessage() and LLPrimitive::applyParsedTEMessage().
+struct LLTEContents
+{
+	static const U32 MAX_TES = 32;
+
+	U8		mImageData[MAX_TES*16];
+	U8		mColors[MAX_TES*4];
+	F32		mScaleS[MAX_TES];
+	F32		mScaleT[MAX_TES];
+	S16		mOffsetS[MAX_TES];
+	S16		mOffsetT[MAX_TES];
+	S16		mImageRot[MAX_TES];
+	U8		mBump[MAX_TES];
+	U8		mMediaFlags[MAX_TES];
+	U8		mGlow[MAX_TES];
+
+	U32		mFaceCount;
+};
 
 class LLPrimitive : public LLXform
 {
@@ -366,6 +385,10 @@ public:
 	S32 unpackTEMessage(LLMessageSystem *mesgsys, char *block_name);
 	S32 unpackTEMessage(LLMessageSystem *mesgsys, char *block_name, const S32 block_num); // Variable num of blocks
 	BOOL unpackTEMessage(LLDataPacker &dp);
+	// Decodes every field of a packed TextureEntry block into tec in one go.
+	void parseTEMessage(U8 *packed_buffer, S32 size, LLTEContents& tec);
+	// Calls the setTE*() methods only for faces whose values differ from tec.
+	S32 applyParsedTEMessage(const LLTEContents& tec);
 	
 #ifdef CHECK_FOR_FINITE
 	inline void setPosition(const LLVector3& pos);
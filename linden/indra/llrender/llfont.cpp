@@ -141,6 +141,7 @@ LLFont::LLFont()
 
 	mRenderGlyphCount = 0;
 	mAddGlyphCount = 0;
+	mGlyphGeneration = 0;
 
 	mPointSize = 0;
 }
@@ -263,6 +264,7 @@ void LLFont::resetBitmapCache()
 		//not just flushing the bitmap
 		iter->second->mMetricsValid = FALSE;
 	}
+	mGlyphGeneration++;
 	mFontBitmapCachep->reset();
 
 	// Add the empty glyph`5
@@ -341,6 +343,7 @@ void LLFont::insertGlyphInfo(llwchar wch, LLFontGlyphInfo* gi) const
 	{
 		delete iter->second;
 		iter->second = gi;
+		mGlyphGeneration++;
 	}
 	else
 	{
@@ -191,6 +191,7 @@ protected:
 								   S32 stride = 0) const;
 	mutable S32 mRenderGlyphCount;
 	mutable S32 mAddGlyphCount;
+	mutable U32 mGlyphGeneration; // bumped whenever existing glyph info is replaced or invalidated
 };
 
 #endif // LL_FONT_
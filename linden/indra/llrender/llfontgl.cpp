@@ -69,6 +69,10 @@ const F32 PIXEL_CORRECTION_DISTANCE = 0.01f;
 const F32 PAD_UVY = 0.5f; // half of vertical padding between glyphs in the glyph texture
 const F32 DROP_SHADOW_SOFT_STRENGTH = 0.3f;
 
+// Longer strings (whole text editor buffers) aren't worth hashing and keeping
+const S32 MAX_LAYOUT_RUN_LENGTH = 256;
+const S32 MAX_LAYOUT_RUNS = 1024;
+
 F32 llfont_round_x(F32 x)
 {
 	//return llfloor((x-LLFontGL::sCurOrigin.mX)/LLFontGL::sScaleX+0.5f)*LLFontGL::sScaleX+LLFontGL::sCurOrigin.mX;
@@ -128,6 +132,7 @@ LLFontGL::LLFontGL(const LLFontGL &source)
 LLFontGL::~LLFontGL()
 {
 	clearEmbeddedChars();
+	clearLayoutRuns();
 }
 
 void LLFontGL::reset()
@@ -515,6 +520,13 @@ S32 LLFontGL::render(const LLWString &wstr,
 	// Remember last-used texture to avoid unnecesssary bind calls.
 	LLImageGL *last_bound_texture = NULL;
 
+	const layout_run_t* runp = getLayoutRun(wstr.c_str(), S32_MAX, use_embedded, TRUE);
+	if (runp && runp->mChars.size() != wstr.length())
+	{
+		// embedded terminator
+		runp = NULL;
+	}
+
 	for (i = begin_offset; i < begin_offset + length; i++)
 	{
 		llwchar wch = wstr[i];
@@ -584,12 +596,19 @@ S32 LLFontGL::render(const LLWString &wstr,
 		}
 		else
 		{
-			if (!hasGlyph(wch))
+			const LLFontGlyphInfo* fgi;
+			if (runp)
 			{
-				addChar(wch);
+				fgi = runp->mChars[i].mGlyph;
+			}
+			else
+			{
+				if (!hasGlyph(wch))
+				{
+					addChar(wch);
+				}
+				fgi = getGlyphInfo(wch);
 			}
-
-			const LLFontGlyphInfo* fgi= getGlyphInfo(wch);
 			if (!fgi)
 			{
 				llerrs << "Missing Glyph Info" << llendl;
@@ -630,12 +649,19 @@ S32 LLFontGL::render(const LLWString &wstr,
 			llwchar next_char = wstr[i+1];
 			if (next_char && (next_char < LAST_CHARACTER))
 			{
-				// Kern this puppy.
-				if (!hasGlyph(next_char))
+				if (runp)
 				{
-					addChar(next_char);
+					cur_x += runp->mChars[i].mXKerning;
+				}
+				else
+				{
+					// Kern this puppy.
+					if (!hasGlyph(next_char))
+					{
+						addChar(next_char);
+					}
+					cur_x += getXKerning(wch, next_char);
 				}
-				cur_x += getXKerning(wch, next_char);
 			}
 
 			// Round after kerning.
@@ -738,6 +764,14 @@ F32 LLFontGL::getWidthF32(const llwchar* wchars, const S32 begin_offset, const S
 		return 0;
 	}
 
+	// The kerning test below compares against max_chars rather than the end
+	// of the range, so only measurements from the start match a cached run.
+	const layout_run_t* runp = (begin_offset == 0) ? getLayoutRun(wchars, max_chars, use_embedded, FALSE) : NULL;
+	if (runp)
+	{
+		return runp->mWidth == 0 ? 0 : runp->mWidth / sScaleX;
+	}
+
 	const S32 LAST_CHARACTER = LLFont::LAST_CHAR_FULL;
 
 	F32 cur_x = 0;
@@ -805,6 +839,8 @@ S32 LLFontGL::maxDrawableChars(const llwchar* wchars, F32 max_pixels, S32 max_ch
 
 	F32 scaled_max_pixels =	(F32)llceil(max_pixels * sScaleX);
 
+	const layout_run_t* runp = getLayoutRun(wchars, max_chars, use_embedded, FALSE);
+
 	S32 i;
 	for (i=0; (i < max_chars); i++)
 	{
@@ -864,7 +900,7 @@ S32 LLFontGL::maxDrawableChars(const llwchar* wchars, F32 max_pixels, S32 max_ch
 				}
 			}
 
-			cur_x += getXAdvance(wch);
+			cur_x += runp ? runp->mChars[i].mXAdvance : getXAdvance(wch);
 			
 			if (scaled_max_pixels < cur_x)
 			{
@@ -875,7 +911,7 @@ S32 LLFontGL::maxDrawableChars(const llwchar* wchars, F32 max_pixels, S32 max_ch
 			if (((i+1) < max_chars) && wchars[i+1])
 			{
 				// Kern this puppy.
-				cur_x += getXKerning(wch, wchars[i+1]);
+				cur_x += runp ? runp->mChars[i].mXKerning : getXKerning(wch, wchars[i+1]);
 			}
 		}
 		// Round after kerning.
@@ -1103,6 +1139,116 @@ void LLFontGL::removeEmbeddedChar( llwchar wc ) const
 }
 
 
+// Returns the layout of wchars up to its terminator or max_chars, building it
+// if needed, or NULL if the text is too long to cache or has embedded items.
+const LLFontGL::layout_run_t* LLFontGL::getLayoutRun(const llwchar* wchars, S32 max_chars, BOOL use_embedded, BOOL need_glyphs) const
+{
+	if (use_embedded && !mEmbeddedChars.empty())
+	{
+		return NULL;
+	}
+
+	S32 length = 0;
+	U32 hash = 0;
+	const S32 max_length = llmin(max_chars, MAX_LAYOUT_RUN_LENGTH + 1);
+	while (length < max_length && wchars[length])
+	{
+		hash = hash * 31 + (U32)wchars[length];
+		length++;
+	}
+	if (length > MAX_LAYOUT_RUN_LENGTH)
+	{
+		return NULL;
+	}
+
+	layout_run_map_t::iterator iter = mLayoutRuns.find(hash);
+	layout_run_t* runp = (iter != mLayoutRuns.end()) ? iter->second : NULL;
+	if (runp
+		&& (runp->mGlyphGeneration != mGlyphGeneration
+			|| runp->mText.size() != (size_t)length
+			|| runp->mText.compare(0, length, wchars, length) != 0))
+	{
+		// stale, or another string with the same hash; lay this one out in its place
+		runp->mText.clear();
+	}
+	else if (!runp)
+	{
+		if ((S32)mLayoutRuns.size() >= MAX_LAYOUT_RUNS)
+		{
+			clearLayoutRuns();
+		}
+		runp = new layout_run_t;
+		mLayoutRuns[hash] = runp;
+	}
+
+	if (runp->mText.empty())
+	{
+		const S32 LAST_CHARACTER = LLFont::LAST_CHAR_FULL;
+
+		runp->mText.assign(wchars, length);
+		runp->mChars.resize(length);
+		runp->mHasGlyphs = FALSE;
+
+		// Metrics for every character first, so kerning sees all of their glyph indices
+		for (S32 i = 0; i < length; i++)
+		{
+			runp->mChars[i].mGlyph = NULL;
+			runp->mChars[i].mXAdvance = getXAdvance(wchars[i]);
+		}
+
+		F32 cur_x = 0;
+		for (S32 i = 0; i < length; i++)
+		{
+			runp->mChars[i].mXKerning = 0.f;
+			cur_x += runp->mChars[i].mXAdvance;
+			if (i + 1 < length)
+			{
+				llwchar next_char = wchars[i+1];
+				runp->mChars[i].mXKerning = getXKerning(wchars[i], next_char);
+				if (next_char < LAST_CHARACTER)
+				{
+					cur_x += runp->mChars[i].mXKerning;
+				}
+			}
+			// Round after kerning, as getWidthF32() does.
+			cur_x = (F32)llfloor(cur_x + 0.5f);
+		}
+		runp->mWidth = cur_x;
+		runp->mGlyphGeneration = mGlyphGeneration;
+	}
+
+	if (need_glyphs && !runp->mHasGlyphs)
+	{
+		// Rendering may replace glyph info, so look the glyphs up after adding them all.
+		for (S32 i = 0; i < length; i++)
+		{
+			if (!hasGlyph(wchars[i]))
+			{
+				addChar(wchars[i]);
+			}
+		}
+		for (S32 i = 0; i < length; i++)
+		{
+			runp->mChars[i].mGlyph = getGlyphInfo(wchars[i]);
+			if (!runp->mChars[i].mGlyph)
+			{
+				// let the caller report it
+				return NULL;
+			}
+		}
+		runp->mHasGlyphs = TRUE;
+		runp->mGlyphGeneration = mGlyphGeneration;
+	}
+
+	return runp;
+}
+
+void LLFontGL::clearLayoutRuns() const
+{
+	for_each(mLayoutRuns.begin(), mLayoutRuns.end(), DeletePairedPointer());
+	mLayoutRuns.clear();
+}
+
 void LLFontGL::renderQuad(const LLRectf& screen_rect, const LLRectf& uv_rect, F32 slant_amt) const
 {
 	gGL.texCoord2f(uv_rect.mRight, uv_rect.mTop);
@@ -222,6 +222,25 @@ protected:
 	void renderQuad(const LLRectf& screen_rect, const LLRectf& uv_rect, F32 slant_amt) const;
 	void drawGlyph(const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4& color, U8 style, F32 drop_shadow_fade) const;
 
+	// A string as laid out by this font, so that drawing or measuring the
+	// same text again skips the per-character glyph and kerning lookups.
+	struct layout_char_t
+	{
+		const LLFontGlyphInfo* mGlyph;	// NULL until the run is first rendered
+		F32 mXAdvance;
+		F32 mXKerning;					// with the next character in the run, if any
+	};
+	struct layout_run_t
+	{
+		LLWString mText;
+		std::vector<layout_char_t> mChars;
+		F32 mWidth;						// same as getWidthF32() on mText, before unscaling
+		BOOL mHasGlyphs;
+		U32 mGlyphGeneration;			// LLFont::mGlyphGeneration when built
+	};
+	const layout_run_t* getLayoutRun(const llwchar* wchars, S32 max_chars, BOOL use_embedded, BOOL need_glyphs) const;
+	void clearLayoutRuns() const;
+
 public:
 	static F32 sVertDPI;
 	static F32 sHorizDPI;
@@ -251,6 +270,9 @@ protected:
 protected:
 	typedef std::map<llwchar,embedded_data_t*> embedded_map_t;
 	mutable embedded_map_t mEmbeddedChars;
+
+	typedef std::map<U32, layout_run_t*> layout_run_map_t;
+	mutable layout_run_map_t mLayoutRuns;	// keyed by string hash
 	
 	LLFontDescriptor mFontDesc;
 
@@ -276,6 +276,7 @@ LLGLManager::LLGLManager() :
 	mNumTextureUnits(1),
 	mHasMipMapGeneration(FALSE),
 	mHasCompressedTextures(FALSE),
+	mHasS3TC(FALSE),
 	mHasFramebufferObject(FALSE),
 	mHasFramebufferMultisample(FALSE),
 
@@ -565,6 +566,11 @@ void LLGLManager::initExtensions()
 # else
 	mHasCompressedTextures = FALSE;
 # endif
+# ifdef GL_EXT_texture_compression_s3tc
+	mHasS3TC = TRUE;
+# else
+	mHasS3TC = FALSE;
+# endif
 # ifdef GL_ARB_vertex_buffer_object
 	mHasVertexBufferObject = TRUE;
 # else
@@ -608,6 +614,7 @@ void LLGLManager::initExtensions()
 	mHasCubeMap = ExtensionExists("GL_ARB_texture_cube_map", gGLHExts.mSysExts);
 	mHasARBEnvCombine = ExtensionExists("GL_ARB_texture_env_combine", gGLHExts.mSysExts);
 	mHasCompressedTextures = glh_init_extensions("GL_ARB_texture_compression");
+	mHasS3TC = ExtensionExists("GL_EXT_texture_compression_s3tc", gGLHExts.mSysExts);
 	mHasOcclusionQuery = ExtensionExists("GL_ARB_occlusion_query", gGLHExts.mSysExts);
 	mHasVertexBufferObject = ExtensionExists("GL_ARB_vertex_buffer_object", gGLHExts.mSysExts);
 	// mask out FBO support when packed_depth_stencil isn't there 'cause we need it for LLRenderTarget -Brad
@@ -634,6 +641,7 @@ void LLGLManager::initExtensions()
 		//mHasMultitexture = FALSE; // NEEDED!
 		mHasARBEnvCombine = FALSE;
 		mHasCompressedTextures = FALSE;
+		mHasS3TC = FALSE;
 		mHasVertexBufferObject = FALSE;
 		mHasFramebufferObject = FALSE;
 		mHasFramebufferMultisample = FALSE;
@@ -674,6 +682,7 @@ void LLGLManager::initExtensions()
 		LL_WARNS("RenderInit") << "GL extension support partially disabled via LL_GL_BLACKLIST: " << blacklist << LL_ENDL;
 		if (strchr(blacklist,'a')) mHasARBEnvCombine = FALSE;
 		if (strchr(blacklist,'b')) mHasCompressedTextures = FALSE;
+		if (strchr(blacklist,'u')) mHasS3TC = FALSE;
 		if (strchr(blacklist,'c')) mHasVertexBufferObject = FALSE;
 		if (strchr(blacklist,'d')) mHasMipMapGeneration = FALSE;//S
 // 		if (strchr(blacklist,'f')) mHasNVVertexArrayRange = FALSE;//S
@@ -719,6 +728,10 @@ void LLGLManager::initExtensions()
 	{
 		LL_INFOS("RenderInit") << "Couldn't initialize GL_ARB_texture_compression" << LL_ENDL;
 	}
+	if (!mHasS3TC)
+	{
+		LL_INFOS("RenderInit") << "Couldn't initialize GL_EXT_texture_compression_s3tc" << LL_ENDL;
+	}
 	if (!mHasOcclusionQuery)
 	{
 		LL_INFOS("RenderInit") << "Couldn't initialize GL_ARB_occlusion_query" << LL_ENDL;
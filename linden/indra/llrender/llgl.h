@@ -76,6 +76,7 @@ public:
 	S32	 mNumTextureUnits;
 	BOOL mHasMipMapGeneration;
 	BOOL mHasCompressedTextures;
+	BOOL mHasS3TC;
 	BOOL mHasFramebufferObject;
 	BOOL mHasFramebufferMultisample;
 	
@@ -271,7 +271,8 @@ void LLImageGL::destroyGL(BOOL save_state)
 		LLImageGL* glimage = *iter;
 		if (glimage->mTexName)
 		{
-			if (save_state && glimage->isGLTextureCreated() && glimage->mComponents)
+			// Compressed textures can't be restored from a raw readback; their owners reload them
+			if (save_state && glimage->isGLTextureCreated() && glimage->mComponents && !glimage->isCompressed())
 			{
 				glimage->mSaveData = new LLImageRaw;
 				if(!glimage->readBackRaw(glimage->mCurrentDiscardLevel, glimage->mSaveData, false)) //necessary, keep it.
@@ -1423,6 +1424,11 @@ S32 LLImageGL::getBytes(S32 discard_level) const
 	return dataFormatBytes(mFormatPrimary, w, h);
 }
 
+BOOL LLImageGL::isCompressed() const
+{
+	return mFormatPrimary >= GL_COMPRESSED_RGBA_S3TC_DXT1_EXT && mFormatPrimary <= GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+}
+
 S32 LLImageGL::getMipBytes(S32 discard_level) const
 {
 	if (discard_level < 0)
@@ -116,6 +116,8 @@ public:
 	void destroyGLTexture();
 
 	void setExplicitFormat(LLGLint internal_format, LLGLenum primary_format, LLGLenum type_format = 0, BOOL swap_bytes = FALSE);
+	// Next createGLTexture() from raw data picks the format from the component count again
+	void clearExplicitFormat() { mHasExplicitFormat = FALSE; }
 	void dontDiscard() { mDontDiscard = 1; mTextureState = NO_DELETE; }
 	void setComponents(S8 ncomponents) { mComponents = ncomponents; }
 
@@ -132,6 +134,7 @@ public:
 	BOOL getBoundRecently() const;
 	BOOL isJustBound() const;
 	LLGLenum getPrimaryFormat() const { return mFormatPrimary; }
+	BOOL isCompressed() const;
 
 	BOOL getHasGLTexture() const { return mTexName != 0; }
 	LLGLuint getTexName() const { return mTexName; }
@@ -75,8 +75,19 @@ inline BOOL LLKeywordToken::isTail(const llwchar* s) const
 	return res;
 }
 
-LLKeywords::LLKeywords() : mLoaded(FALSE)
+LLKeywords::LLKeywords() :
+	mLoaded(FALSE),
+	mWideTokenHeads(FALSE),
+	mLastSegList(NULL),
+	mIncrementalSafe(TRUE),
+	mLastRelexLength(0)
 {
+	for (S32 i = 0; i < TRIE_ROOT_SIZE; i++)
+	{
+		mWordTrieRoot[i] = -1;
+		mLineTokenHeads[i] = 0;
+		mDelimiterHeads[i] = 0;
+	}
 }
 
 LLKeywords::~LLKeywords()
@@ -237,20 +248,49 @@ void LLKeywords::addToken(LLKeywordToken::TOKEN_TYPE type,
 	LLWString key = utf8str_to_wstring(key_in);
 	LLWString tool_tip = utf8str_to_wstring(tool_tip_in);
 	LLWString delimiter = utf8str_to_wstring(delimiter_in);
+	if (key.empty())
+	{
+		return;
+	}
+
+	// The incremental path assumes a newline outside a token always ends it.
+	if (key.find('\n') != LLWString::npos || delimiter.find('\n') != LLWString::npos)
+	{
+		mIncrementalSafe = FALSE;
+	}
+	resetLastText();
+
 	switch(type)
 	{
 	case LLKeywordToken::WORD:
 		mWordTokenMap[key] = new LLKeywordToken(type, color, key, tool_tip, delimiter);
+		addWordToTrie(key, mWordTokenMap[key]);
 		break;
 
 	case LLKeywordToken::LINE:
 		mLineTokenList.push_front(new LLKeywordToken(type, color, key, tool_tip, delimiter));
+		if (key[0] < (llwchar)TRIE_ROOT_SIZE)
+		{
+			mLineTokenHeads[key[0]] = 1;
+		}
+		else
+		{
+			mWideTokenHeads = TRUE;
+		}
 		break;
 
 	case LLKeywordToken::TWO_SIDED_DELIMITER:
 	case LLKeywordToken::ONE_SIDED_DELIMITER:
 	case LLKeywordToken::TWO_SIDED_DELIMITER_ESC:
 		mDelimiterTokenList.push_front(new LLKeywordToken(type, color, key, tool_tip, delimiter));
+		if (key[0] < (llwchar)TRIE_ROOT_SIZE)
+		{
+			mDelimiterHeads[key[0]] = 1;
+		}
+		else
+		{
+			mWideTokenHeads = TRUE;
+		}
  		break;
 
 	default:
@@ -258,6 +298,64 @@ void LLKeywords::addToken(LLKeywordToken::TOKEN_TYPE type,
 	}
 }
 
+void LLKeywords::addWordToTrie(const LLWString& key, LLKeywordToken* token)
+{
+	if (key[0] >= (llwchar)TRIE_ROOT_SIZE)
+	{
+		// The lexer only looks up ASCII-led identifiers, so such a key can't match anyway.
+		return;
+	}
+
+	S32 node = mWordTrieRoot[key[0]];
+	if (node < 0)
+	{
+		TrieNode root_child = { -1, -1, key[0], NULL };
+		node = mWordTrie.size();
+		mWordTrie.push_back(root_child);
+		mWordTrieRoot[key[0]] = node;
+	}
+
+	for (S32 i = 1; i < (S32)key.size(); i++)
+	{
+		S32 child = findTrieChild(node, key[i]);
+		if (child < 0)
+		{
+			TrieNode new_node = { -1, mWordTrie[node].mFirstChild, key[i], NULL };
+			child = mWordTrie.size();
+			mWordTrie.push_back(new_node);
+			mWordTrie[node].mFirstChild = child;
+		}
+		node = child;
+	}
+	mWordTrie[node].mToken = token;
+}
+
+S32 LLKeywords::findTrieChild(S32 node, llwchar c) const
+{
+	S32 child = mWordTrie[node].mFirstChild;
+	while (child >= 0 && mWordTrie[child].mChar != c)
+	{
+		child = mWordTrie[child].mNextSibling;
+	}
+	return child;
+}
+
+BOOL LLKeywords::mayStartDelimiter(llwchar c) const
+{
+	return c < (llwchar)TRIE_ROOT_SIZE ? mDelimiterHeads[c] : mWideTokenHeads;
+}
+
+BOOL LLKeywords::mayStartLineToken(llwchar c) const
+{
+	return c < (llwchar)TRIE_ROOT_SIZE ? mLineTokenHeads[c] : mWideTokenHeads;
+}
+
+void LLKeywords::resetLastText()
+{
+	mLastText.clear();
+	mLastSegList = NULL;
+}
+
 LLColor3 LLKeywords::readColor( const std::string& s )
 {
 	F32 r, g, b;
@@ -277,26 +375,244 @@ void LLKeywords::findSegments(std::vector<LLTextSegment *>* seg_list, const LLWS
 	std::for_each(seg_list->begin(), seg_list->end(), DeletePointer());
 	seg_list->clear();
 
+	mLastText = wtext;
+	mLastSegList = seg_list;
+	mLastDefaultColor = defaultColor;
+	mLastRelexLength = wtext.size();
+
 	if( wtext.empty() )
 	{
 		return;
 	}
-	
-	S32 text_len = wtext.size();
 
-	seg_list->push_back( new LLTextSegment( LLColor3(defaultColor), 0, text_len ) ); 
+	span_list_t spans;
+	S32 text_len = lexSpans(wtext, 0, spans, NULL);
+
+	S32 pos = 0;
+	for (span_list_t::const_iterator iter = spans.begin(); iter != spans.end(); ++iter)
+	{
+		appendDefaultSegment(seg_list, pos, iter->mStart, defaultColor);
+		LLTextSegment* text_segment = new LLTextSegment( iter->mToken->getColor(), iter->mStart, iter->mEnd );
+		text_segment->setToken( iter->mToken );
+		seg_list->push_back( text_segment );
+		pos = iter->mEnd;
+	}
+	appendDefaultSegment(seg_list, pos, text_len, defaultColor);
+}
+
+void LLKeywords::updateSegments(std::vector<LLTextSegment *>* seg_list, const LLWString& wtext, const LLColor4 &defaultColor)
+{
+	std::vector<LLTextSegment *>& old_segs = *seg_list;
+	const S32 old_len = mLastText.size();
+	const S32 new_len = wtext.size();
+
+	// Only trust seg_list if it is exactly what we produced for mLastText.
+	if( !mIncrementalSafe
+		|| seg_list != mLastSegList
+		|| defaultColor != mLastDefaultColor
+		|| old_len == 0
+		|| new_len == 0
+		|| old_segs.empty()
+		|| old_segs.front()->getStart() != 0
+		|| old_segs.back()->getEnd() != old_len )
+	{
+		findSegments(seg_list, wtext, defaultColor);
+		return;
+	}
+
+	const llwchar* old_text = mLastText.c_str();
+	const llwchar* new_text = wtext.c_str();
+	const S32 min_len = llmin(old_len, new_len);
 
+	S32 prefix = 0;
+	while( prefix < min_len && old_text[prefix] == new_text[prefix] )
+	{
+		prefix++;
+	}
+	if( prefix == old_len && old_len == new_len )
+	{
+		mLastRelexLength = 0;
+		return;
+	}
+	S32 suffix = 0;
+	while( suffix < min_len - prefix
+		   && old_text[old_len - 1 - suffix] == new_text[new_len - 1 - suffix] )
+	{
+		suffix++;
+	}
+	const S32 delta = new_len - old_len;
+
+	// Back up to a line start whose preceding newline was lexed outside any token,
+	// so the lexer state there doesn't depend on anything before it.
+	S32 restart = prefix;
+	while( TRUE )
+	{
+		while( restart > 0 && old_text[restart - 1] != '\n' )
+		{
+			restart--;
+		}
+		if( restart == 0 )
+		{
+			break;
+		}
+		const LLTextSegment* seg = old_segs[findSegmentIndex(old_segs, restart - 1)];
+		if( !seg->getToken() )
+		{
+			break;
+		}
+		restart = seg->getStart();
+	}
+
+	span_list_t spans;
+	Resync resync;
+	resync.mOldSegments = seg_list;
+	resync.mDamageEnd = new_len - suffix;
+	resync.mDelta = delta;
+	const S32 stop = lexSpans(wtext, restart, spans, &resync);
+	const S32 old_stop = stop - delta;
+
+	// Splice: old segments before restart, fresh segments for [restart, stop),
+	// then the old segments from old_stop on, shifted by delta.
+	std::vector<LLTextSegment *> segs;
+	segs.reserve(old_segs.size() + 2 * spans.size() + 2);
+
+	const S32 count = old_segs.size();
+	S32 i = 0;
+	while( i < count && old_segs[i]->getEnd() <= restart )
+	{
+		segs.push_back(old_segs[i++]);
+	}
+	S32 j = i;
+	while( j < count && old_segs[j]->getEnd() <= old_stop )
+	{
+		j++;
+	}
+
+	// A segment straddling restart or old_stop is always default text.
+	if( i < count && old_segs[i]->getStart() < restart )
+	{
+		if( i == j )
+		{
+			// The same default segment also straddles old_stop and is reused below.
+			segs.push_back(new LLTextSegment(defaultColor, old_segs[i]->getStart(), restart));
+		}
+		else
+		{
+			old_segs[i]->setEnd(restart);
+			segs.push_back(old_segs[i++]);
+		}
+	}
+	for (S32 k = i; k < j; k++)
+	{
+		delete old_segs[k];
+	}
+
+	S32 pos = restart;
+	for (span_list_t::const_iterator iter = spans.begin(); iter != spans.end(); ++iter)
+	{
+		appendDefaultSegment(&segs, pos, iter->mStart, defaultColor);
+		LLTextSegment* text_segment = new LLTextSegment( iter->mToken->getColor(), iter->mStart, iter->mEnd );
+		text_segment->setToken( iter->mToken );
+		segs.push_back( text_segment );
+		pos = iter->mEnd;
+	}
+	appendDefaultSegment(&segs, pos, stop, defaultColor);
+
+	for (S32 k = j; k < count; k++)
+	{
+		LLTextSegment* seg = old_segs[k];
+		seg->setStart(llmax(seg->getStart(), old_stop) + delta);
+		seg->setEnd(seg->getEnd() + delta);
+
+		LLTextSegment* last = segs.empty() ? NULL : segs.back();
+		if( !seg->getToken() && last && !last->getToken() && last->getEnd() == seg->getStart() )
+		{
+			last->setEnd(seg->getEnd());
+			delete seg;
+		}
+		else
+		{
+			segs.push_back(seg);
+		}
+	}
+
+	old_segs.swap(segs);
+	mLastText = wtext;
+	mLastRelexLength = stop - restart;
+}
+
+// Appends default-colored text for [start, end), extending a default segment that
+// already ends at start so the tiling matches what a full pass produces.
+void LLKeywords::appendDefaultSegment(std::vector<LLTextSegment *>* seg_list, S32 start, S32 end, const LLColor4 &defaultColor)
+{
+	if( start >= end )
+	{
+		return;
+	}
+	LLTextSegment* last = seg_list->empty() ? NULL : seg_list->back();
+	if( last && !last->getToken() && last->getEnd() == start )
+	{
+		last->setEnd(end);
+	}
+	else
+	{
+		seg_list->push_back( new LLTextSegment( defaultColor, start, end ) );
+	}
+}
+
+// static
+S32 LLKeywords::findSegmentIndex(const std::vector<LLTextSegment *>& seg_list, S32 pos)
+{
+	S32 lo = 0;
+	S32 hi = (S32)seg_list.size() - 1;
+	while( lo < hi )
+	{
+		S32 mid = (lo + hi + 1) / 2;
+		if( seg_list[mid]->getStart() <= pos )
+		{
+			lo = mid;
+		}
+		else
+		{
+			hi = mid - 1;
+		}
+	}
+	return lo;
+}
+
+// The re-lex may stop at a line start in the unchanged tail once the old pass also
+// crossed the corresponding newline outside of any token.
+BOOL LLKeywords::canResync(const Resync& resync, S32 pos) const
+{
+	if( pos - 1 < resync.mDamageEnd )
+	{
+		return FALSE;
+	}
+	const std::vector<LLTextSegment *>& old_segs = *resync.mOldSegments;
+	const LLTextSegment* seg = old_segs[findSegmentIndex(old_segs, pos - 1 - resync.mDelta)];
+	return seg->getToken() == NULL;
+}
+
+// Lexes wtext from start, which must be the beginning of a line, appending a span for
+// each token found.  Returns the position lexing stopped at: the end of the text, or
+// with resync set, the first line start at which the old segments can take over.
+S32 LLKeywords::lexSpans(const LLWString& wtext, S32 start, span_list_t& spans, const Resync* resync) const
+{
 	const llwchar* base = wtext.c_str();
-	const llwchar* cur = base;
-	const llwchar* line = NULL;
+	const llwchar* first = base + start;
+	const llwchar* cur = first;
 
 	while( *cur )
 	{
-		if( *cur == '\n' || cur == base )
+		if( *cur == '\n' || cur == first )
 		{
 			if( *cur == '\n' )
 			{
 				cur++;
+				if( resync && canResync( *resync, cur - base ) )
+				{
+					return cur - base;
+				}
 				if( !*cur || *cur == '\n' )
 				{
 					continue;
@@ -304,7 +620,6 @@ void LLKeywords::findSegments(std::vector<LLTextSegment *>* seg_list, const LLWS
 			}
 
 			// Start of a new line
-			line = cur;
 
 			// Skip white space
 			while( *cur && isspace(*cur) && (*cur != '\n')  )
@@ -319,9 +634,10 @@ void LLKeywords::findSegments(std::vector<LLTextSegment *>* seg_list, const LLWS
 			// cur is now at the first non-whitespace character of a new line	
 		
 			// Line start tokens
+			if( mayStartLineToken( *cur ) )
 			{
 				BOOL line_done = FALSE;
-				for (token_list_t::iterator iter = mLineTokenList.begin();
+				for (token_list_t::const_iterator iter = mLineTokenList.begin();
 					 iter != mLineTokenList.end(); ++iter)
 				{
 					LLKeywordToken* cur_token = *iter;
@@ -334,10 +650,8 @@ void LLKeywords::findSegments(std::vector<LLTextSegment *>* seg_list, const LLWS
 							cur++;
 						}
 						S32 seg_end = cur - base;
-						
-						LLTextSegment* text_segment = new LLTextSegment( cur_token->getColor(), seg_start, seg_end );
-						text_segment->setToken( cur_token );
-						insertSegment( seg_list, text_segment, text_len, defaultColor);
+						Span span = { seg_start, seg_end, cur_token };
+						spans.push_back( span );
 						line_done = TRUE; // to break out of second loop.
 						break;
 					}
@@ -359,10 +673,11 @@ void LLKeywords::findSegments(std::vector<LLTextSegment *>* seg_list, const LLWS
 		while( *cur && *cur != '\n' )
 		{
 			// Check against delimiters
+			if( mayStartDelimiter( *cur ) )
 			{
 				S32 seg_start = 0;
 				LLKeywordToken* cur_delimiter = NULL;
-				for (token_list_t::iterator iter = mDelimiterTokenList.begin();
+				for (token_list_t::const_iterator iter = mDelimiterTokenList.begin();
 					 iter != mDelimiterTokenList.end(); ++iter)
 				{
 					LLKeywordToken* delimiter = *iter;
@@ -479,9 +794,8 @@ void LLKeywords::findSegments(std::vector<LLTextSegment *>* seg_list, const LLWS
 						seg_end = seg_start + between_delimiters + cur_delimiter->getLength();
 					}
 
-					LLTextSegment* text_segment = new LLTextSegment( cur_delimiter->getColor(), seg_start, seg_end );
-					text_segment->setToken( cur_delimiter );
-					insertSegment( seg_list, text_segment, text_len, defaultColor);
+					Span span = { seg_start, seg_end, cur_delimiter };
+					spans.push_back( span );
 
 					// Note: we don't increment cur, since the end of one delimited seg may be immediately
 					// followed by the start of another one.
@@ -493,28 +807,25 @@ void LLKeywords::findSegments(std::vector<LLTextSegment *>* seg_list, const LLWS
 			llwchar prev = cur > base ? *(cur-1) : 0;
 			if( !isalnum( prev ) && (prev != '_') )
 			{
+				// Walk the trie while scanning the identifier; no string is built.
 				const llwchar* p = cur;
+				S32 node = (*p < (llwchar)TRIE_ROOT_SIZE) ? mWordTrieRoot[*p] : -1;
 				while( isalnum( *p ) || (*p == '_') )
 				{
 					p++;
+					if( node >= 0 && (isalnum( *p ) || (*p == '_')) )
+					{
+						node = findTrieChild( node, *p );
+					}
 				}
 				S32 seg_len = p - cur;
 				if( seg_len > 0 )
 				{
-					LLWString word( cur, 0, seg_len );
-					word_token_map_t::iterator map_iter = mWordTokenMap.find(word);
-					if( map_iter != mWordTokenMap.end() )
+					if( node >= 0 && mWordTrie[node].mToken )
 					{
-						LLKeywordToken* cur_token = map_iter->second;
 						S32 seg_start = cur - base;
-						S32 seg_end = seg_start + seg_len;
-
-						// llinfos << "Seg: [" << word.c_str() << "]" << llendl;
-
-
-						LLTextSegment* text_segment = new LLTextSegment( cur_token->getColor(), seg_start, seg_end );
-						text_segment->setToken( cur_token );
-						insertSegment( seg_list, text_segment, text_len, defaultColor);
+						Span span = { seg_start, seg_start + seg_len, mWordTrie[node].mToken };
+						spans.push_back( span );
 					}
 					cur += seg_len; 
 					continue;
@@ -527,28 +838,7 @@ void LLKeywords::findSegments(std::vector<LLTextSegment *>* seg_list, const LLWS
 			}
 		}
 	}
-}
-
-void LLKeywords::insertSegment(std::vector<LLTextSegment*>* seg_list, LLTextSegment* new_segment, S32 text_len, const LLColor4 &defaultColor )
-{
-	LLTextSegment* last = seg_list->back();
-	S32 new_seg_end = new_segment->getEnd();
-
-	if( new_segment->getStart() == last->getStart() )
-	{
-		*last = *new_segment;
-		delete new_segment;
-	}
-	else
-	{
-		last->setEnd( new_segment->getStart() );
-		seg_list->push_back( new_segment );
-	}
-
-	if( new_seg_end < text_len )
-	{
-		seg_list->push_back( new LLTextSegment( defaultColor, new_seg_end, text_len ) );
-	}
+	return cur - base;
 }
 
 #ifdef _DEBUG
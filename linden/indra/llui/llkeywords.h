@@ -36,9 +36,11 @@
 
 #include "llstring.h"
 #include "v3color.h"
+#include "v4color.h"
 #include <map>
 #include <list>
 #include <deque>
+#include <vector>
 
 class LLTextSegment;
 
@@ -89,8 +91,17 @@ public:
 	BOOL		loadFromFile(const std::string& filename);
 	BOOL		isLoaded() const	{ return mLoaded; }
 
+	// Rebuilds seg_list from scratch.
 	void		findSegments(std::vector<LLTextSegment *> *seg_list, const LLWString& text, const LLColor4 &defaultColor );
 
+	// Like findSegments(), but when seg_list still holds the result of the previous
+	// call only the lines around the edited range are re-lexed and the remaining
+	// segments are shifted into place.
+	void		updateSegments(std::vector<LLTextSegment *> *seg_list, const LLWString& text, const LLColor4 &defaultColor );
+
+	// Number of characters re-lexed by the last findSegments()/updateSegments() call.
+	S32			getLastRelexLength() const	{ return mLastRelexLength; }
+
 	// Add the token as described
 	void addToken(LLKeywordToken::TOKEN_TYPE type,
 					const std::string& key,
@@ -108,14 +119,64 @@ public:
 #endif
 
 private:
+	struct Span
+	{
+		S32				mStart;
+		S32				mEnd;
+		LLKeywordToken*	mToken;
+	};
+	typedef std::vector<Span> span_list_t;
+
+	// Where an incremental re-lex may stop and hand over to the old segments.
+	struct Resync
+	{
+		const std::vector<LLTextSegment *>* mOldSegments;
+		S32				mDamageEnd;		// first position of the unchanged tail in the new text
+		S32				mDelta;			// new length - old length
+	};
+
+	// Word keywords are matched with a trie rather than by building an LLWString
+	// for every identifier and looking it up in mWordTokenMap.  The first level is
+	// indexed directly by character; deeper levels are first-child/next-sibling lists.
+	struct TrieNode
+	{
+		S32				mFirstChild;
+		S32				mNextSibling;
+		llwchar			mChar;
+		LLKeywordToken*	mToken;
+	};
+	enum { TRIE_ROOT_SIZE = 128 };
+
 	LLColor3	readColor(const std::string& s);
-	void		insertSegment(std::vector<LLTextSegment *> *seg_list, LLTextSegment* new_segment, S32 text_len, const LLColor4 &defaultColor);
+	void		addWordToTrie(const LLWString& key, LLKeywordToken* token);
+	S32			findTrieChild(S32 node, llwchar c) const;
+	BOOL		mayStartDelimiter(llwchar c) const;
+	BOOL		mayStartLineToken(llwchar c) const;
+	void		appendDefaultSegment(std::vector<LLTextSegment *>* seg_list, S32 start, S32 end, const LLColor4 &defaultColor);
+	static S32	findSegmentIndex(const std::vector<LLTextSegment *>& seg_list, S32 pos);
+	S32			lexSpans(const LLWString& wtext, S32 start, span_list_t& spans, const Resync* resync) const;
+	BOOL		canResync(const Resync& resync, S32 pos) const;
+	void		resetLastText();
 
 	BOOL		mLoaded;
 	word_token_map_t mWordTokenMap;
 	typedef std::deque<LLKeywordToken*> token_list_t;
 	token_list_t mLineTokenList;
 	token_list_t mDelimiterTokenList;
+
+	std::vector<TrieNode> mWordTrie;
+	S32			mWordTrieRoot[TRIE_ROOT_SIZE];
+	// First characters of line and delimiter tokens, so most characters skip the token lists.
+	U8			mLineTokenHeads[TRIE_ROOT_SIZE];
+	U8			mDelimiterHeads[TRIE_ROOT_SIZE];
+	BOOL		mWideTokenHeads;		// some line or delimiter token starts with a non-ASCII character
+
+	// Incremental highlighting state: the text and list the last call produced.
+	LLWString	mLastText;
+	LLColor4	mLastDefaultColor;
+	const std::vector<LLTextSegment *>* mLastSegList;
+	BOOL		mIncrementalSafe;		// FALSE if some token contains a line break
+	S32			mLastRelexLength;
 };
 
 #endif  // LL_LLKEYWORDS_H
@@ -76,6 +76,7 @@ void LLPanel::init()
 	mDefaultBtn = NULL;
 	setIsChrome(FALSE); //is this a decorator to a live window or a form?
 	mLastTabGroup = 0;
+	mRecursiveLookupGeneration = getChildListGeneration() - 1;
 
 	mPanelHandle.bind(this);
 	setTabStop(FALSE);
@@ -1012,7 +1013,29 @@ void LLPanel::childSetControlName(const std::string& id, const std::string& cont
 LLView* LLPanel::getChildView(const std::string& name, BOOL recurse, BOOL create_if_missing) const
 {
 	// just get child, don't try to create a dummy one
-	LLView* view = LLUICtrl::getChildView(name, recurse, FALSE);
+	LLView* view = NULL;
+	if (recurse && LLView::sUseChildNameIndex)
+	{
+		if (mRecursiveLookupGeneration != getChildListGeneration())
+		{
+			mRecursiveLookupCache.clear();
+			mRecursiveLookupGeneration = getChildListGeneration();
+		}
+		child_lookup_cache_t::iterator found = mRecursiveLookupCache.find(name);
+		if (found != mRecursiveLookupCache.end())
+		{
+			view = found->second;
+		}
+		else
+		{
+			view = LLUICtrl::getChildView(name, recurse, FALSE);
+			mRecursiveLookupCache[name] = view;
+		}
+	}
+	else
+	{
+		view = LLUICtrl::getChildView(name, recurse, FALSE);
+	}
 	if (!view && !recurse)
 	{
 		childNotFound(name);
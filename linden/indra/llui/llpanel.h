@@ -241,6 +241,13 @@ private:
 	mutable expected_members_list_t mExpectedMembers;
 	mutable expected_members_list_t mNewExpectedMembers;
 
+	// Results of recursive getChildView() calls, including misses.
+	// childSet*() refreshes look the same names up every frame; the
+	// cache is dropped whenever getChildListGeneration() moves.
+	typedef std::map<std::string, LLView*> child_lookup_cache_t;
+	mutable child_lookup_cache_t mRecursiveLookupCache;
+	mutable U32 mRecursiveLookupGeneration;
+
 	std::string		mRectControl;
 	LLColor4		mBgColorAlpha;
 	LLColor4		mBgColorOpaque;
@@ -96,6 +96,68 @@ struct SortScrollListItem
 	const sort_order_t& mSortOrders;
 };
 
+// Sort keys for every row, extracted once per sort so that comparisons
+// don't convert each cell to a string twice.
+struct SortScrollListKeys
+{
+	typedef std::vector<std::pair<S32, BOOL> > sort_order_t;
+
+	SortScrollListKeys(const sort_order_t& sort_orders, S32 num_rows)
+	:	mSortOrders(sort_orders),
+		mNumOrders((S32)sort_orders.size())
+	{
+		mKeys.reserve(num_rows * mNumOrders);
+		mHasCell.reserve(num_rows * mNumOrders);
+	}
+
+	void addRow(const LLScrollListItem* itemp)
+	{
+		for (S32 i = 0; i < mNumOrders; ++i)
+		{
+			const LLScrollListCell* cellp = itemp->getColumn(mSortOrders[i].first);
+			mHasCell.push_back(cellp != NULL);
+			mKeys.push_back(cellp ? cellp->getValue().asString() : LLStringUtil::null);
+		}
+	}
+
+	const sort_order_t& mSortOrders;
+	S32 mNumOrders;
+	std::vector<std::string> mKeys;
+	std::vector<bool> mHasCell;
+};
+
+// Same ordering as SortScrollListItem, over row indices into SortScrollListKeys
+struct SortScrollListRow
+{
+	SortScrollListRow(const SortScrollListKeys& keys)
+	:	mKeys(keys)
+	{}
+
+	bool operator()(S32 row1, S32 row2) const
+	{
+		S32 num_orders = mKeys.mNumOrders;
+		S32 sort_result = 0;
+		for (S32 i = num_orders - 1; i >= 0; --i)
+		{
+			S32 key1 = row1 * num_orders + i;
+			S32 key2 = row2 * num_orders + i;
+			S32 order = mKeys.mSortOrders[i].second ? 1 : -1; // ascending or descending sort for this column?
+			if (mKeys.mHasCell[key1] && mKeys.mHasCell[key2])
+			{
+				sort_result = order * LLStringUtil::compareDict(mKeys.mKeys[key1], mKeys.mKeys[key2]);
+				if (sort_result != 0)
+				{
+					break; // we have a sort order!
+				}
+			}
+		}
+
+		return sort_result < 0;
+	}
+
+	const SortScrollListKeys& mKeys;
+};
+
 
 //
 // LLScrollListIcon
@@ -591,6 +653,7 @@ LLScrollListCtrl::LLScrollListCtrl(const std::string& name, const LLRect& rect,
 	mCanSelect(TRUE),
 	mDisplayColumnHeaders(FALSE),
 	mColumnsDirty(FALSE),
+	mContentWidthsDirty(TRUE),
 	mMaxItemCount(INT_MAX), 
 	mMaxContentWidth(0),
 	mBackgroundVisible( TRUE ),
@@ -615,9 +678,9 @@ LLScrollListCtrl::LLScrollListCtrl(const std::string& name, const LLRect& rect,
 	mTotalStaticColumnWidth(0),
 	mTotalColumnPadding(0),
 	mSorted(TRUE),
+	mSortedItemCount(0),
 	mDirty(FALSE),
-	mOriginalSelection(-1),
-	mDrewSelected(FALSE)
+	mOriginalSelection(-1)
 {
 	if (font)
 	{
@@ -730,6 +793,7 @@ void LLScrollListCtrl::clearRows()
 	std::for_each(mItemList.begin(), mItemList.end(), DeletePointer());
 	mItemList.clear();
 	//mItemCount = 0;
+	mSortedItemCount = 0;
 
 	// Scroll the bar back up to the top.
 	mScrollbar->setDocParams(0, 0);
@@ -936,7 +1000,8 @@ BOOL LLScrollListCtrl::addItem( LLScrollListItem* item, EAddPosition pos, BOOL r
 			}	
 		case ADD_BOTTOM:
 			mItemList.push_back(item);
-			setSorted(FALSE);
+			// rows above this one are still in order and only need this one merged in
+			mSorted = FALSE;
 			break;
 	
 		default:
@@ -964,18 +1029,14 @@ BOOL LLScrollListCtrl::addItem( LLScrollListItem* item, EAddPosition pos, BOOL r
 	return not_too_big;
 }
 
-// NOTE: This is *very* expensive for large lists, especially when we are dirtying the list every frame
-//  while receiving a long list of names.
-// *TODO: Use bookkeeping to make this an incramental cost with item additions
 void LLScrollListCtrl::calcColumnWidths()
 {
-	const S32 HEADING_TEXT_PADDING = 25;
-	const S32 COLUMN_TEXT_PADDING = 10;
-
-	mMaxContentWidth = 0;
-
-	S32 max_item_width = 0;
+	updateColumnWidths();
+	updateContentWidths();
+}
 
+void LLScrollListCtrl::updateColumnWidths()
+{
 	ordered_columns_t::iterator column_itor;
 	for (column_itor = mColumnsIndexed.begin(); column_itor != mColumnsIndexed.end(); ++column_itor)
 	{
@@ -994,6 +1055,30 @@ void LLScrollListCtrl::calcColumnWidths()
 		}
 
 		column->setWidth(new_width);
+	}
+}
+
+// NOTE: This is *very* expensive for large lists, so it is only done when
+// somebody asks for the content widths rather than every time the columns
+// are dirtied while receiving a long list of names.
+void LLScrollListCtrl::updateContentWidths()
+{
+	if (!mContentWidthsDirty)
+	{
+		return;
+	}
+	mContentWidthsDirty = FALSE;
+
+	const S32 HEADING_TEXT_PADDING = 25;
+	const S32 COLUMN_TEXT_PADDING = 10;
+
+	S32 max_item_width = 0;
+
+	ordered_columns_t::iterator column_itor;
+	for (column_itor = mColumnsIndexed.begin(); column_itor != mColumnsIndexed.end(); ++column_itor)
+	{
+		LLScrollListColumn* column = *column_itor;
+		if (!column) continue;
 
 		// update max content width for this column, by looking at all items
 		column->mMaxContentWidth = column->mHeader ? mGLFont->getWidth(column->mLabel) + mColumnPadding + HEADING_TEXT_PADDING : 0;
@@ -1045,7 +1130,7 @@ void LLScrollListCtrl::updateLineHeightInsert(LLScrollListItem* itemp)
 
 void LLScrollListCtrl::updateColumns()
 {
-	calcColumnWidths();
+	updateColumnWidths();
 
 	// update column headers
 	std::vector<LLScrollListColumn*>::iterator column_ordered_it;
@@ -1229,6 +1314,7 @@ void LLScrollListCtrl::swapWithNext(S32 index)
 	LLScrollListItem *cur_itemp = mItemList[index];
 	mItemList[index] = mItemList[index + 1];
 	mItemList[index + 1] = cur_itemp;
+	mSortedItemCount = 0;
 }
 
 
@@ -1242,6 +1328,7 @@ void LLScrollListCtrl::swapWithPrevious(S32 index)
 	LLScrollListItem *cur_itemp = mItemList[index];
 	mItemList[index] = mItemList[index - 1];
 	mItemList[index - 1] = cur_itemp;
+	mSortedItemCount = 0;
 }
 
 
@@ -1260,6 +1347,10 @@ void LLScrollListCtrl::deleteSingleItem(S32 target_index)
 	}
 	delete itemp;
 	mItemList.erase(mItemList.begin() + target_index);
+	if (target_index < mSortedItemCount)
+	{
+		mSortedItemCount--;
+	}
 	dirtyColumns();
 }
 
@@ -1276,6 +1367,10 @@ void LLScrollListCtrl::deleteItems(const LLSD& sd)
 			{
 				mLastSelected = NULL;
 			}
+			if (iter - mItemList.begin() < mSortedItemCount)
+			{
+				mSortedItemCount--;
+			}
 			delete itemp;
 			iter = mItemList.erase(iter);
 		}
@@ -1296,6 +1391,10 @@ void LLScrollListCtrl::deleteSelectedItems()
 		LLScrollListItem* itemp = *iter;
 		if (itemp->getSelected())
 		{
+			if (iter - mItemList.begin() < mSortedItemCount)
+			{
+				mSortedItemCount--;
+			}
 			delete itemp;
 			iter = mItemList.erase(iter);
 		}
@@ -1752,10 +1851,10 @@ void LLScrollListCtrl::drawItems()
 		LLLocalClipRect clip(mItemListRect);
 
 		S32 cur_y = y;
-		
-		mDrewSelected = FALSE;
 
-		S32 line = 0;
+		// only rows in view are visited, so drawing a long list costs no more than a short one
+		S32 line = llclamp(mScrollLines, 0, (S32)mItemList.size());
+		S32 end_line = mScrollLines + num_page_lines;
 		S32 max_columns = 0;
 
 		LLColor4 highlight_color = LLColor4::white;
@@ -1763,7 +1862,7 @@ void LLScrollListCtrl::drawItems()
 		highlight_color.mV[VALPHA] = clamp_rescale(mSearchTimer.getElapsedTimeF32(), type_ahead_timeout * 0.7f, type_ahead_timeout, 0.4f, 0.f);
 
 		item_list::iterator iter;
-		for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
+		for (iter = mItemList.begin() + line; iter != mItemList.end() && line < end_line; iter++)
 		{
 			LLScrollListItem* item = *iter;
 			
@@ -1775,45 +1874,37 @@ void LLScrollListCtrl::drawItems()
 
 			//llinfos << item_rect.getWidth() << llendl;
 
-			if (item->getSelected())
-			{
-				mDrewSelected = TRUE;
-			}
-
 			max_columns = llmax(max_columns, item->getNumColumns());
 
 			LLColor4 fg_color;
 			LLColor4 bg_color(LLColor4::transparent);
 
-			if( mScrollLines <= line && line < mScrollLines + num_page_lines )
+			fg_color = (item->getEnabled() ? mFgUnselectedColor : mFgDisabledColor);
+			if( item->getSelected() && mCanSelect)
 			{
-				fg_color = (item->getEnabled() ? mFgUnselectedColor : mFgDisabledColor);
-				if( item->getSelected() && mCanSelect)
-				{
-					bg_color = mBgSelectedColor;
-					fg_color = (item->getEnabled() ? mFgSelectedColor : mFgDisabledColor);
-				}
-				else if (mHighlightedItem == line && mCanSelect)
-				{
-					bg_color = mHighlightedColor;
-				}
-				else 
+				bg_color = mBgSelectedColor;
+				fg_color = (item->getEnabled() ? mFgSelectedColor : mFgDisabledColor);
+			}
+			else if (mHighlightedItem == line && mCanSelect)
+			{
+				bg_color = mHighlightedColor;
+			}
+			else 
+			{
+				if (mDrawStripes && (line % 2 == 0) && (max_columns > 1))
 				{
-					if (mDrawStripes && (line % 2 == 0) && (max_columns > 1))
-					{
-						bg_color = mBgStripeColor;
-					}
+					bg_color = mBgStripeColor;
 				}
+			}
 
-				if (!item->getEnabled())
-				{
-					bg_color = mBgReadOnlyColor;
-				}
+			if (!item->getEnabled())
+			{
+				bg_color = mBgReadOnlyColor;
+			}
 
-				item->draw(item_rect, fg_color, bg_color, highlight_color, mColumnPadding);
+			item->draw(item_rect, fg_color, bg_color, highlight_color, mColumnPadding);
 
-				cur_y -= mLineHeight;
-			}
+			cur_y -= mLineHeight;
 			line++;
 		}
 	}
@@ -1827,7 +1918,7 @@ void LLScrollListCtrl::draw()
 	// if user specifies sort, make sure it is maintained
 	if (needsSorting() && !isSorted())
 	{
-		sortItems();
+		sortNewItems();
 	}
 
 	if (mNeedsScroll)
@@ -2615,6 +2706,7 @@ BOOL LLScrollListCtrl::setSort(S32 column_idx, BOOL ascending)
 	if (mSortColumns.empty())
 	{
 		mSortColumns.push_back(new_sort_column);
+		mSortedItemCount = 0;
 		return TRUE;
 	}
 	else
@@ -2628,7 +2720,12 @@ BOOL LLScrollListCtrl::setSort(S32 column_idx, BOOL ascending)
 		mSortColumns.push_back(new_sort_column);
 
 		// did the sort criteria change?
-		return (cur_sort_column != new_sort_column);
+		if (cur_sort_column != new_sort_column)
+		{
+			mSortedItemCount = 0;
+			return TRUE;
+		}
+		return FALSE;
 	}
 }
 
@@ -2661,12 +2758,47 @@ void  LLScrollListCtrl::sortByColumnIndex(U32 column, BOOL ascending)
 
 void LLScrollListCtrl::sortItems()
 {
-	// do stable sort to preserve any previous sorts
-	std::stable_sort(
-		mItemList.begin(), 
-		mItemList.end(), 
-		SortScrollListItem(mSortColumns));
+	// rows may have been edited in place, so sort all of them
+	mSortedItemCount = 0;
+	sortNewItems();
+}
+
+void LLScrollListCtrl::sortNewItems()
+{
+	S32 num_items = (S32)mItemList.size();
+	S32 sorted_count = llclamp(mSortedItemCount, 0, num_items);
+
+	SortScrollListKeys keys(mSortColumns, num_items);
+	std::vector<S32> order(num_items);
+	for (S32 i = 0; i < num_items; ++i)
+	{
+		keys.addRow(mItemList[i]);
+		order[i] = i;
+	}
+
+	// do stable sort to preserve any previous sorts. Rows before sorted_count
+	// are still in order from the last sort, so only the rows added since then
+	// are sorted and then merged in, which gives the same result.
+	SortScrollListRow compare(keys);
+	std::stable_sort(order.begin() + sorted_count, order.end(), compare);
+	std::inplace_merge(order.begin(), order.begin() + sorted_count, order.end(), compare);
+
+	S32 first_moved = 0;
+	while (first_moved < num_items && order[first_moved] == first_moved)
+	{
+		first_moved++;
+	}
+	if (first_moved < num_items)
+	{
+		item_list sorted_list;
+		for (S32 i = 0; i < num_items; ++i)
+		{
+			sorted_list.push_back(mItemList[order[i]]);
+		}
+		mItemList.swap(sorted_list);
+	}
 
+	mSortedItemCount = num_items;
 	setSorted(TRUE);
 }
 
@@ -2681,11 +2813,13 @@ void LLScrollListCtrl::sortOnce(S32 column, BOOL ascending)
 		mItemList.begin(), 
 		mItemList.end(), 
 		SortScrollListItem(sort_column));
+	mSortedItemCount = 0;
 }
 
 void LLScrollListCtrl::dirtyColumns() 
 { 
 	mColumnsDirty = TRUE; 
+	mContentWidthsDirty = TRUE;
 
 	// need to keep mColumnsIndexed up to date
 	// just in case someone indexes into it immediately
@@ -3261,6 +3395,7 @@ void LLScrollListCtrl::clearColumns()
 	}
 	mColumns.clear();
 	mSortColumns.clear();
+	mSortedItemCount = 0;
 	mTotalStaticColumnWidth = 0;
 	mTotalColumnPadding = 0;
 }
@@ -3656,6 +3791,7 @@ BOOL LLColumnHeader::handleDoubleClick(S32 x, S32 y, MASK mask)
 	if (canResize() && mResizeBar->getRect().pointInRect(x, y))
 	{
 		// reshape column to max content width
+		mColumn->mParentCtrl->updateContentWidths();
 		LLRect column_rect = getRect();
 		column_rect.mRight = column_rect.mLeft + mColumn->mMaxContentWidth;
 		userSetShape(column_rect);
@@ -3672,6 +3808,7 @@ BOOL LLColumnHeader::handleRightMouseDown(S32 x, S32 y, MASK mask)
 	if (canResize() && mResizeBar->getRect().pointInRect(x, y))
 	{
 		// reshape column to max content width
+		mColumn->mParentCtrl->updateContentWidths();
 		LLRect column_rect = getRect();
 		column_rect.mRight = column_rect.mLeft + mColumn->mMaxContentWidth;
 		userSetShape(column_rect);
@@ -3844,6 +3981,7 @@ LLView*	LLColumnHeader::findSnapEdge(S32& new_edge_val, const LLCoordGL& mouse_d
 
 	LLRect snap_rect = getSnapRect();
 
+	mColumn->mParentCtrl->updateContentWidths();
 	S32 snap_delta = mColumn->mMaxContentWidth - snap_rect.getWidth();
 
 	// x coord growing means column growing, so same signs mean we're going in right direction
@@ -550,6 +550,8 @@ public:
 
 	void updateColumns();
 	void calcColumnWidths();
+	// recomputes mMaxContentWidth for the list and its columns, if anything changed since last time
+	void updateContentWidths();
 	S32 getMaxContentWidth() { return mMaxContentWidth; }
 
 	void setDisplayHeading(BOOL display);
@@ -579,11 +581,13 @@ public:
 
 	S32		selectMultiple( LLDynamicArray<LLUUID> ids );
 	void			sortItems();
+	// like sortItems(), but assumes rows that were in order after the last sort still are
+	void			sortNewItems();
 	// sorts a list without affecting the permanent sort order (so further list insertions can be unsorted, for example)
 	void			sortOnce(S32 column, BOOL ascending);
 
 	// manually call this whenever editing list items in place to flag need for resorting
-	void			setSorted(BOOL sorted) { mSorted = sorted; }
+	void			setSorted(BOOL sorted) { mSorted = sorted; if (!sorted) mSortedItemCount = 0; }
 	void			dirtyColumns(); // some operation has potentially affected column layout or ordering
 
 protected:
@@ -619,6 +623,7 @@ private:
 	void			deselectItem(LLScrollListItem* itemp);
 	void			commitIfChanged();
 	BOOL			setSort(S32 column, BOOL ascending);
+	void			updateColumnWidths();
 
 
 	S32				mCurIndex;			// For get[First/Next]Data
@@ -639,6 +644,7 @@ private:
 	BOOL			mCanSelect;
 	BOOL			mDisplayColumnHeaders;
 	BOOL			mColumnsDirty;
+	BOOL			mContentWidthsDirty;
 
 	item_list		mItemList;
 
@@ -680,6 +686,7 @@ private:
 	S32				mTotalColumnPadding;
 
 	BOOL			mSorted;
+	S32				mSortedItemCount;	// leading rows of mItemList known to be in sort order
 	
 	typedef std::map<std::string, LLScrollListColumn> column_map_t;
 	column_map_t mColumns;
@@ -693,9 +700,6 @@ private:
 	typedef std::pair<S32, BOOL> sort_column_t;
 	std::vector<sort_column_t>	mSortColumns;
 
-	// HACK:  Did we draw one selected item this frame?
-	BOOL mDrewSelected;
-
 	const LLFontGL*	mGLFont;
 }; // end class LLScrollListCtrl
 
@@ -329,6 +329,14 @@ LLTextEditor::LLTextEditor(
 	mLastContextMenuX(-1),
 	mLastContextMenuY(-1),
 	mReflowNeeded(FALSE),
+	mReflowDamageStart(-1),
+	mReflowDamageEnd(0),
+	mReflowDelta(0),
+	mLayoutLength(0),
+	mLayoutWidth(-1),
+	mLayoutWordWrap(FALSE),
+	mLayoutLineNumbers(FALSE),
+	mLayoutFont(NULL),
 	mScrollNeeded(FALSE),
 	mSpellCheckable(FALSE),
 	mAllowTranslate(TRUE)
@@ -675,28 +683,188 @@ void LLTextEditor::setShadowColor( const LLColor4& color )
 
 void LLTextEditor::updateLineStartList(S32 startpos)
 {
+	if (mReflowDamageStart >= 0)
+	{
+		startpos = llmin(startpos, mReflowDamageStart);
+	}
 	updateSegments();
-	
+	layoutLines(startpos, -1, 0);
+}
+
+// Records that [pos, pos + removed) was replaced by inserted characters since the last layout.
+void LLTextEditor::noteTextChanged(S32 pos, S32 removed, S32 inserted)
+{
+	if (mReflowDamageStart < 0)
+	{
+		mReflowDamageStart = pos;
+		mReflowDamageEnd = pos + inserted;
+		mReflowDelta = inserted - removed;
+		return;
+	}
+
+	mReflowDamageStart = llmin(mReflowDamageStart, pos);
+	if (mReflowDamageEnd != S32_MAX)
+	{
+		if (mReflowDamageEnd >= pos + removed)
+		{
+			mReflowDamageEnd += inserted - removed;
+		}
+		mReflowDamageEnd = llmax(mReflowDamageEnd, pos + inserted);
+	}
+	mReflowDelta += inserted - removed;
+}
+
+// On-demand reflow.  Only the lines around what changed since the last layout are measured
+// again; once a new line break lines up with an old one past the change, the remaining old
+// lines are shifted into place.
+void LLTextEditor::reflowLines()
+{
+	S32 text_start = mReflowDamageStart;
+	S32 text_end = mReflowDamageEnd;
+	S32 delta = mReflowDelta;
+
+	if (mLineStartList.empty()
+		|| text_end == S32_MAX
+		|| mLayoutWidth != mTextRect.getWidth()
+		|| mLayoutWordWrap != mWordWrap
+		|| mLayoutLineNumbers != mShowLineNumbers
+		|| mLayoutFont != mGLFont
+		|| mLayoutLength + (text_start < 0 ? 0 : delta) != getLength())
+	{
+		updateLineStartList(0);
+		return;
+	}
+	if (text_start < 0)
+	{
+		text_start = S32_MAX;
+		text_end = 0;
+		delta = 0;
+	}
+
+	updateSegments();
+
+	// Segment boundaries matter too: a segment break ends a measuring run, and highlighting
+	// may have changed beyond the edited text.  Find the first differing boundary from the
+	// front and the last one from the back (in shifted old offsets).
+	const std::vector<S32>& old_bounds = mLayoutSegmentBounds;
+	const S32 old_count = old_bounds.size();
+	const S32 new_count = mSegments.size() * 2;
+	S32 seg_start = S32_MAX;
+	S32 seg_end = -1;
+	S32 i = 0;
+	for (; i < old_count && i < new_count; ++i)
+	{
+		S32 bound = (i & 1) ? mSegments[i / 2]->getEnd() : mSegments[i / 2]->getStart();
+		if (bound != old_bounds[i])
+		{
+			seg_start = llmin(bound, old_bounds[i]);
+			break;
+		}
+	}
+	if (seg_start == S32_MAX && old_count != new_count)
+	{
+		seg_start = (i < old_count) ? old_bounds[i] : ((i & 1) ? mSegments[i / 2]->getEnd() : mSegments[i / 2]->getStart());
+	}
+	if (seg_start != S32_MAX)
+	{
+		S32 j = 1;
+		for (; j <= old_count && j <= new_count; ++j)
+		{
+			S32 k = new_count - j;
+			S32 bound = (k & 1) ? mSegments[k / 2]->getEnd() : mSegments[k / 2]->getStart();
+			if (bound != old_bounds[old_count - j] + delta)
+			{
+				seg_end = llmax(bound, old_bounds[old_count - j] + delta);
+				break;
+			}
+		}
+		if (seg_end < 0 && old_count != new_count)
+		{
+			// One list is a tail of the other; everything up to the extra boundaries differs.
+			S32 k = new_count - j;
+			seg_end = (old_count > new_count) ? old_bounds[old_count - j] + delta
+					  : (k & 1) ? mSegments[k / 2]->getEnd() : mSegments[k / 2]->getStart();
+		}
+	}
+
+	S32 startpos = llmin(text_start, seg_start);
+	if (startpos == S32_MAX)
+	{
+		// Nothing moved; just redo the last line so scrolling gets updated as usual.
+		startpos = mLineStartList.back().mStart;
+	}
+
+	// The line before the change may have been broken early because of a word that the
+	// change shortened, so start one line further back.
+	line_info t(startpos, 0);
+	line_list_t::iterator iter = std::upper_bound(mLineStartList.begin(), mLineStartList.end(), t, line_info_compare());
+	if (iter != mLineStartList.begin()) --iter;
+	if (iter != mLineStartList.begin()) --iter;
+
+	layoutLines(iter->mStart, llmax(text_end, seg_end + 1), delta);
+}
+
+// Lays out display lines from the line containing startpos.  With resync_from >= 0 the
+// lines after startpos are the previous layout shifted by delta past resync_from, and
+// layout stops at the first line start there that matches one of them.
+void LLTextEditor::layoutLines(S32 startpos, S32 resync_from, S32 delta)
+{
 	bindEmbeddedChars(mGLFont);
 
 	S32 seg_num = mSegments.size();
 	S32 seg_idx = 0;
 	S32 seg_offset = 0;
+	S32 line_num = 0;
+	S32 counted_to = 0;
+	line_list_t old_lines;
 
 	if (!mLineStartList.empty())
 	{
-		getSegmentAndOffset(startpos, &seg_idx, &seg_offset);
-		line_info t(seg_idx, seg_offset);
+		line_info t(startpos, 0);
 		line_list_t::iterator iter = std::upper_bound(mLineStartList.begin(), mLineStartList.end(), t, line_info_compare());
 		if (iter != mLineStartList.begin()) --iter;
-		seg_idx = iter->mSegment;
-		seg_offset = iter->mOffset;
+		if (iter->mStart > 0)
+		{
+			getSegmentAndOffset(iter->mStart, &seg_idx, &seg_offset);
+			line_num = iter->mLineNum;
+			counted_to = iter->mStart;
+		}
+		if (resync_from >= 0)
+		{
+			old_lines.assign(iter, mLineStartList.end());
+		}
 		mLineStartList.erase(iter, mLineStartList.end());
 	}
-	
+
+	const S32 text_len = getLength();
 	while( seg_idx < seg_num )
 	{
-		mLineStartList.push_back(line_info(seg_idx,seg_offset));
+		S32 line_start = llmin(mSegments[seg_idx]->getStart() + seg_offset, text_len);
+		for (; counted_to < line_start; ++counted_to)
+		{
+			if (mWText[counted_to] == '\n')
+			{
+				line_num++;
+			}
+		}
+
+		if (resync_from >= 0 && line_start >= resync_from)
+		{
+			line_info old_start(line_start - delta, 0);
+			line_list_t::iterator old_iter = std::lower_bound(old_lines.begin(), old_lines.end(), old_start, line_info_compare());
+			if (old_iter != old_lines.end() && old_iter->mStart == old_start.mStart)
+			{
+				// Everything from here on lays out as before.
+				S32 line_delta = line_num - old_iter->mLineNum;
+				for (; old_iter != old_lines.end(); ++old_iter)
+				{
+					mLineStartList.push_back(line_info(old_iter->mStart + delta, old_iter->mLineNum + line_delta));
+				}
+				break;
+			}
+		}
+
+		mLineStartList.push_back(line_info(line_start, line_num));
 		BOOL line_ended = FALSE;
 		S32 start_x = mShowLineNumbers ? UI_TEXTEDITOR_LINE_NUMBER_MARGIN : 0;
 		S32 line_width = start_x;
@@ -757,6 +925,21 @@ void LLTextEditor::updateLineStartList(S32 startpos)
 	
 	unbindEmbeddedChars(mGLFont);
 
+	// Remember what this layout was made from, for the next reflowLines().
+	mReflowDamageStart = -1;
+	mReflowDelta = 0;
+	mLayoutLength = text_len;
+	mLayoutWidth = mTextRect.getWidth();
+	mLayoutWordWrap = mWordWrap;
+	mLayoutLineNumbers = mShowLineNumbers;
+	mLayoutFont = mGLFont;
+	mLayoutSegmentBounds.resize(seg_num * 2);
+	for (S32 i = 0; i < seg_num; ++i)
+	{
+		mLayoutSegmentBounds[i * 2] = mSegments[i]->getStart();
+		mLayoutSegmentBounds[i * 2 + 1] = mSegments[i]->getEnd();
+	}
+
 	mScrollbar->setDocSize( getLineCount() );
 
 	if (mHideScrollbarForShortDocs)
@@ -794,6 +977,7 @@ BOOL LLTextEditor::truncate()
 			temp_utf8_text = utf8str_truncate( temp_utf8_text, mMaxTextByteLength );
 			mWText = utf8str_to_wstring( temp_utf8_text );
 			mTextIsUpToDate = FALSE;
+			needsFullReflow();
 			did_truncate = TRUE;
 		}
 	}
@@ -815,7 +999,7 @@ void LLTextEditor::setText(const LLStringExplicit &utf8str)
 	setCursorPos(0);
 	deselect();
 
-	needsReflow();
+	needsFullReflow();
 
 	resetDirty();
 }
@@ -832,7 +1016,7 @@ void LLTextEditor::setWText(const LLWString &wtext)
 	setCursorPos(0);
 	deselect();
 
-	needsReflow();
+	needsFullReflow();
 
 	resetDirty();
 }
@@ -1058,17 +1242,14 @@ S32 LLTextEditor::getLineStart( S32 line ) const
     }
 
 	line = llclamp(line, 0, num_lines-1);
-	S32 segidx = mLineStartList[line].mSegment;
-	S32 segoffset = mLineStartList[line].mOffset;
-	LLTextSegment* seg = mSegments[segidx];
-	S32 res = seg->getStart() + segoffset;
-	if (res > seg->getEnd()) 
+	S32 res = mLineStartList[line].mStart;
+	if (res > getLength()) 
 	{
 		//llerrs << "wtf" << llendl;
 		// This happens when creating a new notecard using the AO on certain opensims.
 		// Play it safe instead of bringing down the viewer - MC
-		llwarns << "BAD JOOJOO! Text length (" << res << ") greater than text end (" << seg->getEnd() << "). Setting line start to " << seg->getEnd() << llendl;
-		res = seg->getEnd();
+		llwarns << "BAD JOOJOO! Text length (" << res << ") greater than text end (" << getLength() << "). Setting line start to " << getLength() << llendl;
+		res = getLength();
 	}
 	return res;
 }
@@ -1083,15 +1264,11 @@ void LLTextEditor::getLineAndOffset( S32 startpos, S32* linep, S32* offsetp ) co
 	}
 	else
 	{
-		S32 seg_idx, seg_offset;
-		getSegmentAndOffset( startpos, &seg_idx, &seg_offset );
-
-		line_info tline(seg_idx, seg_offset);
+		line_info tline(startpos, 0);
 		line_list_t::const_iterator iter = std::upper_bound(mLineStartList.begin(), mLineStartList.end(), tline, line_info_compare());
 		if (iter != mLineStartList.begin()) --iter;
 		*linep = iter - mLineStartList.begin();
-		S32 line_start = mSegments[iter->mSegment]->getStart() + iter->mOffset;
-		*offsetp = startpos - line_start;
+		*offsetp = startpos - iter->mStart;
 	}
 }
 
@@ -3251,7 +3428,7 @@ void LLTextEditor::autoCorrectText()
 				regText.replace(wordStart, lastTypedWord.length(), correctedWord);
 				mWText = utf8str_to_wstring(regText);
 				mCursorPos += dif;
-				needsReflow();
+				needsFullReflow();
 			}
 		}
 	}
@@ -3816,7 +3993,7 @@ void LLTextEditor::draw()
 	// do on-demand reflow 
 	if (mReflowNeeded)
 	{
-		updateLineStartList();
+		reflowLines();
 		mReflowNeeded = FALSE;
 	}
 
@@ -4095,6 +4272,31 @@ void LLTextEditor::getLineAndColumnForPosition( S32 position, S32* line, S32* co
 	{
 		getLineAndOffset( mCursorPos, line, col );
 	}
+	else if (!mReflowNeeded && !mLineStartList.empty())
+	{
+		// The display lines know their logical line numbers, so only the
+		// start of the display line containing position needs scanning.
+		const LLWString &text = mWText;
+		S32 pos = llclamp(position, 0, getLength());
+		line_info tline(pos, 0);
+		line_list_t::const_iterator iter = std::upper_bound(mLineStartList.begin(), mLineStartList.end(), tline, line_info_compare());
+		if (iter != mLineStartList.begin()) --iter;
+		S32 line_count = iter->mLineNum;
+		for (S32 i = llmin(iter->mStart, pos); i < pos; i++)
+		{
+			if( '\n' == text[i] )
+			{
+				line_count++;
+			}
+		}
+		S32 line_start = pos;
+		while (line_start > 0 && text[line_start - 1] != '\n')
+		{
+			line_start--;
+		}
+		*line = line_count;
+		*col = pos - line_start;
+	}
 	else
 	{
 		const LLWString &text = mWText;
@@ -4452,8 +4654,8 @@ void LLTextEditor::removeTextFromEnd(S32 num_chars)
 
 	pruneSegments();
 	
-	// pruneSegments will invalidate mLineStartList.
-	updateLineStartList();
+	// Line starts are text offsets, so only the lines at the end get laid out again.
+	reflowLines();
 	needsScroll();
 }
 
@@ -4467,6 +4669,7 @@ S32 LLTextEditor::insertStringNoUndo(const S32 pos, const LLWString &wstr)
 
 	mWText.insert(pos, wstr);
 	mTextIsUpToDate = FALSE;
+	noteTextChanged(pos, 0, insert_len);
 
 	if ( truncate() )
 	{
@@ -4482,6 +4685,7 @@ S32 LLTextEditor::removeStringNoUndo(S32 pos, S32 length)
 {
 	mWText.erase(pos, length);
 	mTextIsUpToDate = FALSE;
+	noteTextChanged(pos, length, 0);
 	return -length;	// This will be wrong if someone calls removeStringNoUndo with an excessive length
 }
 
@@ -4493,6 +4697,7 @@ S32 LLTextEditor::overwriteCharNoUndo(S32 pos, llwchar wc)
 	}
 	mWText[pos] = wc;
 	mTextIsUpToDate = FALSE;
+	noteTextChanged(pos, 1, 1);
 	return 1;
 }
 
@@ -4603,7 +4808,7 @@ void LLTextEditor::updateSegments()
 	if (mKeywords.isLoaded())
 	{
 		// HACK:  No non-ascii keywords for now
-		mKeywords.findSegments(&mSegments, mWText, mDefaultColor);
+		mKeywords.updateSegments(&mSegments, mWText, mDefaultColor);
 	}
 	else if (mAllowEmbeddedItems)
 	{
@@ -4626,7 +4831,6 @@ void LLTextEditor::updateSegments()
 }
 
 // Only effective if text was removed from the end of the editor
-// *NOTE: Using this will invalidate references to mSegments from mLineStartList.
 void LLTextEditor::pruneSegments()
 {
 	S32 len = mWText.length();
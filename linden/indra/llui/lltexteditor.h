@@ -513,6 +513,16 @@ private:
 		// cursor might have moved, need to scroll
 		mScrollNeeded = TRUE;
 	}
+	// For changes to mWText that don't go through insertStringNoUndo() and friends.
+	void			needsFullReflow()
+	{
+		mReflowDamageStart = 0;
+		mReflowDamageEnd = S32_MAX;
+		needsReflow();
+	}
+	void			noteTextChanged(S32 pos, S32 removed, S32 inserted);
+	void			reflowLines();
+	void			layoutLines(S32 startpos, S32 resync_from, S32 delta);
 	void			needsScroll() { mScrollNeeded = TRUE; }
 
 	//
@@ -557,23 +567,20 @@ private:
 
 	S32				mDesiredXPixel;			// X pixel position where the user wants the cursor to be
 	LLRect			mTextRect;				// The rect in which text is drawn.  Excludes borders.
-	// List of offsets and segment index of the start of each line.  Always has at least one node (0).
+	// Start of each displayed line as a text offset, plus the number of newlines before it
+	// (the logical line number).  Always has at least one node (0).  Offsets rather than
+	// segment indices, so lines past an edit can be shifted instead of re-measured.
 	struct line_info
 	{
-		line_info(S32 segment, S32 offset) : mSegment(segment), mOffset(offset) {}
-		S32 mSegment;
-		S32 mOffset;
+		line_info(S32 start, S32 line_num) : mStart(start), mLineNum(line_num) {}
+		S32 mStart;
+		S32 mLineNum;
 	};
 	struct line_info_compare
 	{
 		bool operator()(const line_info& a, const line_info& b) const
 		{
-			if (a.mSegment < b.mSegment)
-				return true;
-			else if (a.mSegment > b.mSegment)
-				return false;
-			else
-				return a.mOffset < b.mOffset;
+			return a.mStart < b.mStart;
 		}
 	};
 	typedef std::vector<line_info> line_list_t;
@@ -585,6 +592,20 @@ private:
 
 	line_list_t mLineStartList;
 	BOOL			mReflowNeeded;
+
+	// Text changed since the last layout: [mReflowDamageStart, mReflowDamageEnd) in current
+	// offsets, the text past it is the old text shifted by mReflowDelta.  Start is -1 if unchanged.
+	S32				mReflowDamageStart;
+	S32				mReflowDamageEnd;
+	S32				mReflowDelta;
+
+	// What the current mLineStartList was laid out against.
+	S32				mLayoutLength;
+	S32				mLayoutWidth;
+	BOOL			mLayoutWordWrap;
+	BOOL			mLayoutLineNumbers;
+	const LLFontGL*	mLayoutFont;
+	std::vector<S32> mLayoutSegmentBounds;	// start and end of each segment
 	BOOL			mScrollNeeded;
 
 	LLFrameTimer	mKeystrokeTimer;
@@ -636,6 +657,7 @@ public:
 
 	S32					getStart() const					{ return mStart; }
 	S32					getEnd() const						{ return mEnd; }
+	void				setStart( S32 start )				{ mStart = start; }
 	void				setEnd( S32 end )					{ mEnd = end; }
 	const LLColor4&		getColor() const					{ return mStyle->getColor(); }
 	void 				setColor(const LLColor4 &color)		{ mStyle->setColor(color); }
@@ -40,6 +40,8 @@
 // other library includes
 #include "llcontrol.h"
 #include "lldir.h"
+#include "llfile.h"
+#include "lltimer.h"
 #include "v4color.h"
 
 // this library includes
@@ -78,6 +80,19 @@ const S32 MIN_WIDGET_HEIGHT = 10;
 
 std::vector<std::string> LLUICtrlFactory::sXUIPaths;
 
+LLUICtrlFactory::layout_cache_t LLUICtrlFactory::sLayoutCache;
+U32 LLUICtrlFactory::sLayoutCacheHits = 0;
+U32 LLUICtrlFactory::sLayoutCacheMisses = 0;
+F64 LLUICtrlFactory::sLayoutParseSeconds = 0.0;
+F64 LLUICtrlFactory::sLayoutCopySeconds = 0.0;
+U32 LLUICtrlFactory::sFloatersBuilt = 0;
+F64 LLUICtrlFactory::sFloaterBuildSeconds = 0.0;
+
+// "XUIC", then a version bumped whenever the entry layout changes
+const U32 LAYOUT_CACHE_MAGIC = 0x43495558;
+const U32 LAYOUT_CACHE_VERSION = 1;
+const U32 MAX_LAYOUT_CACHE_STRING = 4096;
+
 // UI Ctrl class for padding
 class LLUICtrlLocate : public LLUICtrl
 {
@@ -131,6 +146,7 @@ void LLUICtrlFactory::setupPaths()
 	LLXMLNodePtr root;
 	BOOL success  = LLXMLNode::parseFile(filename, root, NULL);
 	sXUIPaths.clear();
+	clearLayoutCache();
 	
 	if (success)
 	{
@@ -167,6 +183,67 @@ const std::vector<std::string>& LLUICtrlFactory::getXUIPaths()
 // getLayeredXMLNode()
 //-----------------------------------------------------------------------------
 bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNodePtr& root)
+{
+	LLTimer timer;
+	std::string key = getLayoutCacheKey(xui_filename);
+	layout_cache_t::iterator found = sLayoutCache.find(key);
+	if (found != sLayoutCache.end())
+	{
+		// Callers are free to modify what they get back, so hand out a
+		// copy and keep the cached tree pristine.
+		root = found->second.mRoot->deepCopy();
+		++sLayoutCacheHits;
+		sLayoutCopySeconds += timer.getElapsedTimeF64();
+		return true;
+	}
+
+	LayoutCacheEntry entry;
+	if (!parseLayeredXMLNode(xui_filename, entry.mRoot, entry.mSources))
+	{
+		root = entry.mRoot;
+		return false;
+	}
+	root = entry.mRoot->deepCopy();
+	sLayoutCache[key] = entry;
+	++sLayoutCacheMisses;
+	sLayoutParseSeconds += timer.getElapsedTimeF64();
+	return true;
+}
+
+// static
+std::string LLUICtrlFactory::getLayoutCacheKey(const std::string& xui_filename)
+{
+	std::string key = xui_filename;
+	key += '\n';
+	key += gDirUtilp->getSkinDir();
+	for (std::vector<std::string>::const_iterator it = sXUIPaths.begin();
+		 it != sXUIPaths.end(); ++it)
+	{
+		key += '\n';
+		key += *it;
+	}
+	return key;
+}
+
+// static
+bool LLUICtrlFactory::addLayoutSource(const std::string& filename, layout_source_list_t& sources)
+{
+	llstat stat_data;
+	if (LLFile::stat(filename, &stat_data))
+	{
+		return false;
+	}
+	LayoutSource source;
+	source.mFilename = filename;
+	source.mModTime = (S64)stat_data.st_mtime;
+	source.mSize = (S64)stat_data.st_size;
+	sources.push_back(source);
+	return true;
+}
+
+// static
+bool LLUICtrlFactory::parseLayeredXMLNode(const std::string &xui_filename, LLXMLNodePtr& root,
+										  layout_source_list_t& sources)
 {
 	std::string full_filename = gDirUtilp->findSkinnedFilename(sXUIPaths.front(), xui_filename);
 	if (full_filename.empty())
@@ -188,6 +265,7 @@ bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNo
 		llwarns << "Problem reading UI description file: " << full_filename << llendl;
 		return false;
 	}
+	addLayoutSource(full_filename, sources);
 
 	LLXMLNodePtr updateRoot;
 
@@ -210,6 +288,7 @@ bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNo
 			llwarns << "Problem reading localized UI description file: " << (*itor) + gDirUtilp->getDirDelimiter() + xui_filename << llendl;
 			return false;
 		}
+		addLayoutSource(layer_filename, sources);
 
 		updateRoot->getAttributeString("name", updateName);
 		root->getAttributeString("name", nodeName);
@@ -223,6 +302,172 @@ bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNo
 	return true;
 }
 
+namespace
+{
+	template <class T>
+	void write_layout_value(std::ostream& output_stream, const T& value)
+	{
+		output_stream.write((const char*)&value, sizeof(T));
+	}
+
+	void write_layout_string(std::ostream& output_stream, const std::string& value)
+	{
+		write_layout_value(output_stream, (U32)value.size());
+		output_stream.write(value.data(), value.size());
+	}
+
+	template <class T>
+	bool read_layout_value(std::istream& input_stream, T& value)
+	{
+		input_stream.read((char*)&value, sizeof(T));
+		return input_stream.good();
+	}
+
+	bool read_layout_string(std::istream& input_stream, std::string& value)
+	{
+		U32 length = 0;
+		if (!read_layout_value(input_stream, length) || length > MAX_LAYOUT_CACHE_STRING)
+		{
+			return false;
+		}
+		value.resize(length);
+		if (length)
+		{
+			input_stream.read(&value[0], length);
+		}
+		return input_stream.good();
+	}
+}
+
+// static
+void LLUICtrlFactory::clearLayoutCache()
+{
+	sLayoutCache.clear();
+}
+
+// static
+bool LLUICtrlFactory::loadLayoutCache(const std::string& filename)
+{
+	llifstream input_stream(filename, std::ios::in | std::ios::binary);
+	if (!input_stream.is_open())
+	{
+		return false;
+	}
+
+	U32 magic = 0;
+	U32 version = 0;
+	U32 count = 0;
+	if (!read_layout_value(input_stream, magic) || magic != LAYOUT_CACHE_MAGIC
+		|| !read_layout_value(input_stream, version) || version != LAYOUT_CACHE_VERSION
+		|| !read_layout_value(input_stream, count))
+	{
+		llinfos << "Ignoring stale UI layout cache " << filename << llendl;
+		return false;
+	}
+
+	U32 loaded = 0;
+	U32 stale = 0;
+	for (U32 i = 0; i < count; ++i)
+	{
+		std::string key;
+		U32 num_sources = 0;
+		if (!read_layout_string(input_stream, key)
+			|| !read_layout_value(input_stream, num_sources))
+		{
+			llwarns << "Truncated UI layout cache " << filename << llendl;
+			break;
+		}
+
+		bool valid = true;
+		LayoutCacheEntry entry;
+		for (U32 j = 0; j < num_sources && input_stream.good(); ++j)
+		{
+			LayoutSource source;
+			if (!read_layout_string(input_stream, source.mFilename)
+				|| !read_layout_value(input_stream, source.mModTime)
+				|| !read_layout_value(input_stream, source.mSize))
+			{
+				valid = false;
+				break;
+			}
+
+			// any edit to a source file invalidates the merged tree
+			layout_source_list_t current;
+			if (!addLayoutSource(source.mFilename, current)
+				|| current[0].mModTime != source.mModTime
+				|| current[0].mSize != source.mSize)
+			{
+				valid = false;
+			}
+			entry.mSources.push_back(source);
+		}
+
+		if (!input_stream.good() || !LLXMLNode::readBinary(input_stream, entry.mRoot))
+		{
+			llwarns << "Truncated UI layout cache " << filename << llendl;
+			break;
+		}
+
+		if (valid && !entry.mSources.empty())
+		{
+			sLayoutCache[key] = entry;
+			++loaded;
+		}
+		else
+		{
+			++stale;
+		}
+	}
+
+	llinfos << "Loaded " << loaded << " UI layouts from " << filename
+			<< " (" << stale << " out of date)" << llendl;
+	return loaded > 0;
+}
+
+// static
+bool LLUICtrlFactory::saveLayoutCache(const std::string& filename)
+{
+	llofstream output_stream(filename, std::ios::out | std::ios::binary);
+	if (!output_stream.is_open())
+	{
+		llwarns << "Unable to write UI layout cache " << filename << llendl;
+		return false;
+	}
+
+	write_layout_value(output_stream, LAYOUT_CACHE_MAGIC);
+	write_layout_value(output_stream, LAYOUT_CACHE_VERSION);
+	write_layout_value(output_stream, (U32)sLayoutCache.size());
+	for (layout_cache_t::const_iterator it = sLayoutCache.begin();
+		 it != sLayoutCache.end(); ++it)
+	{
+		const LayoutCacheEntry& entry = it->second;
+		write_layout_string(output_stream, it->first);
+		write_layout_value(output_stream, (U32)entry.mSources.size());
+		for (layout_source_list_t::const_iterator src = entry.mSources.begin();
+			 src != entry.mSources.end(); ++src)
+		{
+			write_layout_string(output_stream, src->mFilename);
+			write_layout_value(output_stream, src->mModTime);
+			write_layout_value(output_stream, src->mSize);
+		}
+		entry.mRoot->writeBinary(output_stream);
+	}
+	return output_stream.good();
+}
+
+// static
+void LLUICtrlFactory::dumpLayoutCacheStats()
+{
+	llinfos << "UI layout cache: " << sLayoutCache.size() << " layouts, "
+			<< sLayoutCacheHits << " hits averaging "
+			<< (sLayoutCacheHits ? sLayoutCopySeconds * 1000.0 / sLayoutCacheHits : 0.0)
+			<< " ms, " << sLayoutCacheMisses << " parses averaging "
+			<< (sLayoutCacheMisses ? sLayoutParseSeconds * 1000.0 / sLayoutCacheMisses : 0.0)
+			<< " ms; " << sFloatersBuilt << " floaters built averaging "
+			<< (sFloatersBuilt ? sFloaterBuildSeconds * 1000.0 / sFloatersBuilt : 0.0)
+			<< " ms" << llendl;
+}
+
 
 //-----------------------------------------------------------------------------
 // buildFloater()
@@ -230,6 +475,7 @@ bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNo
 void LLUICtrlFactory::buildFloater(LLFloater* floaterp, const std::string& filename, 
 									const LLCallbackMap::map_t* factory_map, BOOL open) /* Flawfinder: ignore */
 {
+	LLTimer timer;
 	LLXMLNodePtr root;
 
 	if (!LLUICtrlFactory::getLayeredXMLNode(filename, root))
@@ -263,6 +509,12 @@ void LLUICtrlFactory::buildFloater(LLFloater* floaterp, const std::string& filen
 
 	LLHandle<LLFloater> handle = floaterp->getHandle();
 	mBuiltFloaters[handle] = filename;
+
+	F64 elapsed = timer.getElapsedTimeF64();
+	++sFloatersBuilt;
+	sFloaterBuildSeconds += elapsed;
+	LL_DEBUGS("XUI") << "Built floater " << filename << " in "
+					 << elapsed * 1000.0 << " ms" << LL_ENDL;
 }
 
 //-----------------------------------------------------------------------------
@@ -408,6 +660,9 @@ LLPieMenu *LLUICtrlFactory::buildPieMenu(const std::string &filename, LLView* pa
 //-----------------------------------------------------------------------------
 void LLUICtrlFactory::rebuild()
 {
+	// pick up edits to the XML on disk
+	clearLayoutCache();
+
 	built_panel_t::iterator built_panel_it;
 	for (built_panel_it = mBuiltPanels.begin();
 		built_panel_it != mBuiltPanels.end();
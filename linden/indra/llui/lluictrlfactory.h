@@ -34,7 +34,9 @@
 #define LLUICTRLFACTORY_H
 
 #include <iosfwd>
+#include <map>
 #include <stack>
+#include <vector>
 
 #include "llcallbackmap.h"
 #include "llfloater.h"
@@ -76,13 +78,54 @@ public:
 	virtual LLView* createCtrlWidget(LLPanel *parent, LLXMLNodePtr node);
 	virtual LLView* createWidget(LLPanel *parent, LLXMLNodePtr node);
 
+	// Returns a private copy of the merged (base + localized layers) tree
+	// for filename.  Merged trees are cached per file, skin and language,
+	// so only the first build of a floater or panel touches disk and Expat.
 	static bool getLayeredXMLNode(const std::string &filename, LLXMLNodePtr& root);
 
 	static const std::vector<std::string>& getXUIPaths();
 
+	// Drops every cached layout; called when the skin or language changes.
+	static void clearLayoutCache();
+
+	// The layout cache can be carried across sessions in a binary file.
+	// Entries remember the size and modification time of every XML file
+	// they were merged from and are discarded on load if any changed.
+	static bool loadLayoutCache(const std::string& filename);
+	static bool saveLayoutCache(const std::string& filename);
+	static void dumpLayoutCacheStats();
+
 private:
 	bool getLayeredXMLNodeImpl(const std::string &filename, LLXMLNodePtr& root);
 
+	struct LayoutSource
+	{
+		std::string mFilename;
+		S64 mModTime;
+		S64 mSize;
+	};
+	typedef std::vector<LayoutSource> layout_source_list_t;
+
+	struct LayoutCacheEntry
+	{
+		LLXMLNodePtr mRoot;
+		layout_source_list_t mSources;
+	};
+	typedef std::map<std::string, LayoutCacheEntry> layout_cache_t;
+
+	static bool parseLayeredXMLNode(const std::string &xui_filename, LLXMLNodePtr& root,
+									layout_source_list_t& sources);
+	static bool addLayoutSource(const std::string& filename, layout_source_list_t& sources);
+	static std::string getLayoutCacheKey(const std::string& xui_filename);
+
+	static layout_cache_t sLayoutCache;
+	static U32 sLayoutCacheHits;
+	static U32 sLayoutCacheMisses;
+	static F64 sLayoutParseSeconds;
+	static F64 sLayoutCopySeconds;
+	static U32 sFloatersBuilt;
+	static F64 sFloaterBuildSeconds;
+
 	typedef std::map<LLHandle<LLPanel>, std::string> built_panel_t;
 	built_panel_t mBuiltPanels;
 
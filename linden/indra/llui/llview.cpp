@@ -67,6 +67,7 @@ std::string LLView::sMouseHandlerMessage;
 BOOL	LLView::sEditingUI = FALSE;
 BOOL	LLView::sForceReshape = FALSE;
 LLView*	LLView::sEditingUIView = NULL;
+BOOL	LLView::sUseChildNameIndex = TRUE;
 S32		LLView::sLastLeftXML = S32_MIN;
 S32		LLView::sLastBottomXML = S32_MIN;
 
@@ -87,7 +88,9 @@ LLView::LLView() :
 	mUseBoundingRect(FALSE),
 	mVisible(TRUE),
 	mNextInsertionOrdinal(0),
-	mHoverCursor(UI_CURSOR_ARROW)
+	mHoverCursor(UI_CURSOR_ARROW),
+	mChildNameIndexDirty(false),
+	mChildListGeneration(0)
 {
 }
 
@@ -105,7 +108,9 @@ LLView::LLView(const std::string& name, BOOL mouse_opaque) :
 	mUseBoundingRect(FALSE),
 	mVisible(TRUE),
 	mNextInsertionOrdinal(0),
-	mHoverCursor(UI_CURSOR_ARROW)
+	mHoverCursor(UI_CURSOR_ARROW),
+	mChildNameIndexDirty(false),
+	mChildListGeneration(0)
 {
 }
 
@@ -127,7 +132,9 @@ LLView::LLView(
 	mUseBoundingRect(FALSE),
 	mVisible(TRUE),
 	mNextInsertionOrdinal(0),
-	mHoverCursor(UI_CURSOR_ARROW)
+	mHoverCursor(UI_CURSOR_ARROW),
+	mChildNameIndexDirty(false),
+	mChildListGeneration(0)
 {
 }
 
@@ -225,12 +232,26 @@ const std::string& LLView::getName() const
 	return mName.empty() ? unnamed : mName;
 }
 
+void LLView::setName(std::string name)
+{
+	if (name == mName)
+	{
+		return;
+	}
+	mName = name;
+	if (mParentView)
+	{
+		mParentView->childOrderChanged();
+	}
+}
+
 void LLView::sendChildToFront(LLView* child)
 {
 	if (child && child->getParent() == this) 
 	{
 		mChildList.remove( child );
 		mChildList.push_front(child);
+		indexChild(child, true);
 	}
 }
 
@@ -240,9 +261,74 @@ void LLView::sendChildToBack(LLView* child)
 	{
 		mChildList.remove( child );
 		mChildList.push_back(child);
+		unindexChild(child);
+		indexChild(child, false);
+	}
+}
+
+void LLView::indexChild(LLView* child, bool at_front)
+{
+	bumpChildListGeneration();
+	if (mChildNameIndexDirty)
+	{
+		return;
+	}
+	if (at_front)
+	{
+		mChildNameIndex[child->getName()] = child;
+	}
+	else
+	{
+		// only wins if no earlier child has the name
+		mChildNameIndex.insert(std::make_pair(child->getName(), child));
+	}
+}
+
+void LLView::unindexChild(LLView* child)
+{
+	bumpChildListGeneration();
+	if (mChildNameIndexDirty)
+	{
+		return;
+	}
+	child_name_map_t::iterator found = mChildNameIndex.find(child->getName());
+	if (found != mChildNameIndex.end() && found->second == child)
+	{
+		// another child may share the name; let the next lookup work
+		// out which one is now first
+		mChildNameIndexDirty = true;
 	}
 }
 
+void LLView::bumpChildListGeneration()
+{
+	for (LLView* view = this; view; view = view->mParentView)
+	{
+		++view->mChildListGeneration;
+	}
+}
+
+void LLView::childOrderChanged()
+{
+	bumpChildListGeneration();
+	mChildNameIndexDirty = true;
+}
+
+LLView* LLView::findIndexedChild(const std::string& name) const
+{
+	if (mChildNameIndexDirty)
+	{
+		mChildNameIndex.clear();
+		for (child_list_const_iter_t child_it = mChildList.begin(); child_it != mChildList.end(); ++child_it)
+		{
+			mChildNameIndex.insert(std::make_pair((*child_it)->getName(), *child_it));
+		}
+		mChildNameIndexDirty = false;
+	}
+	child_name_map_t::const_iterator found = mChildNameIndex.find(name);
+	return (found == mChildNameIndex.end()) ? NULL : found->second;
+}
+
 void LLView::moveChildToFrontOfTabGroup(LLUICtrl* child)
 {
 	if(mCtrlOrder.find(child) != mCtrlOrder.end())
@@ -273,6 +359,7 @@ void LLView::addChild(LLView* child, S32 tab_group)
 
 	// add to front of child list, as normal
 	mChildList.push_front(child);
+	indexChild(child, true);
 
 	// add to ctrl list if is LLUICtrl
 	if (child->isCtrl())
@@ -300,6 +387,7 @@ void LLView::addChildAtEnd(LLView* child, S32 tab_group)
 
 	// add to back of child list
 	mChildList.push_back(child);
+	indexChild(child, false);
 
 	// add to ctrl list if is LLUICtrl
 	if (child->isCtrl())
@@ -318,6 +406,7 @@ void LLView::removeChild(LLView* child, BOOL deleteIt)
 	if (child->mParentView == this) 
 	{
 		mChildList.remove( child );
+		unindexChild(child);
 		child->mParentView = NULL;
 		if (child->isCtrl())
 		{
@@ -1697,14 +1786,25 @@ LLView* LLView::getChildView(const std::string& name, BOOL recurse, BOOL create_
 	//	return NULL;
 	child_list_const_iter_t child_it;
 	// Look for direct children *first*
-	for ( child_it = mChildList.begin(); child_it != mChildList.end(); ++child_it)
+	if (sUseChildNameIndex)
 	{
-		LLView* childp = *child_it;
-		if (childp->getName() == name)
+		LLView* childp = findIndexedChild(name);
+		if (childp)
 		{
 			return childp;
 		}
 	}
+	else
+	{
+		for ( child_it = mChildList.begin(); child_it != mChildList.end(); ++child_it)
+		{
+			LLView* childp = *child_it;
+			if (childp->getName() == name)
+			{
+				return childp;
+			}
+		}
+	}
 	if (recurse)
 	{
 		// Look inside each child as well.
@@ -291,7 +291,7 @@ public:
 	void		setFollowsAll()					{ mReshapeFlags |= FOLLOWS_ALL; }
 
 	void        setSoundFlags(U8 flags)			{ mSoundFlags = flags; }
-	void		setName(std::string name)			{ mName = name; }
+	void		setName(std::string name);
 	void		setUseBoundingRect( BOOL use_bounding_rect );
 	BOOL		getUseBoundingRect();
 
@@ -375,7 +375,7 @@ public:
 	LLView*		getParent() const				{ return mParentView; }
 	LLView*		getFirstChild() const			{ return (mChildList.empty()) ? NULL : *(mChildList.begin()); }
 	S32			getChildCount()	const			{ return (S32)mChildList.size(); }
-	template<class _Pr3> void sortChildren(_Pr3 _Pred) { mChildList.sort(_Pred); }
+	template<class _Pr3> void sortChildren(_Pr3 _Pred) { mChildList.sort(_Pred); childOrderChanged(); }
 	BOOL		hasAncestor(const LLView* parentp) const;
 	BOOL		hasChild(const std::string& childname, BOOL recurse = FALSE) const;
 	BOOL 		childHasKeyboardFocus( const std::string& childname ) const;
@@ -463,6 +463,10 @@ public:
 	virtual LLSD	getValue() const;
 
 	const child_list_t*	getChildList() const { return &mChildList; }
+	// Moves whenever a child is added, removed, reordered or renamed
+	// anywhere below this view.  Caches of recursive lookups (see LLPanel)
+	// are only valid while it is unchanged.
+	U32			getChildListGeneration() const	{ return mChildListGeneration; }
 
 	// LLMouseHandler functions
 	//  Default behavior is to pass events to children
@@ -669,6 +673,23 @@ private:
 
 	ECursorType mHoverCursor;
 
+	// Name -> first child (in mChildList order) with that name, so that
+	// getChildView() does not string compare every child.  Kept up to
+	// date by addChild()/removeChild() where that is cheap; anything that
+	// could change which duplicate comes first just marks it dirty and
+	// the next lookup rebuilds it.
+	typedef std::map<std::string, LLView*> child_name_map_t;
+	mutable child_name_map_t mChildNameIndex;
+	mutable bool mChildNameIndexDirty;
+
+	void indexChild(LLView* child, bool at_front);
+	void unindexChild(LLView* child);
+	void childOrderChanged();
+	LLView* findIndexedChild(const std::string& name) const;
+
+	U32 mChildListGeneration;
+	void bumpChildListGeneration();	// on this view and all its ancestors
+
 public:
 	static BOOL	sDebugRects;	// Draw debug rects behind everything.
 	static BOOL sDebugKeys;
@@ -681,6 +702,8 @@ public:
 	static S32 sLastLeftXML;
 	static S32 sLastBottomXML;
 	static BOOL sForceReshape;
+
+	static BOOL sUseChildNameIndex;	// for benchmarking against the plain walk
 };
 
 class LLCompareByTabOrder
@@ -144,10 +144,11 @@ LLXMLNodePtr LLXMLNode::deepCopy()
 	LLXMLNodePtr newnode = LLXMLNodePtr(new LLXMLNode(*this));
 	if (mChildren.notNull())
 	{
-		for (LLXMLChildList::iterator iter = mChildren->map.begin();
-			 iter != mChildren->map.end(); ++iter)
+		// walk the sibling list rather than the name map so the copy
+		// keeps document order
+		for (LLXMLNodePtr child = mChildren->head; child.notNull(); child = child->mNext)
 		{
-			newnode->addChild(iter->second->deepCopy());
+			newnode->addChild(child->deepCopy());
 		}
 	}
 	for (LLXMLAttribList::iterator iter = mAttributes.begin();
@@ -736,6 +737,165 @@ bool LLXMLNode::parseBuffer(
 	return true;
 }
 
+namespace
+{
+	const U32 MAX_BINARY_STRING_LENGTH = 1024 * 1024;
+	const U32 MAX_BINARY_NODE_COUNT = 1024 * 1024;
+	const S32 MAX_BINARY_DEPTH = 256;
+
+	template <class T>
+	void write_binary(std::ostream& output_stream, const T& value)
+	{
+		output_stream.write((const char*)&value, sizeof(T));
+	}
+
+	void write_binary_string(std::ostream& output_stream, const std::string& value)
+	{
+		write_binary(output_stream, (U32)value.size());
+		output_stream.write(value.data(), value.size());
+	}
+
+	template <class T>
+	bool read_binary(std::istream& input_stream, T& value)
+	{
+		input_stream.read((char*)&value, sizeof(T));
+		return input_stream.good();
+	}
+
+	bool read_binary_string(std::istream& input_stream, std::string& value)
+	{
+		U32 length = 0;
+		if (!read_binary(input_stream, length) || length > MAX_BINARY_STRING_LENGTH)
+		{
+			return false;
+		}
+		value.resize(length);
+		if (length)
+		{
+			input_stream.read(&value[0], length);
+		}
+		return input_stream.good();
+	}
+}
+
+void LLXMLNode::writeBinary(std::ostream& output_stream) const
+{
+	write_binary(output_stream, (U8)mIsAttribute);
+	write_binary(output_stream, (U8)mType);
+	write_binary(output_stream, (U8)mEncoding);
+	write_binary(output_stream, mVersionMajor);
+	write_binary(output_stream, mVersionMinor);
+	write_binary(output_stream, mLength);
+	write_binary(output_stream, mPrecision);
+	write_binary_string(output_stream, mName ? std::string(mName->mString) : std::string());
+	write_binary_string(output_stream, mID);
+	write_binary_string(output_stream, mValue);
+
+	write_binary(output_stream, (U32)mAttributes.size());
+	for (LLXMLAttribList::const_iterator iter = mAttributes.begin();
+		 iter != mAttributes.end(); ++iter)
+	{
+		iter->second->writeBinary(output_stream);
+	}
+
+	U32 num_children = 0;
+	LLXMLNodePtr child;
+	if (mChildren.notNull())
+	{
+		for (child = mChildren->head; child.notNull(); child = child->mNext)
+		{
+			++num_children;
+		}
+	}
+	write_binary(output_stream, num_children);
+	if (mChildren.notNull())
+	{
+		for (child = mChildren->head; child.notNull(); child = child->mNext)
+		{
+			child->writeBinary(output_stream);
+		}
+	}
+}
+
+static bool read_binary_node(std::istream& input_stream, LLXMLNodePtr& node, S32 depth)
+{
+	if (depth > MAX_BINARY_DEPTH)
+	{
+		return false;
+	}
+
+	U8 is_attribute = 0;
+	U8 type = 0;
+	U8 encoding = 0;
+	U32 version_major = 0;
+	U32 version_minor = 0;
+	U32 length = 0;
+	U32 precision = 0;
+	std::string name;
+	std::string id;
+	std::string value;
+	if (!read_binary(input_stream, is_attribute)
+		|| !read_binary(input_stream, type)
+		|| !read_binary(input_stream, encoding)
+		|| !read_binary(input_stream, version_major)
+		|| !read_binary(input_stream, version_minor)
+		|| !read_binary(input_stream, length)
+		|| !read_binary(input_stream, precision)
+		|| !read_binary_string(input_stream, name)
+		|| !read_binary_string(input_stream, id)
+		|| !read_binary_string(input_stream, value))
+	{
+		return false;
+	}
+	if (type > LLXMLNode::TYPE_NODEREF || encoding > LLXMLNode::ENCODING_HEX)
+	{
+		return false;
+	}
+
+	node = new LLXMLNode(name.c_str(), is_attribute);
+	// setValue() retypes containers, so set the type afterwards
+	node->setValue(value);
+	node->mType = (LLXMLNode::ValueType)type;
+	node->mEncoding = (LLXMLNode::Encoding)encoding;
+	node->mVersionMajor = version_major;
+	node->mVersionMinor = version_minor;
+	node->mLength = length;
+	node->mPrecision = precision;
+	node->mID = id;
+
+	for (S32 pass = 0; pass < 2; ++pass)
+	{
+		// attributes first, then children
+		U32 count = 0;
+		if (!read_binary(input_stream, count) || count > MAX_BINARY_NODE_COUNT)
+		{
+			return false;
+		}
+		for (U32 i = 0; i < count; ++i)
+		{
+			LLXMLNodePtr child;
+			if (!read_binary_node(input_stream, child, depth + 1))
+			{
+				return false;
+			}
+			node->addChild(child);
+		}
+	}
+	return true;
+}
+
+// static
+bool LLXMLNode::readBinary(std::istream& input_stream, LLXMLNodePtr& node)
+{
+	LLXMLNodePtr result;
+	if (!read_binary_node(input_stream, result, 0))
+	{
+		return false;
+	}
+	node = result;
+	return true;
+}
+
 // static
 bool LLXMLNode::parseStream(
 	std::istream& str,
@@ -157,6 +157,12 @@ public:
     void writeToFile(LLFILE *fOut, const std::string& indent = std::string());
     void writeToOstream(std::ostream& output_stream, const std::string& indent = std::string());
 
+	// Compact binary form of a whole tree, for caches of files that
+	// would otherwise be re-parsed with Expat.  Native byte order, so it
+	// is only meant to be read back by the same build.
+	void writeBinary(std::ostream& output_stream) const;
+	static bool readBinary(std::istream& input_stream, LLXMLNodePtr& node);
+
     // Utility
     void findName(const std::string& name, LLXMLNodeList &results);
     void findName(LLStringTableEntry* name, LLXMLNodeList &results);
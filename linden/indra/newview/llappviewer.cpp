@@ -56,6 +56,7 @@
 #include "llfloaterjoystick.h"
 #include "llares.h" 
 #include "llcurl.h"
+#include "llbuffer.h"
 #include "llfloatersnapshot.h"
 #include "lltexturestats.h"
 #include "llviewerwindow.h"
@@ -104,10 +105,13 @@
 #include "llassetstorage.h"
 #include "llpolymesh.h"
 #include "llcachename.h"
+#include "llnamecachefile.h"
 #include "kokuastreamingaudio.h"
 #include "llaudioengine.h"
 #include "llstreamingaudio.h"
 #include "llviewermenu.h"
+#include "llsculptmeshcache.h"
+#include "lltexturedxtcache.h"
 #include "llselectmgr.h"
 #include "lltrans.h"
 #include "lluitrans.h"
@@ -552,6 +556,7 @@ const std::string LLAppViewer::sCrashSettingsName = "CrashSettings";
 
 LLTextureCache* LLAppViewer::sTextureCache = NULL; 
 LLImageDecodeThread* LLAppViewer::sImageDecodeThread = NULL; 
+LLImageEncodeThread* LLAppViewer::sImageEncodeThread = NULL;
 LLTextureFetch* LLAppViewer::sTextureFetch = NULL; 
 
 LLAppViewer::LLAppViewer() : 
@@ -613,6 +618,7 @@ bool LLAppViewer::init()
     // *NOTE:Mani - LLCurl::initClass is not thread safe. 
     // Called before threads are created.
     LLCurl::initClass();
+    LLHeapBuffer::initClass();
 
     initThreads();
 
@@ -660,6 +666,8 @@ bool LLAppViewer::init()
 		LLError::setPrintLocation(true);
 	}
 
+	LLError::setAsyncFileRecording(gSavedSettings.getBOOL("AsyncLogFile"));
+
 	// ZWAGOTH: This resolves a bunch of skin updating problems and makes skinning
 	// SIGNIFICANLTLY easier. User colors > skin colors > default skin colors.
 	// This also will get rid of the Invalid control... spam when a skin doesn't have that color
@@ -772,6 +780,14 @@ bool LLAppViewer::init()
 			OSMB_OK);
 		return 1;
 	}
+
+	// Floaters built while the window comes up can use layouts merged
+	// in an earlier session.
+	if (gSavedSettings.getBOOL("XUILayoutCache"))
+	{
+		LLUICtrlFactory::loadLayoutCache(
+			gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "xui_layouts.bin"));
+	}
 	
 	//
 	// Initialize the window
@@ -1061,6 +1077,10 @@ bool LLAppViewer::mainLoop()
 						// also pause worker threads during this wait period
 						LLAppViewer::getTextureCache()->pause();
 						LLAppViewer::getImageDecodeThread()->pause();
+						LLAppViewer::getImageEncodeThread()->pause();
+						LLPrimitive::getVolumeManager()->pauseBuildThread();
+						LLSculptMeshCache::pause();
+						LLTextureDXTCache::pause();
 					}
 				}
 				
@@ -1085,7 +1105,11 @@ bool LLAppViewer::mainLoop()
 					S32 io_pending = 0;
  					work_pending += LLAppViewer::getTextureCache()->update(1); // unpauses the texture cache thread
  					work_pending += LLAppViewer::getImageDecodeThread()->update(1); // unpauses the image thread
+ 					work_pending += LLAppViewer::getImageEncodeThread()->update(1); // unpauses the encode thread, runs encode callbacks
  					work_pending += LLAppViewer::getTextureFetch()->update(1); // unpauses the texture fetch thread
+					work_pending += LLPrimitive::getVolumeManager()->updateBuildThread(1); // unpauses the sculpt build thread
+					work_pending += LLSculptMeshCache::update(1); // unpauses the sculpt mesh cache thread
+					work_pending += LLTextureDXTCache::update(1); // unpauses the texture DXT cache thread
 					io_pending += LLVFSThread::updateClass(1);
 					io_pending += LLLFSThread::updateClass(1);
 					if (io_pending > 1000)
@@ -1112,6 +1136,10 @@ bool LLAppViewer::mainLoop()
 				{
 					LLAppViewer::getTextureCache()->pause();
 					LLAppViewer::getImageDecodeThread()->pause();
+					LLAppViewer::getImageEncodeThread()->pause();
+					LLPrimitive::getVolumeManager()->pauseBuildThread();
+					LLSculptMeshCache::pause();
+					LLTextureDXTCache::pause();
 					// LLAppViewer::getTextureFetch()->pause(); // Don't pause the fetch (IO) thread
 				}
 				//LLVFSThread::sLocal->pause(); // Prevent the VFS thread from running while rendering.
@@ -1211,6 +1239,13 @@ bool LLAppViewer::cleanup()
 
 	llinfos << "Cleaning Up" << llendflush;
 
+	LLUICtrlFactory::dumpLayoutCacheStats();
+	if (gSavedSettings.getBOOL("XUILayoutCache"))
+	{
+		LLUICtrlFactory::saveLayoutCache(
+			gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "xui_layouts.bin"));
+	}
+
 	// Must clean up texture references before viewer window is destroyed.
 	LLHUDManager::getInstance()->updateEffects();
 	LLHUDObject::updateAll();
@@ -1250,6 +1285,9 @@ bool LLAppViewer::cleanup()
 
 	LLPolyMesh::freeAllMeshes();
 
+	// A cache preload nobody took, e.g. when quitting during login.
+	gInventory.stopCachePreload();
+
 	LLAvatarNameCache::cleanupClass();
 	delete gCacheName;
 	gCacheName = NULL;
@@ -1486,7 +1524,10 @@ bool LLAppViewer::cleanup()
 		S32 pending = 0;
 		pending += LLAppViewer::getTextureCache()->update(1); // unpauses the worker thread
 		pending += LLAppViewer::getImageDecodeThread()->update(1); // unpauses the image thread
+		pending += LLAppViewer::getImageEncodeThread()->update(1); // unpauses the encode thread
 		pending += LLAppViewer::getTextureFetch()->update(1); // unpauses the texture fetch thread
+		pending += LLSculptMeshCache::update(1); // finishes queued sculpt mesh writes
+		pending += LLTextureDXTCache::update(1); // finishes queued texture DXT writes
 		pending += LLVFSThread::updateClass(0);
 		pending += LLLFSThread::updateClass(0);
 		if (pending == 0)
@@ -1505,12 +1546,17 @@ bool LLAppViewer::cleanup()
 	sTextureCache->shutdown();
 	sTextureFetch->shutdown();
 	sImageDecodeThread->shutdown();
+	sImageEncodeThread->shutdown();
+	LLSculptMeshCache::cleanupClass();
+	LLTextureDXTCache::cleanupClass(); // after the fetch thread, which saves to it
 	delete sTextureCache;
     sTextureCache = NULL;
 	delete sTextureFetch;
     sTextureFetch = NULL;
 	delete sImageDecodeThread;
     sImageDecodeThread = NULL;
+	delete sImageEncodeThread;
+	sImageEncodeThread = NULL;
 
 	gSavedSettings.cleanup();//do this after last time gSavedSettings is used  *surprise*
 
@@ -1552,6 +1598,8 @@ bool LLAppViewer::cleanup()
 	LLCurl::cleanupClass();
 	llinfos << "LLCurl cleaned up." << llendflush;
 
+	LLHeapBuffer::cleanupClass();
+
 	// If we're exiting to launch an URL, do that here so the screen
 	// is at the right resolution before we launch IE.
 	if (!gLaunchFileOnQuit.empty())
@@ -1571,6 +1619,9 @@ bool LLAppViewer::cleanup()
 
     llinfos << "Goodbye" << llendflush;
 
+	// Stop the log writer thread; everything queued is written first.
+	LLError::setAsyncFileRecording(false);
+
 	// return 0;
 	return true;
 }
@@ -1615,8 +1666,21 @@ bool LLAppViewer::initThreads()
 
 	// Image decoding
 	LLAppViewer::sImageDecodeThread = new LLImageDecodeThread(enable_threads && true);
+	LLAppViewer::sImageEncodeThread = new LLImageEncodeThread(enable_threads && true);
 	LLAppViewer::sTextureCache = new LLTextureCache(enable_threads && true);
 	LLAppViewer::sTextureFetch = new LLTextureFetch(LLAppViewer::getTextureCache(), sImageDecodeThread, enable_threads && true);
+	if (gSavedSettings.getBOOL("RenderAsyncSculpts"))
+	{
+		LLPrimitive::getVolumeManager()->startBuildThread(enable_threads && true);
+	}
+	if (gSavedSettings.getBOOL("SculptMeshCache"))
+	{
+		LLSculptMeshCache::startThread(enable_threads && true, mSecondInstance);
+	}
+	if (gSavedSettings.getBOOL("TextureDXTCache"))
+	{
+		LLTextureDXTCache::startThread(enable_threads && true, mSecondInstance);
+	}
 	LLImage::initClass(gSavedSettings.getBOOL("UseKDUIfAvailable"));
 
 	// *FIX: no error handling here!
@@ -3176,6 +3240,8 @@ void LLAppViewer::purgeCache()
 {
 	LL_INFOS("AppCache") << "Purging Cache and Texture Cache..." << llendl;
 	LLAppViewer::getTextureCache()->purgeCache(LL_PATH_CACHE);
+	LLSculptMeshCache::purge();
+	LLTextureDXTCache::purge();
 	std::string mask = gDirUtilp->getDirDelimiter() + "*.*";
 	gDirUtilp->deleteFilesInDir(gDirUtilp->getExpandedFilename(LL_PATH_CACHE,""),mask);
 }
@@ -3307,6 +3373,29 @@ void LLAppViewer::saveFinalSnapshot()
 
 void LLAppViewer::loadNameCache()
 {
+	// Binary cache holding both legacy and display names. The XML caches
+	// below are only read when it is missing, e.g. on first run after
+	// upgrading.
+	std::string bin_filename = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "name_cache.bin");
+	llifstream bin_stream(bin_filename, std::ios::in | std::ios::binary);
+	if (bin_stream.is_open())
+	{
+		LLNameCacheFile file;
+		if (file.read(bin_stream))
+		{
+			LLAvatarNameCache::importFile(file);
+			if (gCacheName)
+			{
+				gCacheName->importFile(file);
+			}
+			return;
+		}
+		// Corrupt or from another version; throw it away rather than
+		// importing part of it. It is rewritten on the next save.
+		bin_stream.close();
+		LLFile::remove(bin_filename);
+	}
+
 	// display names cache
 	std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.xml");
 	llifstream name_cache_stream(filename);
@@ -3337,22 +3426,28 @@ void LLAppViewer::loadNameCache()
 
 void LLAppViewer::saveNameCache()
 {
-	// display names cache
-	std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.xml");
-	llofstream name_cache_stream(filename);
-	if (name_cache_stream.is_open())
+	LLNameCacheFile file;
+	LLAvatarNameCache::exportFile(file);
+	if (gCacheName)
 	{
-		LLAvatarNameCache::exportFile(name_cache_stream);
+		gCacheName->exportFile(file);
+		gCacheName->dumpStats();
 	}
+	LLAvatarNameCache::dumpStats();
 
-	if (!gCacheName) return;
-
-	std::string name_cache;
-	name_cache = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "name.cache");
-	llofstream cache_file(name_cache);
-	if(cache_file.is_open())
+	std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "name_cache.bin");
+	llofstream name_cache_stream(filename, std::ios::out | std::ios::binary);
+	if (name_cache_stream.is_open())
 	{
-		gCacheName->exportFile(cache_file);
+		file.write(name_cache_stream);
+		name_cache_stream.close();
+		if (!name_cache_stream.fail())
+		{
+			// Everything has been migrated to the binary cache, so the old
+			// XML caches would only be stale if it ever got discarded.
+			LLFile::remove(gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.xml"));
+			LLFile::remove(gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "name.cache"));
+		}
 	}
 }
 
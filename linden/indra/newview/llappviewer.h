@@ -37,6 +37,7 @@
 
 class LLTextureCache;
 class LLImageDecodeThread;
+class LLImageEncodeThread;
 class LLTextureFetch;
 class LLWatchdogTimeout;
 class LLCommandLineParser;
@@ -94,6 +95,7 @@ public:
 	// Thread accessors
 	static LLTextureCache* getTextureCache() { return sTextureCache; }
 	static LLImageDecodeThread* getImageDecodeThread() { return sImageDecodeThread; }
+	static LLImageEncodeThread* getImageEncodeThread() { return sImageEncodeThread; }
 	static LLTextureFetch* getTextureFetch() { return sTextureFetch; }
 
 	const std::string& getSerialNumber() { return mSerialNumber; }
@@ -217,6 +219,7 @@ private:
 	// Thread objects.
 	static LLTextureCache* sTextureCache; 
 	static LLImageDecodeThread* sImageDecodeThread; 
+	static LLImageEncodeThread* sImageEncodeThread;
 	static LLTextureFetch* sTextureFetch;
 
 	S32 mNumSessions;
@@ -253,6 +253,7 @@ LLFastTimerView::LLFastTimerView(const std::string& name, const LLRect& rect)
 			llassert(level < FTV_DISPLAY_NUM);
 			ft_display_table[i].desc = text;
 			ft_display_table[i].level = level;
+			LLFastTimer::setTimerName(ft_display_table[i].timer, text);
 			if (level > 0)
 			{
 				ft_display_table[i].parent = pidx[level-1];
@@ -275,10 +276,32 @@ LLFastTimerView::LLFastTimerView(const std::string& name, const LLRect& rect)
 
 LLFastTimerView::~LLFastTimerView()
 {
+	LLFastTimer::setTracing(false);
 	delete[] mBarStart;
 	delete[] mBarEnd;
 }
 
+void LLFastTimerView::onVisibilityChange(BOOL new_visibility)
+{
+	// Only pay for recording trace events while someone is looking.
+	LLFastTimer::setTracing(new_visibility);
+	LLFloater::onVisibilityChange(new_visibility);
+}
+
+void LLFastTimerView::exportChromeTrace()
+{
+	std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "fasttimer_trace.json");
+	llofstream out(filename);
+	if (!out.is_open())
+	{
+		llwarns << "Unable to open " << filename << " for writing" << llendl;
+		return;
+	}
+	LLFastTimer::writeChromeTrace(out, LLFastTimer::FTM_HISTORY_NUM);
+	out.close();
+	llinfos << "Wrote fast timer trace to " << filename << llendl;
+}
+
 BOOL LLFastTimerView::handleRightMouseDown(S32 x, S32 y, MASK mask)
 {
 	if (mBarRect.pointInRect(x, y))
@@ -339,6 +362,10 @@ BOOL LLFastTimerView::handleMouseDown(S32 x, S32 y, MASK mask)
 			mDisplayCalls = !mDisplayCalls;
 		}
 	}
+	else if ((mask & MASK_SHIFT) && (mask & MASK_CONTROL))
+	{
+		exportChromeTrace();
+	}
 	else if (mask & MASK_SHIFT)
 	{
 		if (++mDisplayMode > 3)
@@ -508,7 +535,7 @@ void LLFastTimerView::draw()
 		LLFontGL::getFontMonospace()->renderUTF8(tdesc, 0, x, y, LLColor4::white, LLFontGL::LEFT, LLFontGL::TOP);
 		y -= (texth + 2);
 
-		LLFontGL::getFontMonospace()->renderUTF8(std::string("[Right-Click log selected] [ALT-Click toggle counts] [ALT-SHIFT-Click sub hidden]"),
+		LLFontGL::getFontMonospace()->renderUTF8(std::string("[Right-Click log selected] [ALT-Click toggle counts] [ALT-SHIFT-Click sub hidden] [CTRL-SHIFT-Click save trace]"),
 										 0, x, y, LLColor4::white, LLFontGL::LEFT, LLFontGL::TOP);
 		y -= (texth + 2);
 	}
@@ -47,8 +47,13 @@ public:
 	virtual BOOL handleMouseUp(S32 x, S32 y, MASK mask);
 	virtual BOOL handleHover(S32 x, S32 y, MASK mask);
 	virtual BOOL handleScrollWheel(S32 x, S32 y, S32 clicks);
+	virtual void onVisibilityChange(BOOL new_visibility);
 	virtual void draw();
 
+	// Write the last FTM_HISTORY_NUM frames of timer events from all
+	// threads to fasttimer_trace.json in the log directory.
+	void exportChromeTrace();
+
 	S32 getLegendIndex(S32 y);
 	F64 getTime(LLFastTimer::EFastTimerType tidx);
 	
@@ -656,7 +656,11 @@ void LLFolderViewItem::rename(const std::string& new_name)
 
 const std::string& LLFolderViewItem::getSearchableLabel() const
 {
-	U32 type = mRoot->getFilter()->getSearchType();
+	return getSearchableLabel(mRoot->getFilter()->getSearchType());
+}
+
+const std::string& LLFolderViewItem::getSearchableLabel(U32 type) const
+{
 	switch(type)
 	{
 	case 1:
@@ -2894,8 +2898,9 @@ void LLFolderView::filter( LLInventoryFilter& filter )
 {
 	LLFastTimer t2(LLFastTimer::FTM_FILTER);
 	static S32 *sFilterItemsPerFrame = rebind_llcontrol<S32>("FilterItemsPerFrame", &gSavedSettings, true);
+	static F32 *sFilterMaxTimePerFrame = rebind_llcontrol<F32>("FilterMaxTimePerFrame", &gSavedSettings, true);
 
-	filter.setFilterCount(llclamp(*sFilterItemsPerFrame, 1, 5000));
+	filter.startFilterSlice(llclamp(*sFilterItemsPerFrame, 1, 100000), *sFilterMaxTimePerFrame);
 
 	if (getCompletedFilterGeneration() < filter.getCurrentGeneration())
 	{
@@ -3393,8 +3398,9 @@ void LLFolderView::removeSelectedItems( void )
 						setSelectionFromRoot(NULL, gFocusMgr.childHasKeyboardFocus(this));
 					}
 				}
+				// only the folder that lost an item needs laying out again
+				parent->requestArrange();
 			}
-			arrangeAll();
 		}
 		else if (count > 1)
 		{
@@ -4609,6 +4615,10 @@ LLInventoryFilter::LLInventoryFilter(const std::string& name) :
 	mFilterCount = 0;
 	mNextFilterGeneration = mFilterGeneration + 1;
 
+	mEarliestDate = 0;
+	mSliceSeconds = 0.f;
+	mSliceItems = 0;
+
 	mLastLogoff = gSavedPerAccountSettings.getU32("LastLogoff");
 	mFilterBehavior = FILTER_NONE;
 
@@ -4622,64 +4632,80 @@ LLInventoryFilter::~LLInventoryFilter()
 
 BOOL LLInventoryFilter::check(LLFolderViewItem* item) 
 {
-	time_t earliest;
+	LLFolderViewEventListener* listener = item->getListener();
+	const LLUUID& item_id = listener->getUUID();
 
-	earliest = time_corrected() - mFilterOps.mHoursAgo * 3600;
-	if (mFilterOps.mMinDate > time_min() && mFilterOps.mMinDate < earliest)
-	{
-		earliest = mFilterOps.mMinDate;
-	}
-	else if (!mFilterOps.mHoursAgo)
+	mSubStringMatchOffset = std::string::npos;
+
+	// cheap tests first, so most items never get to the string search
+	BOOL passed = (listener->getNInventoryType() & mFilterOps.mFilterTypes || listener->getNInventoryType() == LLInventoryType::NIT_NONE)
+				&& ((listener->getPermissionMask() & mFilterOps.mPermissions) == mFilterOps.mPermissions)
+				&& (listener->getCreationDate() >= mEarliestDate && listener->getCreationDate() <= mFilterOps.mMaxDate);
+	if (!passed)
 	{
-		earliest = 0;
+		return FALSE;
 	}
-	LLFolderViewEventListener* listener = item->getListener();
-	const LLUUID& item_id = listener->getUUID();
 
 	//When searching for all labels, we need to explode the filter string
 	//Into an array, and then compare each string to the label seperately
 	//Otherwise the filter substring needs to be 
 	//formatted in the same order as the label - rkeast
-
-	BOOL passed;
-	//Added ability to toggle this type of searching for all labels cause it's convienient - RKeast
+	//The words are split once in setFilterSubString().
 	if(mSearchType == 3)
 	{
-		std::istringstream i(mFilterSubString);
-		std::string blah;
-		
-		LLDynamicArray<std::string> search_array;
-
-		while(i >> blah)
+		const std::string& label = item->getSearchableLabel(mSearchType);
+		for (std::vector<std::string>::const_iterator it = mFilterSubStrings.begin();
+			 passed && it != mFilterSubStrings.end(); ++it)
 		{
-			search_array.put(blah);
+			mSubStringMatchOffset = label.find(*it);
+			passed = (mSubStringMatchOffset != std::string::npos);
 		}
-		
-		BOOL subStringMatch = true;
-		for(int i = 0; i < search_array.getLength(); i++)
-		{
-			mSubStringMatchOffset = (search_array.get(i)).size() ? item->getSearchableLabel().find(search_array.get(i)) : std::string::npos;
-			subStringMatch = subStringMatch && ((search_array.get(i)).size() == 0 || mSubStringMatchOffset != std::string::npos);
-		}
-
-		passed = (listener->getNInventoryType() & mFilterOps.mFilterTypes || listener->getNInventoryType() == LLInventoryType::NIT_NONE)
-					&& (subStringMatch)
-					&& (mFilterWorn == false || gAgent.isWearingItem(item_id) ||
-						(gAgent.getAvatarObject() && gAgent.getAvatarObject()->isWearingAttachment(item_id)))
-					&& ((listener->getPermissionMask() & mFilterOps.mPermissions) == mFilterOps.mPermissions)
-					&& (listener->getCreationDate() >= earliest && listener->getCreationDate() <= mFilterOps.mMaxDate);
 	}	
-	else
+	else if (mFilterSubString.size())
+	{
+		mSubStringMatchOffset = item->getSearchableLabel(mSearchType).find(mFilterSubString);
+		passed = (mSubStringMatchOffset != std::string::npos);
+	}
+
+	return passed
+		&& (mFilterWorn == false || gAgent.isWearingItem(item_id) ||
+			(gAgent.getAvatarObject() && gAgent.getAvatarObject()->isWearingAttachment(item_id)));
+}
+
+void LLInventoryFilter::startFilterSlice(S32 count, F32 max_seconds)
+{
+	mFilterCount = count;
+	mSliceSeconds = max_seconds;
+	mSliceItems = 0;
+	mSliceTimer.reset();
+
+	mEarliestDate = time_corrected() - mFilterOps.mHoursAgo * 3600;
+	if (mFilterOps.mMinDate > time_min() && mFilterOps.mMinDate < mEarliestDate)
+	{
+		mEarliestDate = mFilterOps.mMinDate;
+	}
+	else if (!mFilterOps.mHoursAgo)
+	{
+		mEarliestDate = 0;
+	}
+}
+
+void LLInventoryFilter::decrementFilterCount()
+{
+	mFilterCount--;
+
+	// reading the clock for every item would cost more than the check itself
+	const S32 ITEMS_PER_TIME_CHECK = 64;
+	if (mSliceSeconds > 0.f
+		&& mFilterCount > 0
+		&& ++mSliceItems % ITEMS_PER_TIME_CHECK == 0
+		&& mSliceTimer.getElapsedTimeF32() > mSliceSeconds)
 	{
-		mSubStringMatchOffset = mFilterSubString.size() ? item->getSearchableLabel().find(mFilterSubString) : std::string::npos;
-		passed = (listener->getNInventoryType() & mFilterOps.mFilterTypes || listener->getNInventoryType() == LLInventoryType::NIT_NONE)
-					&& (mFilterSubString.size() == 0 || mSubStringMatchOffset != std::string::npos)
-					&& (mFilterWorn == false || gAgent.isWearingItem(item_id) ||
-						(gAgent.getAvatarObject() && gAgent.getAvatarObject()->isWearingAttachment(item_id)))
-					&& ((listener->getPermissionMask() & mFilterOps.mPermissions) == mFilterOps.mPermissions)
-					&& (listener->getCreationDate() >= earliest && listener->getCreationDate() <= mFilterOps.mMaxDate);
+		// out of time for this frame; the filter loops stop as soon as
+		// the count goes negative, and no folder on the way out is
+		// marked as completely filtered
+		mFilterCount = -1;
 	}
-	return passed;
 }
 
 const std::string LLInventoryFilter::getFilterSubString(BOOL trim)
@@ -4780,6 +4806,14 @@ void LLInventoryFilter::setFilterSubString(const std::string& string)
 		LLStringUtil::toUpper(mFilterSubString);
 		LLStringUtil::trimHead(mFilterSubString);
 
+		mFilterSubStrings.clear();
+		std::istringstream words(mFilterSubString);
+		std::string word;
+		while (words >> word)
+		{
+			mFilterSubStrings.push_back(word);
+		}
+
 		if (less_restrictive)
 		{
 			setModified(FILTER_LESS_RESTRICTIVE);
@@ -234,7 +234,9 @@ public:
 
 	void setFilterCount(S32 count) { mFilterCount = count; }
 	S32 getFilterCount() { return mFilterCount; }
-	void decrementFilterCount() { mFilterCount--; }
+	void decrementFilterCount();
+	// starts a frame's worth of filtering: up to count items, or until max_seconds have passed
+	void startFilterSlice(S32 count, F32 max_seconds);
 	
 	void markDefault();
 	void resetDefault();
@@ -268,6 +270,7 @@ protected:
 	filter_ops		mDefaultFilterOps;
 	std::string::size_type	mSubStringMatchOffset;
 	std::string		mFilterSubString;
+	std::vector<std::string> mFilterSubStrings;	// mFilterSubString split into words, for search type 3
 	bool			mFilterWorn;
 	U32				mOrder;
 	const std::string	mName;
@@ -279,6 +282,11 @@ protected:
 	EFilterBehavior mFilterBehavior;
 
 private:
+	time_t mEarliestDate;	// oldest creation date that passes, as of the start of this slice
+	LLTimer mSliceTimer;
+	F32 mSliceSeconds;
+	S32 mSliceItems;
+
 	U32 mLastLogoff;
 	BOOL mModified;
 	BOOL mNeedTextRebuild;
@@ -483,6 +491,7 @@ public:
 	const std::string& getName( void ) const;
 
 	const std::string& getSearchableLabel() const;
+	const std::string& getSearchableLabel(U32 search_type) const;
 
 	// This method returns the label displayed on the view. This
 	// method was primarily added to allow sorting on the folder
@@ -196,13 +196,16 @@ LLInventoryModel::LLInventoryModel() :
 	mParentChildCategoryTree(),
 	mParentChildItemTree(),
 	mObservers(),
-	mIsAgentInvUsable(false)
+	mIsAgentInvUsable(false),
+	mCachePreloader(NULL)
 {
 }
 
 // Destroys the object
 LLInventoryModel::~LLInventoryModel()
 {
+	// gInventory is destroyed after APR is gone, so a leftover cache
+	// preload has to be stopped by LLAppViewer::cleanup() instead.
 	empty();
 	for (observer_list_t::iterator iter = mObservers.begin();
 		 iter != mObservers.end(); ++iter)
@@ -2040,41 +2043,15 @@ bool LLInventoryModel::loadSkeleton(const LLInventoryModel::options_t& options,
 	{
 		cat_array_t categories;
 		item_array_t items;
-		std::string owner_id_str;
-		owner_id.toString(owner_id_str);
-
-		std::string path(gDirUtilp->getExpandedFilename(LL_PATH_CACHE, owner_id_str));
-		std::string inventory_filename;
-		inventory_filename = llformat(CACHE_FORMAT_STRING, path.c_str());
-
 		const S32 NO_VERSION = LLViewerInventoryCategory::VERSION_UNKNOWN;
 
-		std::string gzip_filename(inventory_filename);
-		gzip_filename.append(".gz");
-		LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
-
-		bool remove_inventory_file = false;
-
-		// try to ungzip the inventory -- MC
-		if (fp)
+		// begin cache loading -- MC
+		bool loaded = false;
+		if (!takeCachePreload(owner_id, categories, items, loaded))
 		{
-			fclose(fp);
-			fp = NULL;
-			if (gunzip_file(gzip_filename, inventory_filename))
-			{
-				// we only want to remove the inventory file if it was
-				// gzipped before we loaded, and we successfully
-				// gunziped it.
-				remove_inventory_file = true;
-			}
-			else
-			{
-				llinfos << "Unable to gunzip " << gzip_filename << llendl;
-			}
+			loaded = readCacheFile(owner_id, categories, items);
 		}
-
-		// begin cache loading -- MC
-		if (loadFromFile(inventory_filename, categories, items))
+		if (loaded)
 		{
 			// We were able to find a cache of files. So, use what we
 			// found to generate a set of categories we should add. We
@@ -2188,11 +2165,6 @@ bool LLInventoryModel::loadSkeleton(const LLInventoryModel::options_t& options,
 			}
 		}
 
-		if (remove_inventory_file)
-		{
-			// clean up the gunzipped file.
-			LLFile::remove(inventory_filename);
-		}
 		categories.clear(); // will unref and delete entries
 	}
 
@@ -2203,6 +2175,154 @@ bool LLInventoryModel::loadSkeleton(const LLInventoryModel::options_t& options,
 	return rv;
 }
 
+// static
+bool LLInventoryModel::readCacheFile(const LLUUID& owner_id,
+									 cat_array_t& categories,
+									 item_array_t& items)
+{
+	std::string owner_id_str;
+	owner_id.toString(owner_id_str);
+
+	std::string path(gDirUtilp->getExpandedFilename(LL_PATH_CACHE, owner_id_str));
+	std::string inventory_filename;
+	inventory_filename = llformat(CACHE_FORMAT_STRING, path.c_str());
+
+	std::string gzip_filename(inventory_filename);
+	gzip_filename.append(".gz");
+	LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
+
+	bool remove_inventory_file = false;
+
+	// try to ungzip the inventory -- MC
+	if (fp)
+	{
+		fclose(fp);
+		fp = NULL;
+		if (gunzip_file(gzip_filename, inventory_filename))
+		{
+			// we only want to remove the inventory file if it was
+			// gzipped before we loaded, and we successfully
+			// gunziped it.
+			remove_inventory_file = true;
+		}
+		else
+		{
+			llinfos << "Unable to gunzip " << gzip_filename << llendl;
+		}
+	}
+
+	bool loaded = loadFromFile(inventory_filename, categories, items);
+
+	if (remove_inventory_file)
+	{
+		// clean up the gunzipped file.
+		LLFile::remove(inventory_filename);
+	}
+	return loaded;
+}
+
+// Reads an inventory cache off the main thread. Everything it builds is
+// handed over only after the thread has finished, so no locking is needed
+// beyond the done flag.
+class LLInventoryModel::LLCachePreloader : public LLThread
+{
+public:
+	LLCachePreloader(const LLUUID& owner_id) :
+		LLThread("Inventory Cache Preloader"),
+		mOwnerID(owner_id),
+		mLoaded(false),
+		mDoneCondition(new LLCondition),
+		mDone(false)
+	{
+	}
+
+	~LLCachePreloader()
+	{
+		delete mDoneCondition;
+	}
+
+	/*virtual*/ void run()
+	{
+		LLTimer timer;
+		mLoaded = LLInventoryModel::readCacheFile(mOwnerID, mCategories, mItems);
+		LL_INFOS("Inventory") << "Preloaded inventory cache for " << mOwnerID
+			<< " in " << timer.getElapsedTimeF32() << " seconds" << LL_ENDL;
+		mDoneCondition->lock();
+		mDone = true;
+		mDoneCondition->signal();
+		mDoneCondition->unlock();
+	}
+
+	// Blocks until run() has finished. Must be called before deleting.
+	void waitUntilDone()
+	{
+		mDoneCondition->lock();
+		while (!mDone)
+		{
+			mDoneCondition->wait();
+		}
+		mDoneCondition->unlock();
+		// run() has returned or is about to; only the thread's own
+		// exit bookkeeping is left.
+		while (!isStopped())
+		{
+			yield();
+		}
+	}
+
+	LLUUID mOwnerID;
+	cat_array_t mCategories;
+	item_array_t mItems;
+	bool mLoaded;
+
+private:
+	LLCondition* mDoneCondition;
+	bool mDone;
+};
+
+void LLInventoryModel::startCachePreload(const LLUUID& owner_id)
+{
+	if (owner_id.isNull())
+	{
+		return;
+	}
+	stopCachePreload();
+	mCachePreloader = new LLCachePreloader(owner_id);
+	mCachePreloader->start();
+}
+
+void LLInventoryModel::stopCachePreload()
+{
+	if (mCachePreloader)
+	{
+		mCachePreloader->waitUntilDone();
+		delete mCachePreloader;
+		mCachePreloader = NULL;
+	}
+}
+
+bool LLInventoryModel::takeCachePreload(const LLUUID& owner_id,
+										cat_array_t& categories,
+										item_array_t& items,
+										bool& loaded)
+{
+	if (!mCachePreloader || mCachePreloader->mOwnerID != owner_id)
+	{
+		return false;
+	}
+	LLTimer timer;
+	mCachePreloader->waitUntilDone();
+	LL_DEBUGS("Inventory") << "Waited " << timer.getElapsedTimeF32()
+		<< " seconds for the inventory cache preload" << LL_ENDL;
+
+	categories.swap(mCachePreloader->mCategories);
+	items.swap(mCachePreloader->mItems);
+	loaded = mCachePreloader->mLoaded;
+	delete mCachePreloader;
+	mCachePreloader = NULL;
+	return true;
+}
+
 bool LLInventoryModel::loadMeat(const LLInventoryModel::options_t& options, 
 								const LLUUID& owner_id)
 {
@@ -2663,7 +2783,7 @@ bool LLInventoryModel::loadFromFile(const std::string& filename,
 	// *NOTE: This buffer size is hard coded into scanf() below.
 	char buffer[MAX_STRING];		/*Flawfinder: ignore*/
 	char keyword[MAX_STRING];		/*Flawfinder: ignore*/
-	static S32 item_count_total = 0;
+	S32 item_count = 0;
 	while(!feof(file) && fgets(buffer, MAX_STRING, file)) 
 	{
 		sscanf(buffer, " %254s", keyword);	/* Flawfinder: ignore */
@@ -2698,7 +2818,7 @@ bool LLInventoryModel::loadFromFile(const std::string& filename,
 				//else
 				{
 					items.put(inv_item);
-					item_count_total++;
+					item_count++;
 				}
 			}
 			else
@@ -2713,7 +2833,7 @@ bool LLInventoryModel::loadFromFile(const std::string& filename,
 					<< llendl;
 		}
 	}
-	LL_DEBUGS("Inventory") << "Inventory items loaded from file: " << item_count_total << LL_ENDL;
+	LL_DEBUGS("Inventory") << "Inventory items loaded from file: " << item_count << LL_ENDL;
 	fclose(file);
 	return true;
 }
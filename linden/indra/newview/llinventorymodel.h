@@ -321,6 +321,12 @@ public:
 	bool loadSkeleton(const options_t& options, const LLUUID& owner_id);
 	bool loadMeat(const options_t& options, const LLUUID& owner_id);
 
+	// Starts reading the inventory cache for owner_id on a worker thread
+	// so that loadSkeleton() finds it already parsed. Safe to skip.
+	void startCachePreload(const LLUUID& owner_id);
+	// Waits for and discards a preload that loadSkeleton() never took.
+	void stopCachePreload();
+
 	// This is a brute force method to rebuild the entire parent-child
 	// relations.
 	void buildParentChildMap();
@@ -407,6 +413,18 @@ protected:
 	static bool saveToFile(const std::string& filename,
 						   const cat_array_t& categories,
 						   const item_array_t& items); 
+	// gunzips and loads the cache file for owner_id
+	static bool readCacheFile(const LLUUID& owner_id,
+							  cat_array_t& categories,
+							  item_array_t& items);
+
+	// Waits for a preload of owner_id's cache started by
+	// startCachePreload() and takes its results. Returns false if
+	// there is no such preload.
+	bool takeCachePreload(const LLUUID& owner_id,
+						  cat_array_t& categories,
+						  item_array_t& items,
+						  bool& loaded);
 
 	// message handling functionality
 	//static void processUseCachedInventory(LLMessageSystem* msg, void**);
@@ -476,6 +494,9 @@ protected:
 	// This flag is used to handle an invalid inventory state.
 	bool mIsAgentInvUsable;
 
+	class LLCachePreloader;
+	LLCachePreloader* mCachePreloader;
+
 public:
 	// Returns the UUID of the 'Animations' folder in 'My Inventory' sent from the server at startup
 	LLUUID getAnimationsFolderUUID() const		{ return mAnimationsFolderUUID; }
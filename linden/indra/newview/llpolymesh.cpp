@@ -56,6 +56,9 @@ extern LLControlGroup gSavedSettings;				// read only
 //-----------------------------------------------------------------------------
 LLPolyMesh::LLPolyMeshSharedDataTable LLPolyMesh::sGlobalSharedMeshList;
 
+S32 LLPolyMesh::sMorphBatchDepth = 0;
+std::vector<LLPolyMesh*> LLPolyMesh::sDirtyNormalMeshes;
+
 //-----------------------------------------------------------------------------
 // LLPolyMeshSharedData()
 //-----------------------------------------------------------------------------
@@ -272,8 +275,9 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 		llerrs << "Filename is Empty!" << llendl;
 		return FALSE;
 	}
-	LLFILE* fp = LLFile::fopen(fileName, "rb");			/*Flawfinder: ignore*/
-	if (!fp)
+	// Pull the whole file in at once, the parsers below read many small fields
+	LLPolyMeshFileBuffer buffer;
+	if (!buffer.load(fileName))
 	{
 		llerrs << "can't open: " << fileName << llendl;
 		return FALSE;
@@ -283,7 +287,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 	// Read a chunk
 	//-------------------------------------------------------------------------
 	char header[128];		/*Flawfinder: ignore*/
-	if (fread(header, sizeof(char), 128, fp) != 128)
+	if (buffer.read(header, sizeof(char), 128) != 128)
 	{
 		llwarns << "Short read" << llendl;
 	}
@@ -299,13 +303,13 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 		//----------------------------------------------------------------
 		// File Header (seek past it)
 		//----------------------------------------------------------------
-		fseek(fp, 24, SEEK_SET);
+		buffer.seek(24);
 
 		//----------------------------------------------------------------
 		// HasWeights
 		//----------------------------------------------------------------
 		U8 hasWeights;
-		size_t numRead = fread(&hasWeights, sizeof(U8), 1, fp);
+		size_t numRead = buffer.read(&hasWeights, sizeof(U8), 1);
 		if (numRead != 1)
 		{
 			llerrs << "can't read HasWeights flag from " << fileName << llendl;
@@ -320,7 +324,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 		// HasDetailTexCoords
 		//----------------------------------------------------------------
 		U8 hasDetailTexCoords;
-		numRead = fread(&hasDetailTexCoords, sizeof(U8), 1, fp);
+		numRead = buffer.read(&hasDetailTexCoords, sizeof(U8), 1);
 		if (numRead != 1)
 		{
 			llerrs << "can't read HasDetailTexCoords flag from " << fileName << llendl;
@@ -331,7 +335,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 		// Position
 		//----------------------------------------------------------------
 		LLVector3 position;
-		numRead = fread(position.mV, sizeof(float), 3, fp);
+		numRead = buffer.read(position.mV, sizeof(float), 3);
 		llendianswizzle(position.mV, sizeof(float), 3);
 		if (numRead != 3)
 		{
@@ -344,7 +348,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 		// Rotation
 		//----------------------------------------------------------------
 		LLVector3 rotationAngles;
-		numRead = fread(rotationAngles.mV, sizeof(float), 3, fp);
+		numRead = buffer.read(rotationAngles.mV, sizeof(float), 3);
 		llendianswizzle(rotationAngles.mV, sizeof(float), 3);
 		if (numRead != 3)
 		{
@@ -353,7 +357,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 		}
 
 		U8 rotationOrder;
-		numRead = fread(&rotationOrder, sizeof(U8), 1, fp);
+		numRead = buffer.read(&rotationOrder, sizeof(U8), 1);
 
 		if (numRead != 1)
 		{
@@ -372,7 +376,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 		// Scale
 		//----------------------------------------------------------------
 		LLVector3 scale;
-		numRead = fread(scale.mV, sizeof(float), 3, fp);
+		numRead = buffer.read(scale.mV, sizeof(float), 3);
 		llendianswizzle(scale.mV, sizeof(float), 3);
 		if (numRead != 3)
 		{
@@ -393,7 +397,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 		//----------------------------------------------------------------
 		if (!isLOD())
 		{
-			numRead = fread(&numVertices, sizeof(U16), 1, fp);
+			numRead = buffer.read(&numVertices, sizeof(U16), 1);
 			llendianswizzle(&numVertices, sizeof(U16), 1);
 			if (numRead != 1)
 			{
@@ -406,7 +410,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 			//----------------------------------------------------------------
 			// Coords
 			//----------------------------------------------------------------
-			numRead = fread(mBaseCoords, 3*sizeof(float), numVertices, fp);
+			numRead = buffer.read(mBaseCoords, 3*sizeof(float), numVertices);
 			llendianswizzle(mBaseCoords, sizeof(float), 3*numVertices);
 			if (numRead != numVertices)
 			{
@@ -417,7 +421,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 			//----------------------------------------------------------------
 			// Normals
 			//----------------------------------------------------------------
-			numRead = fread(mBaseNormals, 3*sizeof(float), numVertices, fp);
+			numRead = buffer.read(mBaseNormals, 3*sizeof(float), numVertices);
 			llendianswizzle(mBaseNormals, sizeof(float), 3*numVertices);
 			if (numRead != numVertices)
 			{
@@ -428,7 +432,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 			//----------------------------------------------------------------
 			// Binormals
 			//----------------------------------------------------------------
-			numRead = fread(mBaseBinormals, 3*sizeof(float), numVertices, fp);
+			numRead = buffer.read(mBaseBinormals, 3*sizeof(float), numVertices);
 			llendianswizzle(mBaseBinormals, sizeof(float), 3*numVertices);
 			if (numRead != numVertices)
 			{
@@ -440,7 +444,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 			//----------------------------------------------------------------
 			// TexCoords
 			//----------------------------------------------------------------
-			numRead = fread(mTexCoords, 2*sizeof(float), numVertices, fp);
+			numRead = buffer.read(mTexCoords, 2*sizeof(float), numVertices);
 			llendianswizzle(mTexCoords, sizeof(float), 2*numVertices);
 			if (numRead != numVertices)
 			{
@@ -453,7 +457,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 			//----------------------------------------------------------------
 			if (mHasDetailTexCoords)
 			{
-				numRead = fread(mDetailTexCoords, 2*sizeof(float), numVertices, fp);
+				numRead = buffer.read(mDetailTexCoords, 2*sizeof(float), numVertices);
 				llendianswizzle(mDetailTexCoords, sizeof(float), 2*numVertices);
 				if (numRead != numVertices)
 				{
@@ -467,7 +471,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 			//----------------------------------------------------------------
 			if (mHasWeights)
 			{
-				numRead = fread(mWeights, sizeof(float), numVertices, fp);
+				numRead = buffer.read(mWeights, sizeof(float), numVertices);
 				llendianswizzle(mWeights, sizeof(float), numVertices);
 				if (numRead != numVertices)
 				{
@@ -481,7 +485,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 		// NumFaces
 		//----------------------------------------------------------------
 		U16 numFaces;
-		numRead = fread(&numFaces, sizeof(U16), 1, fp);
+		numRead = buffer.read(&numFaces, sizeof(U16), 1);
 		llendianswizzle(&numFaces, sizeof(U16), 1);
 		if (numRead != 1)
 		{
@@ -499,7 +503,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 		for (i = 0; i < numFaces; i++)
 		{
 			S16 face[3];
-			numRead = fread(face, sizeof(U16), 3, fp);
+			numRead = buffer.read(face, sizeof(U16), 3);
 			llendianswizzle(face, sizeof(U16), 3);
 			if (numRead != 3)
 			{
@@ -556,7 +560,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 			U16 numSkinJoints = 0;
 			if ( mHasWeights )
 			{
-				numRead = fread(&numSkinJoints, sizeof(U16), 1, fp);
+				numRead = buffer.read(&numSkinJoints, sizeof(U16), 1);
 				llendianswizzle(&numSkinJoints, sizeof(U16), 1);
 				if (numRead != 1)
 				{
@@ -572,7 +576,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 			for (i=0; i < numSkinJoints; i++)
 			{
 				char jointName[64+1];
-				numRead = fread(jointName, sizeof(jointName)-1, 1, fp);
+				numRead = buffer.read(jointName, sizeof(jointName)-1, 1);
 				jointName[sizeof(jointName)-1] = '\0'; // ensure nul-termination
 				if (numRead != 1)
 				{
@@ -589,7 +593,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 			//-------------------------------------------------------------------------
 			char morphName[64+1];
 			morphName[sizeof(morphName)-1] = '\0'; // ensure nul-termination
-			while(fread(&morphName, sizeof(char), 64, fp) == 64)
+			while(buffer.read(&morphName, sizeof(char), 64) == 64)
 			{
 				if (!strcmp(morphName, "End Morphs"))
 				{
@@ -598,7 +602,7 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 				}
 				LLPolyMorphData* morph_data = new LLPolyMorphData(std::string(morphName));
 
-				BOOL result = morph_data->loadBinary(fp, this);
+				BOOL result = morph_data->loadBinary(buffer, this);
 
 				if (!result)
 				{
@@ -610,19 +614,19 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 			}
 
 			S32 numRemaps;
-			if (fread(&numRemaps, sizeof(S32), 1, fp) == 1)
+			if (buffer.read(&numRemaps, sizeof(S32), 1) == 1)
 			{
 				llendianswizzle(&numRemaps, sizeof(S32), 1);
 				for (S32 i = 0; i < numRemaps; i++)
 				{
 					S32 remapSrc;
 					S32 remapDst;
-					if (fread(&remapSrc, sizeof(S32), 1, fp) != 1)
+					if (buffer.read(&remapSrc, sizeof(S32), 1) != 1)
 					{
 						llerrs << "can't read source vertex in vertex remap data" << llendl;
 						break;
 					}
-					if (fread(&remapDst, sizeof(S32), 1, fp) != 1)
+					if (buffer.read(&remapDst, sizeof(S32), 1) != 1)
 					{
 						llerrs << "can't read destination vertex in vertex remap data" << llendl;
 						break;
@@ -648,8 +652,6 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 		allocateJointNames(1);
 	}
 
-	fclose( fp );
-
 	return status;
 }
 
@@ -658,9 +660,10 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 //-----------------------------------------------------------------------------
 const S32 *LLPolyMeshSharedData::getSharedVert(S32 vert)
 {
-	if (mSharedVerts.count(vert) > 0)
+	std::map<S32, S32>::iterator iter = mSharedVerts.find(vert);
+	if (iter != mSharedVerts.end())
 	{
-		return &mSharedVerts[vert];
+		return &iter->second;
 	}
 	return NULL;
 }
@@ -758,6 +761,99 @@ LLPolyMesh::~LLPolyMesh()
 #else
 	delete [] mVertexData;
 #endif
+
+	if (!mDirtyNormalIndices.empty())
+	{
+		vector_replace_with_last(sDirtyNormalMeshes, this);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// beginMorphBatch()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::beginMorphBatch()
+{
+	sMorphBatchDepth++;
+}
+
+//-----------------------------------------------------------------------------
+// endMorphBatch()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::endMorphBatch()
+{
+	llassert(sMorphBatchDepth > 0);
+	if (--sMorphBatchDepth > 0)
+	{
+		return;
+	}
+
+	for (std::vector<LLPolyMesh*>::iterator iter = sDirtyNormalMeshes.begin();
+		 iter != sDirtyNormalMeshes.end(); ++iter)
+	{
+		LLPolyMesh* mesh = *iter;
+		mesh->updateNormals(&mesh->mDirtyNormalIndices[0], mesh->mDirtyNormalIndices.size());
+		mesh->mDirtyNormalIndices.clear();
+		std::fill(mesh->mDirtyNormalFlags.begin(), mesh->mDirtyNormalFlags.end(), 0);
+	}
+	sDirtyNormalMeshes.clear();
+}
+
+//-----------------------------------------------------------------------------
+// updateNormals()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::updateNormals(const U32 *vertex_indices, U32 num_indices)
+{
+	for (U32 i = 0; i < num_indices; i++)
+	{
+		U32 vert = vertex_indices[i];
+
+		// calculate new normals based on half angles
+		LLVector3 normalized_normal = mScaledNormals[vert];
+		normalized_normal.normVec();
+		mNormals[vert] = normalized_normal;
+
+		// calculate new binormals
+		LLVector3 tangent = mScaledBinormals[vert] % normalized_normal;
+		LLVector3 normalized_binormal = normalized_normal % tangent;
+		normalized_binormal.normVec();
+		mBinormals[vert] = normalized_binormal;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// markNormalsDirty()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::markNormalsDirty(const U32 *vertex_indices, U32 num_indices)
+{
+	if (num_indices == 0)
+	{
+		return;
+	}
+
+	if (!isMorphBatchActive())
+	{
+		updateNormals(vertex_indices, num_indices);
+		return;
+	}
+
+	if (mDirtyNormalIndices.empty())
+	{
+		sDirtyNormalMeshes.push_back(this);
+	}
+	if (mDirtyNormalFlags.empty())
+	{
+		mDirtyNormalFlags.resize(getNumVertices(), 0);
+	}
+
+	for (U32 i = 0; i < num_indices; i++)
+	{
+		U32 vert = vertex_indices[i];
+		if (!mDirtyNormalFlags[vert])
+		{
+			mDirtyNormalFlags[vert] = 1;
+			mDirtyNormalIndices.push_back(vert);
+		}
+	}
 }
 
 
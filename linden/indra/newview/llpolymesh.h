@@ -35,6 +35,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include "llstl.h"
 
 #include "v3math.h"
@@ -179,6 +180,14 @@ public:
 	// references to these objects.  Generally, upon exit of the application.
 	static void freeAllMeshes();
 
+	// Morph targets applied between beginMorphBatch() and endMorphBatch()
+	// only accumulate their deltas.  The normals and binormals of every
+	// vertex they touched are renormalized once per mesh when the outermost
+	// batch ends, instead of once per morph.
+	static void beginMorphBatch();
+	static void endMorphBatch();
+	static BOOL isMorphBatchActive() { return sMorphBatchDepth > 0; }
+
 	//--------------------------------------------------------------------
 	// Transform Data Access
 	//--------------------------------------------------------------------
@@ -258,6 +267,11 @@ public:
 	LLVector3 *getWritableBinormals();
 	LLVector3 *getScaledBinormals();
 
+	// Recomputes output normals and binormals from the scaled ones
+	void updateNormals(const U32 *vertex_indices, U32 num_indices);
+	// Defers updateNormals() for these vertices to the end of the morph batch
+	void markNormalsDirty(const U32 *vertex_indices, U32 num_indices);
+
 	// Get texCoords
 	const LLVector2	*getTexCoords() const { 
 		return mTexCoords; 
@@ -368,6 +382,13 @@ protected:
 
 	// Backlink only; don't make this an LLPointer.
 	LLVOAvatar* mAvatarp;
+
+	// vertices whose normals are pending renormalization, see markNormalsDirty()
+	std::vector<U32>		mDirtyNormalIndices;
+	std::vector<U8>			mDirtyNormalFlags;
+
+	static S32							sMorphBatchDepth;
+	static std::vector<LLPolyMesh*>		sDirtyNormalMeshes;
 };
 
 //-----------------------------------------------------------------------------
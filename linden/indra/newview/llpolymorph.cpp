@@ -44,6 +44,67 @@
 
 const F32 NORMAL_SOFTEN_FACTOR = 0.65f;
 
+//-----------------------------------------------------------------------------
+// LLPolyMeshFileBuffer()
+//-----------------------------------------------------------------------------
+LLPolyMeshFileBuffer::LLPolyMeshFileBuffer()
+:	mData(NULL),
+	mSize(0),
+	mPos(0)
+{
+}
+
+LLPolyMeshFileBuffer::~LLPolyMeshFileBuffer()
+{
+	delete [] mData;
+}
+
+//-----------------------------------------------------------------------------
+// load()
+//-----------------------------------------------------------------------------
+BOOL LLPolyMeshFileBuffer::load(const std::string& filename)
+{
+	delete [] mData;
+	mData = NULL;
+	mSize = mPos = 0;
+
+	LLFILE* fp = LLFile::fopen(filename, "rb");		/*Flawfinder: ignore*/
+	if (!fp)
+	{
+		return FALSE;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	long file_size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	BOOL success = FALSE;
+	if (file_size > 0)
+	{
+		mData = new U8[file_size];
+		mSize = fread(mData, 1, (size_t)file_size, fp);
+		success = (mSize == (size_t)file_size);
+	}
+	fclose(fp);
+
+	return success;
+}
+
+//-----------------------------------------------------------------------------
+// read()
+//-----------------------------------------------------------------------------
+size_t LLPolyMeshFileBuffer::read(void* dst, size_t size, size_t count)
+{
+	if (size == 0)
+	{
+		return 0;
+	}
+	count = llmin(count, (mSize - mPos) / size);
+	memcpy(dst, mData + mPos, size * count);		/*Flawfinder: ignore*/
+	mPos += size * count;
+	return count;
+}
+
 //-----------------------------------------------------------------------------
 // LLPolyMorphData()
 //-----------------------------------------------------------------------------
@@ -79,12 +140,12 @@ LLPolyMorphData::~LLPolyMorphData()
 //-----------------------------------------------------------------------------
 // loadBinary()
 //-----------------------------------------------------------------------------
-BOOL LLPolyMorphData::loadBinary(LLFILE *fp, LLPolyMeshSharedData *mesh)
+BOOL LLPolyMorphData::loadBinary(LLPolyMeshFileBuffer& buffer, LLPolyMeshSharedData *mesh)
 {
 	S32 numVertices;
 	S32 numRead;
 
-	numRead = fread(&numVertices, sizeof(S32), 1, fp);
+	numRead = buffer.read(&numVertices, sizeof(S32), 1);
 	llendianswizzle(&numVertices, sizeof(S32), 1);
 	if (numRead != 1)
 	{
@@ -112,7 +173,7 @@ BOOL LLPolyMorphData::loadBinary(LLFILE *fp, LLPolyMeshSharedData *mesh)
 	//-------------------------------------------------------------------------
 	for(S32 v = 0; v < numVertices; v++)
 	{
-		numRead = fread(&mVertexIndices[v], sizeof(U32), 1, fp);
+		numRead = buffer.read(&mVertexIndices[v], sizeof(U32), 1);
 		llendianswizzle(&mVertexIndices[v], sizeof(U32), 1);
 		if (numRead != 1)
 		{
@@ -126,7 +187,7 @@ BOOL LLPolyMorphData::loadBinary(LLFILE *fp, LLPolyMeshSharedData *mesh)
 		}
 
 
-		numRead = fread(&mCoords[v].mV, sizeof(F32), 3, fp);
+		numRead = buffer.read(&mCoords[v].mV, sizeof(F32), 3);
 		llendianswizzle(&mCoords[v].mV, sizeof(F32), 3);
 		if (numRead != 3)
 		{
@@ -146,7 +207,7 @@ BOOL LLPolyMorphData::loadBinary(LLFILE *fp, LLPolyMeshSharedData *mesh)
 			mMaxDistortion = magnitude;
 		}
 
-		numRead = fread(&mNormals[v].mV, sizeof(F32), 3, fp);
+		numRead = buffer.read(&mNormals[v].mV, sizeof(F32), 3);
 		llendianswizzle(&mNormals[v].mV, sizeof(F32), 3);
 		if (numRead != 3)
 		{
@@ -154,7 +215,7 @@ BOOL LLPolyMorphData::loadBinary(LLFILE *fp, LLPolyMeshSharedData *mesh)
 			return FALSE;
 		}
 
-		numRead = fread(&mBinormals[v].mV, sizeof(F32), 3, fp);
+		numRead = buffer.read(&mBinormals[v].mV, sizeof(F32), 3);
 		llendianswizzle(&mBinormals[v].mV, sizeof(F32), 3);
 		if (numRead != 3)
 		{
@@ -163,7 +224,7 @@ BOOL LLPolyMorphData::loadBinary(LLFILE *fp, LLPolyMeshSharedData *mesh)
 		}
 
 
-		numRead = fread(&mTexCoords[v].mV, sizeof(F32), 2, fp);
+		numRead = buffer.read(&mTexCoords[v].mV, sizeof(F32), 2);
 		llendianswizzle(&mTexCoords[v].mV, sizeof(F32), 2);
 		if (numRead != 2)
 		{
@@ -456,16 +517,15 @@ void LLPolyMorphTarget::apply( ESex avatar_sex )
 		LLVector3 *coords = mMesh->getWritableCoords();
 
 		LLVector3 *scaled_normals = mMesh->getScaledNormals();
-		LLVector3 *normals = mMesh->getWritableNormals();
-
 		LLVector3 *scaled_binormals = mMesh->getScaledBinormals();
-		LLVector3 *binormals = mMesh->getWritableBinormals();
 
 		LLVector4 *clothing_weights = mMesh->getWritableClothingWeights();
 		LLVector2 *tex_coords = mMesh->getWritableTexCoords();
 
 		F32 *maskWeightArray = (mVertMask) ? mVertMask->getMorphMaskWeights() : NULL;
 
+		const BOOL apply_clothing = getInfo()->mIsClothingMorph && clothing_weights;
+
 		for(U32 vert_index_morph = 0; vert_index_morph < mMorphData->mNumIndices; vert_index_morph++)
 		{
 			S32 vert_index_mesh = mMorphData->mVertexIndices[vert_index_morph];
@@ -476,33 +536,27 @@ void LLPolyMorphTarget::apply( ESex avatar_sex )
 				maskWeight = maskWeightArray[vert_index_morph];
 			}
 
-			coords[vert_index_mesh] += mMorphData->mCoords[vert_index_morph] * delta_weight * maskWeight;
-			if (getInfo()->mIsClothingMorph && clothing_weights)
+			// keep the left to right products, regrouping the weights changes the rounding
+			LLVector3 coord_offset = mMorphData->mCoords[vert_index_morph] * delta_weight * maskWeight;
+			coords[vert_index_mesh] += coord_offset;
+			if (apply_clothing)
 			{
-				LLVector3 clothing_offset = mMorphData->mCoords[vert_index_morph] * delta_weight * maskWeight;
 				LLVector4* clothing_weight = &clothing_weights[vert_index_mesh];
-				clothing_weight->mV[VX] += clothing_offset.mV[VX];
-				clothing_weight->mV[VY] += clothing_offset.mV[VY];
-				clothing_weight->mV[VZ] += clothing_offset.mV[VZ];
+				clothing_weight->mV[VX] += coord_offset.mV[VX];
+				clothing_weight->mV[VY] += coord_offset.mV[VY];
+				clothing_weight->mV[VZ] += coord_offset.mV[VZ];
 				clothing_weight->mV[VW] = maskWeight;
 			}
 
-			// calculate new normals based on half angles
 			scaled_normals[vert_index_mesh] += mMorphData->mNormals[vert_index_morph] * delta_weight * maskWeight * NORMAL_SOFTEN_FACTOR;
-			LLVector3 normalized_normal = scaled_normals[vert_index_mesh];
-			normalized_normal.normVec();
-			normals[vert_index_mesh] = normalized_normal;
-
-			// calculate new binormals
 			scaled_binormals[vert_index_mesh] += mMorphData->mBinormals[vert_index_morph] * delta_weight * maskWeight * NORMAL_SOFTEN_FACTOR;
-			LLVector3 tangent = scaled_binormals[vert_index_mesh] % normalized_normal;
-			LLVector3 normalized_binormal = normalized_normal % tangent; 
-			normalized_binormal.normVec();
-			binormals[vert_index_mesh] = normalized_binormal;
 
 			tex_coords[vert_index_mesh] += mMorphData->mTexCoords[vert_index_morph] * delta_weight * maskWeight;
 		}
 
+		// renormalize now, or once for all morphs if a batch is running
+		mMesh->markNormalsDirty(mMorphData->mVertexIndices, mMorphData->mNumIndices);
+
 		// now apply volume changes
 		for( volume_list_t::iterator iter = mVolumeMorphs.begin(); iter != mVolumeMorphs.end(); iter++ )
 		{
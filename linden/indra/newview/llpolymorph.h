@@ -43,6 +43,29 @@ class LLVOAvatar;
 class LLVector2;
 class LLViewerJointCollisionVolume;
 
+//-----------------------------------------------------------------------------
+// LLPolyMeshFileBuffer
+// In-memory copy of a .llm mesh file, read with a single disk access.
+// read() has fread() semantics so the mesh and morph parsers stay as is.
+//-----------------------------------------------------------------------------
+class LLPolyMeshFileBuffer
+{
+public:
+	LLPolyMeshFileBuffer();
+	~LLPolyMeshFileBuffer();
+
+	BOOL	load(const std::string& filename);
+
+	// Copies up to count items of size bytes, returns the number of items copied
+	size_t	read(void* dst, size_t size, size_t count);
+	void	seek(size_t pos) { mPos = llmin(pos, mSize); }
+
+private:
+	U8*		mData;
+	size_t	mSize;
+	size_t	mPos;
+};
+
 //-----------------------------------------------------------------------------
 // LLPolyMorphData()
 //-----------------------------------------------------------------------------
@@ -52,7 +75,7 @@ public:
 	LLPolyMorphData(const std::string& morph_name);
 	~LLPolyMorphData();
 
-	BOOL			loadBinary(LLFILE* fp, LLPolyMeshSharedData *mesh);
+	BOOL			loadBinary(LLPolyMeshFileBuffer& buffer, LLPolyMeshSharedData *mesh);
 	const std::string& getName() { return mName; }
 
 public:
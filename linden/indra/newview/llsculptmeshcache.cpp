@@ -0,0 +1,594 @@
+/** 
+ * @file llsculptmeshcache.cpp
+ * @brief On-disk cache of sculpted volume meshes.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llsculptmeshcache.h"
+
+#include "lldir.h"
+#include "llvolume.h"
+#include "llviewercontrol.h"
+
+#include <algorithm>
+#include <ctime>
+
+// Bump when the file layout or the sculpt mesh generation changes; old
+// entries are then ignored and overwritten.
+static const U32 SCULPT_MESH_CACHE_VERSION = 1;
+static const char SCULPT_MESH_CACHE_MAGIC[4] = { 'L', 'L', 'S', 'M' };
+
+// Sculpt meshes are at most 64x64 points; anything bigger is corrupt.
+static const S32 MAX_SCULPT_MESH_POINTS = 64 * 64;
+
+// Eviction trims the folder to this fraction of the size limit so it
+// doesn't run again on the very next write.
+static const F32 SCULPT_MESH_CACHE_TRIM_RATIO = 0.75f;
+
+// Files are written under this suffix and renamed into place when complete
+static const std::string SCULPT_MESH_CACHE_TEMP_SUFFIX = ".tmp.slm";
+
+static bool is_temp_name(const std::string& name)
+{
+	return name.length() >= SCULPT_MESH_CACHE_TEMP_SUFFIX.length()
+		&& !name.compare(name.length() - SCULPT_MESH_CACHE_TEMP_SUFFIX.length(),
+						 SCULPT_MESH_CACHE_TEMP_SUFFIX.length(), SCULPT_MESH_CACHE_TEMP_SUFFIX);
+}
+
+//============================================================================
+// Everything below up to LLSculptMeshCache proper runs on the cache thread.
+
+class LLSculptMeshCache::CacheThread : public LLQueuedThread
+{
+public:
+	CacheThread(bool threaded, bool read_only)
+		: LLQueuedThread("sculptmeshcache", threaded),
+		  mReadOnly(read_only),
+		  mTotalSize(0),
+		  mMaxSize(0)
+	{
+	}
+
+	// MAIN THREAD
+	handle_t read(const std::string& name);
+	void write(const std::string& name, U16 sculpt_width, U16 sculpt_height,
+			   S32 sculpt_level, const std::vector<LLVector3>& points);
+	void scan(const std::string& dir_name, const std::vector<std::string>& names, S64 max_size);
+
+	// CACHE THREAD
+	// The index below is only touched from processRequest(), which the
+	// thread runs one request at a time.
+	struct Entry
+	{
+		S32 mSize;
+		time_t mLastUsed;
+	};
+	typedef std::map<std::string, Entry> entry_map_t;
+
+	std::string getPath(const std::string& name) const
+	{
+		return mDirName + gDirUtilp->getDirDelimiter() + name;
+	}
+	void addEntry(const std::string& name, S32 size, time_t last_used);
+	void removeEntry(const std::string& name);
+	void evict();
+
+	// Set in a second viewer instance, which leaves the folder to the first
+	const bool mReadOnly;
+	entry_map_t mEntries;
+	std::string mDirName;
+	S64 mTotalSize;
+	S64 mMaxSize;
+};
+
+class LLSculptMeshCache::ReadRequest : public LLQueuedThread::QueuedRequest
+{
+protected:
+	virtual ~ReadRequest() {} // use deleteRequest()
+
+public:
+	ReadRequest(LLQueuedThread::handle_t handle, CacheThread* thread, const std::string& name)
+		: LLQueuedThread::QueuedRequest(handle, LLQueuedThread::PRIORITY_NORMAL),
+		  mSculptWidth(0),
+		  mSculptHeight(0),
+		  mSculptLevel(-1),
+		  mThread(thread),
+		  mName(name)
+	{
+	}
+
+	/*virtual*/ bool processRequest();
+
+	U16 mSculptWidth;
+	U16 mSculptHeight;
+	S32 mSculptLevel;
+	std::vector<LLVector3> mPoints; // empty unless the read succeeded
+
+private:
+	CacheThread* mThread;
+	std::string mName;
+};
+
+bool LLSculptMeshCache::ReadRequest::processRequest()
+{
+	CacheThread::entry_map_t::iterator iter = mThread->mEntries.find(mName);
+	if (iter == mThread->mEntries.end())
+	{
+		return true; // evicted since the main thread last heard of it
+	}
+
+	std::string filename = mThread->getPath(mName);
+	LLFILE* fp = LLFile::fopen(filename, "rb");
+	if (!fp)
+	{
+		mThread->removeEntry(mName);
+		return true;
+	}
+
+	char magic[4];
+	U32 version = 0;
+	S32 num_points = 0;
+	bool valid = fread(magic, sizeof(magic), 1, fp) == 1
+		&& fread(&version, sizeof(version), 1, fp) == 1
+		&& fread(&mSculptWidth, sizeof(mSculptWidth), 1, fp) == 1
+		&& fread(&mSculptHeight, sizeof(mSculptHeight), 1, fp) == 1
+		&& fread(&mSculptLevel, sizeof(mSculptLevel), 1, fp) == 1
+		&& fread(&num_points, sizeof(num_points), 1, fp) == 1
+		&& !memcmp(magic, SCULPT_MESH_CACHE_MAGIC, sizeof(SCULPT_MESH_CACHE_MAGIC))
+		&& version == SCULPT_MESH_CACHE_VERSION
+		&& mSculptLevel >= 0
+		&& num_points > 0 && num_points <= MAX_SCULPT_MESH_POINTS;
+	if (valid)
+	{
+		mPoints.resize(num_points);
+		valid = fread(mPoints[0].mV, sizeof(F32) * 3, num_points, fp) == (size_t)num_points;
+	}
+	fclose(fp);
+
+	if (!valid)
+	{
+		mPoints.clear();
+		if (!mThread->mReadOnly)
+		{
+			LLFile::remove(filename);
+		}
+		mThread->removeEntry(mName);
+		return true;
+	}
+	iter->second.mLastUsed = time(NULL);
+	return true;
+}
+
+class LLSculptMeshCache::WriteRequest : public LLQueuedThread::QueuedRequest
+{
+protected:
+	virtual ~WriteRequest() {} // use deleteRequest()
+
+public:
+	WriteRequest(LLQueuedThread::handle_t handle, CacheThread* thread, const std::string& name,
+				 U16 sculpt_width, U16 sculpt_height, S32 sculpt_level,
+				 const std::vector<LLVector3>& points)
+		: LLQueuedThread::QueuedRequest(handle, LLQueuedThread::PRIORITY_LOW,
+										LLQueuedThread::FLAG_AUTO_COMPLETE),
+		  mThread(thread),
+		  mName(name),
+		  mSculptWidth(sculpt_width),
+		  mSculptHeight(sculpt_height),
+		  mSculptLevel(sculpt_level),
+		  mPoints(points)
+	{
+	}
+
+	/*virtual*/ bool processRequest();
+
+private:
+	CacheThread* mThread;
+	std::string mName;
+	U16 mSculptWidth;
+	U16 mSculptHeight;
+	S32 mSculptLevel;
+	std::vector<LLVector3> mPoints;
+};
+
+bool LLSculptMeshCache::WriteRequest::processRequest()
+{
+	if (mThread->mEntries.find(mName) != mThread->mEntries.end())
+	{
+		return true; // same sculpt map, same mesh
+	}
+
+	// Written aside and renamed into place, so that a second viewer
+	// instance reading the folder never sees a partial file.
+	std::string filename = mThread->getPath(mName);
+	std::string temp_filename = filename.substr(0, filename.length() - 4) + SCULPT_MESH_CACHE_TEMP_SUFFIX;
+	LLFILE* fp = LLFile::fopen(temp_filename, "wb");
+	if (!fp)
+	{
+		return true;
+	}
+	U32 version = SCULPT_MESH_CACHE_VERSION;
+	S32 num_points = (S32)mPoints.size();
+	bool written = fwrite(SCULPT_MESH_CACHE_MAGIC, sizeof(SCULPT_MESH_CACHE_MAGIC), 1, fp) == 1
+		&& fwrite(&version, sizeof(version), 1, fp) == 1
+		&& fwrite(&mSculptWidth, sizeof(mSculptWidth), 1, fp) == 1
+		&& fwrite(&mSculptHeight, sizeof(mSculptHeight), 1, fp) == 1
+		&& fwrite(&mSculptLevel, sizeof(mSculptLevel), 1, fp) == 1
+		&& fwrite(&num_points, sizeof(num_points), 1, fp) == 1
+		&& fwrite(mPoints[0].mV, sizeof(F32) * 3, num_points, fp) == (size_t)num_points;
+	S32 size = (S32)ftell(fp);
+	fclose(fp);
+	LLFile::remove(filename);
+	if (!written || LLFile::rename(temp_filename, filename))
+	{
+		llwarns << "Unable to write sculpt mesh cache file " << filename << llendl;
+		LLFile::remove(temp_filename);
+		return true;
+	}
+
+	mThread->addEntry(mName, size, time(NULL));
+	mThread->evict();
+	return true;
+}
+
+// Takes over the folder the main thread listed, picking up the size and
+// age of every file for eviction.
+class LLSculptMeshCache::ScanRequest : public LLQueuedThread::QueuedRequest
+{
+protected:
+	virtual ~ScanRequest() {} // use deleteRequest()
+
+public:
+	ScanRequest(LLQueuedThread::handle_t handle, CacheThread* thread, const std::string& dir_name,
+				const std::vector<std::string>& names, S64 max_size)
+		: LLQueuedThread::QueuedRequest(handle, LLQueuedThread::PRIORITY_HIGH,
+										LLQueuedThread::FLAG_AUTO_COMPLETE),
+		  mThread(thread),
+		  mDirName(dir_name),
+		  mNames(names),
+		  mMaxSize(max_size)
+	{
+	}
+
+	/*virtual*/ bool processRequest();
+
+private:
+	CacheThread* mThread;
+	std::string mDirName;
+	std::vector<std::string> mNames;
+	S64 mMaxSize;
+};
+
+bool LLSculptMeshCache::ScanRequest::processRequest()
+{
+	mThread->mEntries.clear();
+	mThread->mTotalSize = 0;
+	mThread->mDirName = mDirName;
+	mThread->mMaxSize = mMaxSize;
+
+	for (std::vector<std::string>::iterator iter = mNames.begin();
+		 iter != mNames.end(); ++iter)
+	{
+		if (is_temp_name(*iter))
+		{
+			// left over from an interrupted write
+			if (!mThread->mReadOnly)
+			{
+				LLFile::remove(mThread->getPath(*iter));
+			}
+			continue;
+		}
+		llstat stat_data;
+		if (!LLFile::stat(mThread->getPath(*iter), &stat_data))
+		{
+			mThread->addEntry(*iter, (S32)stat_data.st_size, stat_data.st_mtime);
+		}
+	}
+	mThread->evict();
+	return true;
+}
+
+LLQueuedThread::handle_t LLSculptMeshCache::CacheThread::read(const std::string& name)
+{
+	if (isQuitting())
+	{
+		return nullHandle();
+	}
+	handle_t handle = generateHandle();
+	llverify(addRequest(new ReadRequest(handle, this, name)));
+	return handle;
+}
+
+void LLSculptMeshCache::CacheThread::write(const std::string& name, U16 sculpt_width, U16 sculpt_height,
+										   S32 sculpt_level, const std::vector<LLVector3>& points)
+{
+	if (!isQuitting())
+	{
+		llverify(addRequest(new WriteRequest(generateHandle(), this, name,
+											 sculpt_width, sculpt_height, sculpt_level, points)));
+	}
+}
+
+void LLSculptMeshCache::CacheThread::scan(const std::string& dir_name, const std::vector<std::string>& names,
+										  S64 max_size)
+{
+	if (!isQuitting())
+	{
+		llverify(addRequest(new ScanRequest(generateHandle(), this, dir_name, names, max_size)));
+	}
+}
+
+void LLSculptMeshCache::CacheThread::addEntry(const std::string& name, S32 size, time_t last_used)
+{
+	Entry& entry = mEntries[name];
+	entry.mSize = size;
+	entry.mLastUsed = last_used;
+	mTotalSize += size;
+}
+
+void LLSculptMeshCache::CacheThread::removeEntry(const std::string& name)
+{
+	entry_map_t::iterator iter = mEntries.find(name);
+	if (iter != mEntries.end())
+	{
+		mTotalSize -= iter->second.mSize;
+		mEntries.erase(iter);
+	}
+}
+
+void LLSculptMeshCache::CacheThread::evict()
+{
+	if (mReadOnly || mTotalSize <= mMaxSize)
+	{
+		return;
+	}
+
+	typedef std::pair<time_t, std::string> age_pair_t;
+	std::vector<age_pair_t> ages;
+	ages.reserve(mEntries.size());
+	for (entry_map_t::iterator iter = mEntries.begin(); iter != mEntries.end(); ++iter)
+	{
+		ages.push_back(age_pair_t(iter->second.mLastUsed, iter->first));
+	}
+	std::sort(ages.begin(), ages.end());
+
+	S64 target_size = (S64)(mMaxSize * SCULPT_MESH_CACHE_TRIM_RATIO);
+	S32 evicted = 0;
+	for (std::vector<age_pair_t>::iterator iter = ages.begin();
+		 iter != ages.end() && mTotalSize > target_size; ++iter)
+	{
+		LLFile::remove(getPath(iter->second));
+		removeEntry(iter->second);
+		++evicted;
+	}
+	LL_DEBUGS("SculptMeshCache") << "Evicted " << evicted << " sculpt meshes, "
+								 << mTotalSize << " bytes left" << LL_ENDL;
+}
+
+//============================================================================
+
+LLSculptMeshCache::pending_load_map_t LLSculptMeshCache::sPendingLoads;
+std::set<std::string> LLSculptMeshCache::sEntries;
+LLSculptMeshCache::CacheThread* LLSculptMeshCache::sThread = NULL;
+bool LLSculptMeshCache::sEnabled = false;
+bool LLSculptMeshCache::sReadOnly = false;
+
+//static
+void LLSculptMeshCache::startThread(bool threaded, bool read_only)
+{
+	if (!sThread)
+	{
+		sReadOnly = read_only;
+		sThread = new CacheThread(threaded, read_only);
+	}
+}
+
+//static
+S32 LLSculptMeshCache::update(U32 max_time_ms)
+{
+	return sThread ? sThread->update(max_time_ms) : 0;
+}
+
+//static
+void LLSculptMeshCache::pause()
+{
+	if (sThread)
+	{
+		sThread->pause();
+	}
+}
+
+//static
+void LLSculptMeshCache::cleanupClass()
+{
+	sEnabled = false;
+	sPendingLoads.clear();
+	sEntries.clear();
+	if (sThread)
+	{
+		sThread->shutdown();
+		delete sThread;
+		sThread = NULL;
+	}
+}
+
+//static
+void LLSculptMeshCache::initClass()
+{
+	sEnabled = sThread != NULL;
+	if (!sEnabled)
+	{
+		return;
+	}
+
+	std::string dir_name = getDirName();
+	if (!sReadOnly)
+	{
+		LLFile::mkdir(dir_name);
+	}
+
+	// Listing the folder is left on this thread, gDirUtilp keeps the
+	// directory being walked as state. The files themselves aren't opened.
+	std::vector<std::string> names;
+	std::string name;
+	std::string mask = gDirUtilp->getDirDelimiter() + "*.slm";
+	sEntries.clear();
+	while (gDirUtilp->getNextFileInDir(dir_name, mask, name, FALSE))
+	{
+		names.push_back(name);
+		if (!is_temp_name(name))
+		{
+			sEntries.insert(name);
+		}
+	}
+
+	S64 max_size = (S64)gSavedSettings.getU32("SculptMeshCacheSize") * 1024 * 1024;
+	sThread->scan(dir_name, names, max_size);
+}
+
+//static
+std::string LLSculptMeshCache::getDirName()
+{
+	return gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "sculptmeshes");
+}
+
+//static
+std::string LLSculptMeshCache::getFilename(const LLVolume* volumep)
+{
+	const LLVolumeParams& params = volumep->getParams();
+	return llformat("%s_%d_%d.slm", params.getSculptID().asString().c_str(),
+					(S32)params.getSculptType(), llround(volumep->getDetail() * 10.f));
+}
+
+//static
+bool LLSculptMeshCache::requestLoad(LLVolume* volumep)
+{
+	if (!sEnabled || volumep->getParams().getSculptID().isNull())
+	{
+		return false;
+	}
+	if (sPendingLoads.find(volumep) != sPendingLoads.end())
+	{
+		return true;
+	}
+
+	std::string name = getFilename(volumep);
+	if (sEntries.find(name) == sEntries.end())
+	{
+		return false;
+	}
+
+	LLQueuedThread::handle_t handle = sThread->read(name);
+	if (handle == LLQueuedThread::nullHandle())
+	{
+		return false;
+	}
+	PendingLoad& load = sPendingLoads[volumep];
+	load.mVolume = volumep;
+	load.mHandle = handle;
+	return true;
+}
+
+//static
+void LLSculptMeshCache::updateLoads(std::vector<LLPointer<LLVolume> >& loaded)
+{
+	for (pending_load_map_t::iterator iter = sPendingLoads.begin();
+		 iter != sPendingLoads.end(); )
+	{
+		pending_load_map_t::iterator cur = iter++;
+		PendingLoad& load = cur->second;
+		LLQueuedThread::status_t status = sThread->getRequestStatus(load.mHandle);
+		if (status == LLQueuedThread::STATUS_QUEUED || status == LLQueuedThread::STATUS_INPROGRESS)
+		{
+			continue;
+		}
+
+		bool applied = false;
+		if (status == LLQueuedThread::STATUS_COMPLETE)
+		{
+			ReadRequest* req = (ReadRequest*)sThread->getRequest(load.mHandle);
+			// a map build may have landed first
+			if (!req->mPoints.empty() && load.mVolume->getSculptLevel() < 0)
+			{
+				applied = load.mVolume->sculptFromMesh(req->mSculptWidth, req->mSculptHeight,
+													   &req->mPoints[0], (S32)req->mPoints.size(),
+													   req->mSculptLevel);
+			}
+		}
+		if (!applied)
+		{
+			// don't ask again, the volume falls back to its sculpt map
+			sEntries.erase(getFilename(load.mVolume));
+		}
+		sThread->completeRequest(load.mHandle);
+		loaded.push_back(load.mVolume);
+		sPendingLoads.erase(cur);
+	}
+}
+
+//static
+void LLSculptMeshCache::save(const LLVolume* volumep)
+{
+	// only the full resolution mesh is final; lower discards are replaced
+	// as soon as the rest of the map arrives
+	if (!sEnabled || sReadOnly || volumep->getSculptLevel() != 0)
+	{
+		return;
+	}
+
+	std::string name = getFilename(volumep);
+	if (sEntries.find(name) != sEntries.end())
+	{
+		return;
+	}
+
+	const std::vector<LLVolume::Point>& mesh = volumep->getMesh();
+	if (mesh.empty() || (S32)mesh.size() > MAX_SCULPT_MESH_POINTS)
+	{
+		return;
+	}
+
+	std::vector<LLVector3> points(mesh.size());
+	for (U32 i = 0; i < mesh.size(); i++)
+	{
+		points[i] = mesh[i].mPos;
+	}
+	sThread->write(name, volumep->getSculptWidth(), volumep->getSculptHeight(),
+				   volumep->getSculptLevel(), points);
+	sEntries.insert(name);
+}
+
+//static
+void LLSculptMeshCache::purge()
+{
+	std::string mask = gDirUtilp->getDirDelimiter() + "*.slm";
+	gDirUtilp->deleteFilesInDir(getDirName(), mask);
+	sEntries.clear();
+}
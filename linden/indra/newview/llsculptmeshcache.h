@@ -0,0 +1,105 @@
+/** 
+ * @file llsculptmeshcache.h
+ * @brief On-disk cache of sculpted volume meshes.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSCULPTMESHCACHE_H
+#define LL_LLSCULPTMESHCACHE_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "llmemory.h"
+#include "llqueuedthread.h"
+
+class LLVolume;
+
+// Keeps the vertex grid of every sculpt built from its full resolution
+// map, keyed by sculpt texture, sculpt type and detail. A sculpted volume
+// that comes back into view is rebuilt from this instead of from its
+// sculpt map. The files are only ever touched on the cache's own thread;
+// the folder is kept under SculptMeshCacheSize by dropping the least
+// recently used meshes.
+class LLSculptMeshCache
+{
+public:
+	// Creates the thread the cache files are read and written on. Like the
+	// other queued threads it is driven by update() from the main loop.
+	// A read only cache, as in a second viewer instance, never writes nor
+	// evicts.
+	static void startThread(bool threaded, bool read_only);
+	static S32 update(U32 max_time_ms);
+	static void pause();
+	static void cleanupClass();
+
+	// Indexes the cache folder. Call once the cache location is final.
+	static void initClass();
+
+	// Starts reading the cached mesh of volumep. Returns true while that
+	// read is outstanding; the volume keeps its placeholder until
+	// updateLoads() hands it back.
+	static bool requestLoad(LLVolume* volumep);
+	// Applies the reads that finished and returns their volumes, whether
+	// or not the cache had a usable mesh for them.
+	static void updateLoads(std::vector<LLPointer<LLVolume> >& loaded);
+	// Queues the mesh of volumep for writing if it was built from the full
+	// resolution sculpt map and isn't cached yet
+	static void save(const LLVolume* volumep);
+	static void purge();
+
+private:
+	static std::string getDirName();
+	static std::string getFilename(const LLVolume* volumep);
+
+	class ReadRequest;
+	class WriteRequest;
+	class ScanRequest;
+	class CacheThread;
+
+	struct PendingLoad
+	{
+		LLPointer<LLVolume> mVolume;
+		LLQueuedThread::handle_t mHandle;
+	};
+	typedef std::map<const LLVolume*, PendingLoad> pending_load_map_t;
+	static pending_load_map_t sPendingLoads;
+
+	// Files the main thread believes are cached. An entry evicted on the
+	// cache thread stays here until a read for it comes back empty.
+	static std::set<std::string> sEntries;
+
+	static CacheThread* sThread;
+	static bool sEnabled;
+	static bool sReadOnly;
+};
+
+#endif // LL_LLSCULPTMESHCACHE_H
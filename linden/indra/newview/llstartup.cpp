@@ -254,6 +254,8 @@ EStartupState LLStartUp::gStartupState = STATE_FIRST;
 bool LLStartUp::mStartedOnce = false;
 bool LLStartUp::mShouldAutoLogin = false;
 bool LLStartUp::sLoginFailed = false;
+F32 LLStartUp::sStateSeconds[STATE_STARTED + 1];
+LLTimer LLStartUp::sStateTimer;
 
 //
 // local function declaration
@@ -1970,6 +1972,13 @@ bool idle_startup()
 		// We should have an agent id by this point.
 		llassert(!(gAgentID == LLUUID::null));
 
+		// Parse the inventory cache on a worker thread while the world
+		// comes up; STATE_INVENTORY_SEND picks it up.
+		if (gSavedSettings.getBOOL("PreloadInventoryCache"))
+		{
+			gInventory.startCachePreload(gAgentID);
+		}
+
 		// Finish agent initialization.  (Requires gSavedSettings, builds camera)
 		gAgent.init();
 		set_underclothes_menu_options();
@@ -2149,6 +2158,8 @@ bool idle_startup()
 			// Start cache in not-running state until we figure out if we have
 			// capabilities for display name lookup
 			LLAvatarNameCache::initClass(false);
+			LLAvatarNameCache::setRequestBatching(gSavedSettings.getU32("AvatarNameRequestBatchSize"),
+												  gSavedSettings.getF32("AvatarNameRequestMaxLatency"));
 			LLAvatarNameCache::setUseDisplayNames(gSavedSettings.getU32("DisplayNamesUsage"));
 			LLAvatarName::sOmitResidentAsLastName = (bool)gSavedSettings.getBOOL("OmitResidentAsLastName");
 		}
@@ -3791,7 +3802,52 @@ void LLStartUp::setStartupState( EStartupState state )
 	LL_INFOS("AppInit") << "Startup state changing from " <<  
 		startupStateToString(gStartupState) << " to " <<  
 		startupStateToString(state) << LL_ENDL;
+
+	if (gStartupState <= STATE_STARTED)
+	{
+		sStateSeconds[gStartupState] += sStateTimer.getElapsedTimeAndResetF32();
+	}
 	gStartupState = state;
+
+	if (STATE_STARTED == state)
+	{
+		saveStartupTimeline();
+	}
+}
+
+// Logs how long each startup state took and appends the same table to
+// startup_timeline.log, so slow phases can be compared across logins.
+// static
+void LLStartUp::saveStartupTimeline()
+{
+	std::ostringstream timeline;
+	F32 total = 0.f;
+	F32 waiting = 0.f;
+	for (S32 i = STATE_FIRST; i < STATE_STARTED; ++i)
+	{
+		EStartupState state = (EStartupState)i;
+		timeline << llformat("%-30s %8.3f\n", startupStateToString(state).c_str(), sStateSeconds[i]);
+		total += sStateSeconds[i];
+		// time spent on the login screen and in dialogs is the user's, not ours
+		if (STATE_LOGIN_WAIT == state || STATE_LECTURE_PRIVACY == state ||
+			STATE_LOGIN_VOICE_LICENSE == state || STATE_UPDATE_CHECK == state)
+		{
+			waiting += sStateSeconds[i];
+		}
+		sStateSeconds[i] = 0.f;
+	}
+	timeline << llformat("%-30s %8.3f\n", "total", total);
+	timeline << llformat("%-30s %8.3f\n", "total excluding user input", total - waiting);
+
+	LL_INFOS("AppInit") << "Startup timeline (seconds):\n" << timeline.str() << LL_ENDL;
+
+	std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "startup_timeline.log");
+	llofstream file(filename, std::ios::out | std::ios::app);
+	if (file.is_open())
+	{
+		file << LLDate::now().asString() << "\n" << timeline.str() << "\n";
+		file.close();
+	}
 }
 
 
@@ -34,6 +34,7 @@
 #define LL_LLSTARTUP_H
 
 #include "llimagegl.h"
+#include "lltimer.h"
 
 // functions
 bool idle_startup();
@@ -129,7 +130,12 @@ private:
 	// For failed logins before mStartedOnce can be changed -- MC
 	static bool sLoginFailed;
 	static std::string startupStateToString(EStartupState state);
+	static void saveStartupTimeline();
 	static EStartupState gStartupState; // Do not set directly, use LLStartup::setStartupState
+
+	// seconds spent in each state, reported once STATE_STARTED is reached
+	static F32 sStateSeconds[STATE_STARTED + 1];
+	static LLTimer sStateTimer;
 };
 
 
@@ -56,6 +56,9 @@
 #include "v4coloru.h"
 #include "llrender.h"
 #include "llassetuploadresponders.h"
+#include "llappviewer.h"
+#include "llimageworker.h"
+#include "llv4math.h"
 
 //#include "../tools/imdebug/imdebug.h"
 
@@ -66,6 +69,36 @@ const S32 MAX_BAKE_UPLOAD_ATTEMPTS = 4;
 // static
 S32 LLTexLayerSetBuffer::sGLByteCount = 0;
 
+//-----------------------------------------------------------------------------
+// multiply_alpha_mask()
+// data[i] = data[i] * (mask[i] + 1) >> 8, sixteen bytes at a time where SSE2
+// is available.  Both paths give identical results.
+//-----------------------------------------------------------------------------
+static void multiply_alpha_mask(U8* data, const U8* mask, S32 count)
+{
+	S32 i = 0;
+#if LL_VECTORIZE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi16(1);
+	for ( ; i + 16 <= count; i += 16)
+	{
+		__m128i d = _mm_loadu_si128((const __m128i*)(data + i));
+		__m128i m = _mm_loadu_si128((const __m128i*)(mask + i));
+		__m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_add_epi16(_mm_unpacklo_epi8(m, zero), one));
+		__m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_add_epi16(_mm_unpackhi_epi8(m, zero), one));
+		lo = _mm_srli_epi16(lo, 8);
+		hi = _mm_srli_epi16(hi, 8);
+		_mm_storeu_si128((__m128i*)(data + i), _mm_packus_epi16(lo, hi));
+	}
+#endif
+	for ( ; i < count; i++)
+	{
+		U16 result = data[i];
+		result *= (mask[i] + 1);
+		data[i] = (U8)(result >> 8);
+	}
+}
+
 //-----------------------------------------------------------------------------
 // LLBakedUploadData()
 //-----------------------------------------------------------------------------
@@ -89,6 +122,33 @@ LLBakedUploadData::LLBakedUploadData( LLVOAvatar* avatar,
 	}
 }
 
+//-----------------------------------------------------------------------------
+// LLBakedEncodeResponder
+// Hands a baked texture encoded on the image encode thread back to its buffer.
+// Holds ids rather than pointers; the avatar and its layer sets can be gone
+// by the time the encode finishes.
+//-----------------------------------------------------------------------------
+class LLBakedEncodeResponder : public LLImageEncodeThread::Responder
+{
+public:
+	LLBakedEncodeResponder(const LLUUID& avatar_id, EBakedTextureIndex baked_index, const LLTransactionID& tid)
+		: mAvatarID(avatar_id),
+		  mBakedIndex(baked_index),
+		  mTransactionID(tid)
+	{
+	}
+
+	virtual void completed(bool success, LLImageJ2C* image)
+	{
+		LLTexLayerSetBuffer::onBakedImageEncoded(mAvatarID, mBakedIndex, mTransactionID, image, success);
+	}
+
+private:
+	LLUUID mAvatarID;
+	EBakedTextureIndex mBakedIndex;
+	LLTransactionID mTransactionID;
+};
+
 //-----------------------------------------------------------------------------
 // LLTexLayerSetBuffer
 // The composite image that a LLTexLayerSet writes to.  Each LLTexLayerSet has one.
@@ -100,6 +160,7 @@ LLTexLayerSetBuffer::LLTexLayerSetBuffer(LLTexLayerSet* owner, S32 width, S32 he
 	mNeedsUpdate( TRUE ),
 	mNeedsUpload( FALSE ),
 	mUploadPending( FALSE ), // Not used for any logic here, just to sync sending of updates
+	mEncodeStale( FALSE ),
 	mUploadFailCount( 0 ),
 	mUploadAfter( 0 ),
 	mTexLayerSet( owner )	
@@ -147,6 +208,7 @@ void LLTexLayerSetBuffer::requestUpdate()
 	// If we're in the middle of uploading a baked texture, we don't care about it any more.
 	// When it's downloaded, ignore it.
 	mUploadID.setNull();
+	mEncodeStale = mEncodeID.notNull();
 }
 
 void LLTexLayerSetBuffer::requestUpload()
@@ -178,12 +240,13 @@ void LLTexLayerSetBuffer::cancelUpload()
 	}
 	mUploadPending = FALSE;
 	mUploadAfter = 0;
+	mEncodeStale = mEncodeID.notNull();
 }
 
 // do we need to upload, and do we have sufficient data to create an uploadable composite?
 BOOL LLTexLayerSetBuffer::needsUploadNow() const
 {
-	BOOL upload = mNeedsUpload && mTexLayerSet->isLocalTextureDataFinal() && (gAgent.mNumPendingQueries == 0);
+	BOOL upload = mNeedsUpload && mEncodeID.isNull() && mTexLayerSet->isLocalTextureDataFinal() && (gAgent.mNumPendingQueries == 0);
 	return (upload && (LLFrameTimer::getTotalTime() > mUploadAfter));
 }
 
@@ -356,29 +419,91 @@ void LLTexLayerSetBuffer::readBackAndUpload()
 	U8* baked_image_data = baked_image->getData();
 	
 	comment_text = LINDEN_J2C_COMMENT_PREFIX "RGBHM"; // 5 channels: rgb, heightfield/alpha, mask
-	S32 i = 0;
-	for (S32 u = 0; u < mWidth; u++)
+	const S32 num_pixels = mWidth * mHeight;
+	const U8* color_ptr = baked_color_data;
+	U8* image_ptr = baked_image_data;
+	for (S32 i = 0; i < num_pixels; i++)
 	{
-		for (S32 v = 0; v < mHeight; v++)
-		{
-			baked_image_data[5 * i + 0] = baked_color_data[4 * i + 0];
-			baked_image_data[5 * i + 1] = baked_color_data[4 * i + 1];
-			baked_image_data[5 * i + 2] = baked_color_data[4 * i + 2];
-			baked_image_data[5 * i + 3] = baked_color_data[4 * i + 3]; // alpha should be correct for eyelashes.
-			baked_image_data[5 * i + 4] = baked_mask_data[i];
-			i++;
-		}
+		// rgba copied as is, alpha should be correct for eyelashes.
+		image_ptr[0] = color_ptr[0];
+		image_ptr[1] = color_ptr[1];
+		image_ptr[2] = color_ptr[2];
+		image_ptr[3] = color_ptr[3];
+		image_ptr[4] = baked_mask_data[i];
+		color_ptr += 4;
+		image_ptr += 5;
 	}
+
+	delete [] baked_color_data;
 	
 	LLPointer<LLImageJ2C> compressedImage = new LLImageJ2C;
 	compressedImage->setRate(0.f);
 	LLTransactionID tid;
-	LLAssetID asset_id;
 	tid.generate();
-	asset_id = tid.makeAssetID(gAgent.getSecureSessionID());
+
+	LLImageEncodeThread* encode_thread = LLAppViewer::getImageEncodeThread();
+	if (encode_thread)
+	{
+		// Encode off the main thread, onBakedImageEncoded() continues the upload
+		mEncodeID = tid.makeAssetID(gAgent.getSecureSessionID());
+		mEncodeStale = FALSE;
+		LLImageEncodeThread::handle_t handle =
+			encode_thread->encodeImage(baked_image, compressedImage, comment_text, LLQueuedThread::PRIORITY_HIGH,
+									   new LLBakedEncodeResponder(mTexLayerSet->getAvatar()->getID(),
+																  mTexLayerSet->getBakedTexIndex(), tid));
+		if (handle == LLImageEncodeThread::nullHandle())
+		{
+			// shutting down, the bake is dropped
+			mEncodeID.setNull();
+		}
+	}
+	else
+	{
+		uploadBakedImage(compressedImage, tid, compressedImage->encode(baked_image, comment_text));
+	}
+}
+
+// static
+void LLTexLayerSetBuffer::onBakedImageEncoded(const LLUUID& avatar_id, EBakedTextureIndex baked_index,
+											  const LLTransactionID& tid, LLImageJ2C* image, BOOL success)
+{
+	// Look the layer set up again, the one that asked may have been deleted
+	LLVOAvatar* self = gAgent.getAvatarObject();
+	if (!self || self->isDead() || self->getID() != avatar_id)
+	{
+		return;
+	}
+	const LLVOAvatarDictionary::BakedDictionaryEntry* baked_dict =
+		LLVOAvatarDictionary::getInstance()->getBakedTexture(baked_index);
+	LLTexLayerSet* layerset = baked_dict ? self->getLayerSet(baked_dict->mTextureIndex) : NULL;
+	if (!layerset || !layerset->hasComposite())
+	{
+		return;
+	}
+
+	LLTexLayerSetBuffer* layerset_buffer = layerset->getComposite();
+	if (layerset_buffer->mEncodeID != tid.makeAssetID(gAgent.getSecureSessionID()))
+	{
+		// Not this buffer's encode
+		return;
+	}
+	layerset_buffer->mEncodeID.setNull();
+
+	if (layerset_buffer->mEncodeStale)
+	{
+		// Rebaked or canceled while encoding, the next bake will upload
+		layerset_buffer->mEncodeStale = FALSE;
+		return;
+	}
+	layerset_buffer->uploadBakedImage(image, tid, success);
+}
+
+void LLTexLayerSetBuffer::uploadBakedImage(LLImageJ2C* compressedImage, const LLTransactionID& tid, BOOL encoded)
+{
+	LLAssetID asset_id = tid.makeAssetID(gAgent.getSecureSessionID());
 
 	BOOL res = false;
-	if( compressedImage->encode(baked_image, comment_text))
+	if (encoded)
 	{
 		res = LLVFile::writeFile(compressedImage->getData(), compressedImage->getDataSize(),
 								 gVFS, asset_id, LLAssetType::AT_TEXTURE);
@@ -446,8 +571,6 @@ void LLTexLayerSetBuffer::readBackAndUpload()
 		mUploadPending = FALSE;
 		llinfos << "unable to create baked upload file" << llendl;
 	}
-
-	delete [] baked_color_data;
 }
 
 
@@ -929,14 +1052,7 @@ void LLTexLayerSet::gatherAlphaMasks(U8 *data, S32 width, S32 height)
 		}
 		if (alphaData)
 		{
-			for( S32 i = 0; i < size; i++ )
-			{
-				U8 curAlpha = data[i];
-				U16 resultAlpha = curAlpha;
-				resultAlpha *= (alphaData[i] + 1);
-				resultAlpha = resultAlpha >> 8;
-				data[i] = (U8)resultAlpha;
-			}
+			multiply_alpha_mask(data, alphaData, size);
 		}
 	}
 	
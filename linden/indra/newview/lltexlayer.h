@@ -58,6 +58,7 @@ class LLTexLayerParamAlpha;
 class LLTexParamColorInfo;
 class LLTexParamColor;
 class LLPolyMesh;
+class LLImageJ2C;
 class LLXmlTreeNode;
 class LLImageRaw;
 class LLPolyMorphTarget;
@@ -227,6 +228,11 @@ public:
 	static void				onTextureUploadComplete( const LLUUID& uuid,
 													 void* userdata,
 													 S32 result, LLExtStat ext_status);
+	static void				onBakedImageEncoded( const LLUUID& avatar_id,
+												 LLVOAvatarDefines::EBakedTextureIndex baked_index,
+												 const LLTransactionID& tid,
+												 LLImageJ2C* image,
+												 BOOL success );
 	static void				dumpTotalByteCount();
 
 	virtual void restoreGLTexture() ;
@@ -236,12 +242,15 @@ private:
 	void					pushProjection();
 	void					popProjection();
 	BOOL					needsUploadNow() const;
+	void					uploadBakedImage(LLImageJ2C* compressedImage, const LLTransactionID& tid, BOOL encoded);
 
 private:
 	BOOL					mNeedsUpdate;
 	BOOL					mNeedsUpload;
 	BOOL					mUploadPending;
 	LLUUID					mUploadID;		// Identifys the current upload process (null if none).  Used to avoid overlaps (eg, when the user rapidly makes two changes outside of Face Edit)
+	LLUUID					mEncodeID;		// Asset id of the bake being encoded on the image encode thread (null if none)
+	BOOL					mEncodeStale;	// The bake being encoded was superseded or canceled, drop it when done
 	S32						mUploadFailCount;
 	U64						mUploadAfter;	// delay upload until after this time (in microseconds)
 	LLTexLayerSet*			mTexLayerSet;
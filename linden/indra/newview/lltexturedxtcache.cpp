@@ -0,0 +1,675 @@
+/** 
+ * @file lltexturedxtcache.cpp
+ * @brief On-disk cache of block compressed textures.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "lltexturedxtcache.h"
+
+#include "lldir.h"
+#include "llgl.h"
+#include "llimage.h"
+#include "llviewercontrol.h"
+
+#include <algorithm>
+#include <ctime>
+
+// Bump when the file layout or the compressor changes; old entries are
+// then ignored and overwritten.
+static const U32 TEXTURE_DXT_CACHE_VERSION = 1;
+static const char TEXTURE_DXT_CACHE_MAGIC[4] = { 'L', 'L', 'T', 'D' };
+static const std::string TEXTURE_DXT_CACHE_EXTENSION = ".dxc";
+
+// Eviction trims the folder to this fraction of the size limit so it
+// doesn't run again on the very next write.
+static const F32 TEXTURE_DXT_CACHE_TRIM_RATIO = 0.75f;
+
+// Returns false if the header read from fp is short or stale
+static bool read_header(LLFILE* fp, S32& discard, S32& data_size)
+{
+	char magic[4];
+	U32 version = 0;
+	return fread(magic, sizeof(magic), 1, fp) == 1
+		&& fread(&version, sizeof(version), 1, fp) == 1
+		&& fread(&discard, sizeof(discard), 1, fp) == 1
+		&& fread(&data_size, sizeof(data_size), 1, fp) == 1
+		&& !memcmp(magic, TEXTURE_DXT_CACHE_MAGIC, sizeof(TEXTURE_DXT_CACHE_MAGIC))
+		&& version == TEXTURE_DXT_CACHE_VERSION
+		&& discard >= 0 && discard <= MAX_DISCARD_LEVEL
+		&& data_size > (S32)sizeof(LLImageDXT::dxtfile_header_t)
+		&& data_size <= MAX_IMAGE_AREA;
+}
+
+//============================================================================
+// Everything below up to LLTextureDXTCache proper runs on the cache thread.
+
+class LLTextureDXTCache::CacheThread : public LLQueuedThread
+{
+public:
+	CacheThread(bool threaded, bool read_only)
+		: LLQueuedThread("texturedxtcache", threaded),
+		  mReadOnly(read_only),
+		  mTotalSize(0),
+		  mMaxSize(0)
+	{
+	}
+
+	// MAIN THREAD
+	handle_t read(const LLUUID& id);
+	void scan(const std::string& dir_name, const std::vector<std::string>& names, S64 max_size);
+	// FETCH THREAD
+	void write(const LLUUID& id, S32 discard, LLImageRaw* raw);
+
+	// CACHE THREAD
+	// The index below is only touched from processRequest(), which the
+	// thread runs one request at a time.
+	struct Entry
+	{
+		S32 mSize;
+		S32 mDiscard; // -1 until the header has been read
+		time_t mLastUsed;
+	};
+	typedef std::map<LLUUID, Entry> entry_map_t;
+
+	std::string getPath(const LLUUID& id) const
+	{
+		return mDirName + gDirUtilp->getDirDelimiter() + id.asString() + TEXTURE_DXT_CACHE_EXTENSION;
+	}
+	// Not a valid entry name, so an interrupted write is dropped by the next scan
+	std::string getTempPath(const LLUUID& id) const
+	{
+		return mDirName + gDirUtilp->getDirDelimiter() + id.asString() + ".tmp" + TEXTURE_DXT_CACHE_EXTENSION;
+	}
+	void addEntry(const LLUUID& id, S32 size, S32 discard, time_t last_used);
+	void removeEntry(const LLUUID& id);
+	void evict();
+
+	// Set in a second viewer instance, which leaves the folder to the first
+	const bool mReadOnly;
+	entry_map_t mEntries;
+	std::string mDirName;
+	S64 mTotalSize;
+	S64 mMaxSize;
+};
+
+class LLTextureDXTCache::ReadRequest : public LLQueuedThread::QueuedRequest
+{
+protected:
+	virtual ~ReadRequest() {} // use deleteRequest()
+
+public:
+	ReadRequest(LLQueuedThread::handle_t handle, CacheThread* thread, const LLUUID& id)
+		: LLQueuedThread::QueuedRequest(handle, LLQueuedThread::PRIORITY_NORMAL),
+		  mDiscard(-1),
+		  mThread(thread),
+		  mID(id)
+	{
+	}
+
+	/*virtual*/ bool processRequest();
+
+	LLPointer<LLImageDXT> mImage; // null unless the read succeeded
+	S32 mDiscard;
+
+private:
+	bool readImage(const std::string& filename);
+
+	CacheThread* mThread;
+	LLUUID mID;
+};
+
+bool LLTextureDXTCache::ReadRequest::processRequest()
+{
+	CacheThread::entry_map_t::iterator iter = mThread->mEntries.find(mID);
+	if (iter == mThread->mEntries.end())
+	{
+		return true; // evicted since the main thread last heard of it
+	}
+
+	std::string filename = mThread->getPath(mID);
+	if (!readImage(filename))
+	{
+		mImage = NULL;
+		if (!mThread->mReadOnly)
+		{
+			LLFile::remove(filename);
+		}
+		mThread->removeEntry(mID);
+		return true;
+	}
+	iter->second.mDiscard = mDiscard;
+	iter->second.mLastUsed = time(NULL);
+	return true;
+}
+
+bool LLTextureDXTCache::ReadRequest::readImage(const std::string& filename)
+{
+	LLFILE* fp = LLFile::fopen(filename, "rb");
+	if (!fp)
+	{
+		return false;
+	}
+
+	S32 data_size = 0;
+	LLPointer<LLImageDXT> dxt = new LLImageDXT;
+	bool valid = read_header(fp, mDiscard, data_size)
+		&& dxt->allocateData(data_size)
+		&& fread(dxt->getData(), data_size, 1, fp) == 1;
+	fclose(fp);
+	if (!valid)
+	{
+		return false;
+	}
+
+	// Only accept what WriteRequest writes; anything else would trip the
+	// llerrs in LLImageDXT or overrun the upload.
+	const LLImageDXT::dxtfile_header_t* dxt_header = (const LLImageDXT::dxtfile_header_t*)dxt->getData();
+	LLImageDXT::EFileFormat format = LLImageDXT::getFormat(dxt_header->pixel_fmt.fourcc);
+	S32 width = dxt_header->maxwidth;
+	S32 height = dxt_header->maxheight;
+	if (dxt_header->fourcc != 0x20534444
+		|| (format != LLImageDXT::FORMAT_DXR1 && format != LLImageDXT::FORMAT_DXR5)
+		|| width <= 0 || height <= 0 || width > MAX_IMAGE_SIZE || height > MAX_IMAGE_SIZE
+		|| (width << mDiscard) > MAX_IMAGE_SIZE
+		|| (height << mDiscard) > MAX_IMAGE_SIZE
+		|| (width & (width - 1)) || (height & (height - 1))
+		|| dxt_header->num_mips != LLImageDXT::calcNumMips(width, height))
+	{
+		return false;
+	}
+	dxt->updateData();
+	if (dxt->getDataSize() < dxt->calcDataSize(0))
+	{
+		return false;
+	}
+
+	mImage = dxt;
+	return true;
+}
+
+class LLTextureDXTCache::WriteRequest : public LLQueuedThread::QueuedRequest
+{
+protected:
+	virtual ~WriteRequest() {} // use deleteRequest()
+
+public:
+	WriteRequest(LLQueuedThread::handle_t handle, CacheThread* thread, const LLUUID& id,
+				 S32 discard, LLImageRaw* raw)
+		: LLQueuedThread::QueuedRequest(handle, LLQueuedThread::PRIORITY_LOW,
+										LLQueuedThread::FLAG_AUTO_COMPLETE),
+		  mThread(thread),
+		  mID(id),
+		  mDiscard(discard),
+		  mRawImage(raw)
+	{
+	}
+
+	/*virtual*/ bool processRequest();
+
+private:
+	bool haveBetter();
+
+	CacheThread* mThread;
+	LLUUID mID;
+	S32 mDiscard;
+	LLPointer<LLImageRaw> mRawImage;
+};
+
+bool LLTextureDXTCache::WriteRequest::haveBetter()
+{
+	CacheThread::entry_map_t::iterator iter = mThread->mEntries.find(mID);
+	if (iter == mThread->mEntries.end())
+	{
+		return false;
+	}
+	CacheThread::Entry& entry = iter->second;
+	if (entry.mDiscard < 0)
+	{
+		// only listed so far
+		LLFILE* fp = LLFile::fopen(mThread->getPath(mID), "rb");
+		if (fp)
+		{
+			S32 data_size = 0;
+			if (!read_header(fp, entry.mDiscard, data_size))
+			{
+				entry.mDiscard = -1;
+			}
+			fclose(fp);
+		}
+	}
+	return entry.mDiscard >= 0 && entry.mDiscard <= mDiscard;
+}
+
+bool LLTextureDXTCache::WriteRequest::processRequest()
+{
+	if (haveBetter())
+	{
+		return true;
+	}
+
+	LLPointer<LLImageDXT> dxt = new LLImageDXT;
+	BOOL encoded = dxt->encodeCompressed(mRawImage);
+	mRawImage = NULL;
+	if (!encoded)
+	{
+		return true;
+	}
+
+	// Written aside and renamed into place, so that a second viewer
+	// instance reading the folder never sees a partial file.
+	std::string filename = mThread->getPath(mID);
+	std::string temp_filename = mThread->getTempPath(mID);
+	LLFILE* fp = LLFile::fopen(temp_filename, "wb");
+	if (!fp)
+	{
+		return true;
+	}
+	U32 version = TEXTURE_DXT_CACHE_VERSION;
+	S32 data_size = dxt->getDataSize();
+	bool written = fwrite(TEXTURE_DXT_CACHE_MAGIC, sizeof(TEXTURE_DXT_CACHE_MAGIC), 1, fp) == 1
+		&& fwrite(&version, sizeof(version), 1, fp) == 1
+		&& fwrite(&mDiscard, sizeof(mDiscard), 1, fp) == 1
+		&& fwrite(&data_size, sizeof(data_size), 1, fp) == 1
+		&& fwrite(dxt->getData(), data_size, 1, fp) == 1;
+	S32 size = (S32)ftell(fp);
+	fclose(fp);
+
+	mThread->removeEntry(mID);
+	LLFile::remove(filename);
+	if (!written || LLFile::rename(temp_filename, filename))
+	{
+		llwarns << "Unable to write texture DXT cache file " << filename << llendl;
+		LLFile::remove(temp_filename);
+		return true;
+	}
+	mThread->addEntry(mID, size, mDiscard, time(NULL));
+	mThread->evict();
+	return true;
+}
+
+// Takes over the folder the main thread listed, picking up the size and
+// age of every entry for eviction.
+class LLTextureDXTCache::ScanRequest : public LLQueuedThread::QueuedRequest
+{
+protected:
+	virtual ~ScanRequest() {} // use deleteRequest()
+
+public:
+	ScanRequest(LLQueuedThread::handle_t handle, CacheThread* thread, const std::string& dir_name,
+				const std::vector<std::string>& names, S64 max_size)
+		: LLQueuedThread::QueuedRequest(handle, LLQueuedThread::PRIORITY_HIGH,
+										LLQueuedThread::FLAG_AUTO_COMPLETE),
+		  mThread(thread),
+		  mDirName(dir_name),
+		  mNames(names),
+		  mMaxSize(max_size)
+	{
+	}
+
+	/*virtual*/ bool processRequest();
+
+private:
+	CacheThread* mThread;
+	std::string mDirName;
+	std::vector<std::string> mNames;
+	S64 mMaxSize;
+};
+
+bool LLTextureDXTCache::ScanRequest::processRequest()
+{
+	mThread->mEntries.clear();
+	mThread->mTotalSize = 0;
+	mThread->mDirName = mDirName;
+	mThread->mMaxSize = mMaxSize;
+
+	for (std::vector<std::string>::iterator iter = mNames.begin();
+		 iter != mNames.end(); ++iter)
+	{
+		std::string path = mDirName + gDirUtilp->getDirDelimiter() + *iter;
+		LLUUID id;
+		if (iter->length() != UUID_STR_LENGTH - 1 + TEXTURE_DXT_CACHE_EXTENSION.length()
+			|| !id.set(iter->substr(0, UUID_STR_LENGTH - 1), FALSE))
+		{
+			// left over from an interrupted write
+			if (!mThread->mReadOnly)
+			{
+				LLFile::remove(path);
+			}
+			continue;
+		}
+		llstat stat_data;
+		if (!LLFile::stat(path, &stat_data))
+		{
+			mThread->addEntry(id, (S32)stat_data.st_size, -1, stat_data.st_mtime);
+		}
+	}
+	mThread->evict();
+	return true;
+}
+
+LLQueuedThread::handle_t LLTextureDXTCache::CacheThread::read(const LLUUID& id)
+{
+	if (isQuitting())
+	{
+		return nullHandle();
+	}
+	handle_t handle = generateHandle();
+	llverify(addRequest(new ReadRequest(handle, this, id)));
+	return handle;
+}
+
+void LLTextureDXTCache::CacheThread::write(const LLUUID& id, S32 discard, LLImageRaw* raw)
+{
+	if (!isQuitting())
+	{
+		llverify(addRequest(new WriteRequest(generateHandle(), this, id, discard, raw)));
+	}
+}
+
+void LLTextureDXTCache::CacheThread::scan(const std::string& dir_name, const std::vector<std::string>& names,
+										  S64 max_size)
+{
+	if (!isQuitting())
+	{
+		llverify(addRequest(new ScanRequest(generateHandle(), this, dir_name, names, max_size)));
+	}
+}
+
+void LLTextureDXTCache::CacheThread::addEntry(const LLUUID& id, S32 size, S32 discard, time_t last_used)
+{
+	Entry& entry = mEntries[id];
+	entry.mSize = size;
+	entry.mDiscard = discard;
+	entry.mLastUsed = last_used;
+	mTotalSize += size;
+}
+
+void LLTextureDXTCache::CacheThread::removeEntry(const LLUUID& id)
+{
+	entry_map_t::iterator iter = mEntries.find(id);
+	if (iter != mEntries.end())
+	{
+		mTotalSize -= iter->second.mSize;
+		mEntries.erase(iter);
+	}
+}
+
+void LLTextureDXTCache::CacheThread::evict()
+{
+	if (mReadOnly || mTotalSize <= mMaxSize)
+	{
+		return;
+	}
+
+	typedef std::pair<time_t, LLUUID> age_pair_t;
+	std::vector<age_pair_t> ages;
+	ages.reserve(mEntries.size());
+	for (entry_map_t::iterator iter = mEntries.begin(); iter != mEntries.end(); ++iter)
+	{
+		ages.push_back(age_pair_t(iter->second.mLastUsed, iter->first));
+	}
+	std::sort(ages.begin(), ages.end());
+
+	S64 target_size = (S64)(mMaxSize * TEXTURE_DXT_CACHE_TRIM_RATIO);
+	S32 evicted = 0;
+	for (std::vector<age_pair_t>::iterator iter = ages.begin();
+		 iter != ages.end() && mTotalSize > target_size; ++iter)
+	{
+		LLFile::remove(getPath(iter->second));
+		removeEntry(iter->second);
+		++evicted;
+	}
+	LL_DEBUGS("TextureDXTCache") << "Evicted " << evicted << " textures, "
+								 << mTotalSize << " bytes left" << LL_ENDL;
+}
+
+//============================================================================
+
+LLTextureDXTCache::pending_load_map_t LLTextureDXTCache::sPendingLoads;
+std::vector<LLQueuedThread::handle_t> LLTextureDXTCache::sStaleLoads;
+std::set<LLUUID> LLTextureDXTCache::sEntries;
+LLMutex* LLTextureDXTCache::sEntriesMutex = NULL;
+LLTextureDXTCache::CacheThread* LLTextureDXTCache::sThread = NULL;
+bool LLTextureDXTCache::sEnabled = false;
+bool LLTextureDXTCache::sReadOnly = false;
+
+//static
+void LLTextureDXTCache::startThread(bool threaded, bool read_only)
+{
+	if (!sThread)
+	{
+		sReadOnly = read_only;
+		sThread = new CacheThread(threaded, read_only);
+		sEntriesMutex = new LLMutex;
+	}
+}
+
+//static
+S32 LLTextureDXTCache::update(U32 max_time_ms)
+{
+	if (!sThread)
+	{
+		return 0;
+	}
+
+	for (std::vector<LLQueuedThread::handle_t>::iterator iter = sStaleLoads.begin();
+		 iter != sStaleLoads.end(); )
+	{
+		LLQueuedThread::status_t status = sThread->getRequestStatus(*iter);
+		if (status == LLQueuedThread::STATUS_QUEUED || status == LLQueuedThread::STATUS_INPROGRESS)
+		{
+			++iter;
+			continue;
+		}
+		sThread->completeRequest(*iter);
+		iter = sStaleLoads.erase(iter);
+	}
+
+	return sThread->update(max_time_ms);
+}
+
+//static
+void LLTextureDXTCache::pause()
+{
+	if (sThread)
+	{
+		sThread->pause();
+	}
+}
+
+//static
+void LLTextureDXTCache::cleanupClass()
+{
+	sEnabled = false;
+	sPendingLoads.clear();
+	sStaleLoads.clear();
+	sEntries.clear();
+	if (sThread)
+	{
+		sThread->shutdown();
+		delete sThread;
+		sThread = NULL;
+	}
+	delete sEntriesMutex;
+	sEntriesMutex = NULL;
+}
+
+//static
+void LLTextureDXTCache::initClass()
+{
+	sEnabled = sThread != NULL
+		&& gGLManager.mHasCompressedTextures
+		&& gGLManager.mHasS3TC;
+	if (!sEnabled)
+	{
+		return;
+	}
+
+	std::string dir_name = getDirName();
+	if (!sReadOnly)
+	{
+		LLFile::mkdir(dir_name);
+	}
+
+	// Listing the folder is left on this thread, gDirUtilp keeps the
+	// directory being walked as state. The files themselves aren't opened.
+	std::vector<std::string> names;
+	std::string name;
+	std::string mask = gDirUtilp->getDirDelimiter() + "*" + TEXTURE_DXT_CACHE_EXTENSION;
+	while (gDirUtilp->getNextFileInDir(dir_name, mask, name, FALSE))
+	{
+		names.push_back(name);
+	}
+	{
+		LLMutexLock lock(sEntriesMutex);
+		for (std::vector<std::string>::iterator iter = names.begin(); iter != names.end(); ++iter)
+		{
+			LLUUID id;
+			if (iter->length() == UUID_STR_LENGTH - 1 + TEXTURE_DXT_CACHE_EXTENSION.length()
+				&& id.set(iter->substr(0, UUID_STR_LENGTH - 1), FALSE))
+			{
+				sEntries.insert(id);
+			}
+		}
+	}
+
+	S64 max_size = (S64)gSavedSettings.getU32("TextureDXTCacheSize") * 1024 * 1024;
+	sThread->scan(dir_name, names, max_size);
+}
+
+//static
+std::string LLTextureDXTCache::getDirName()
+{
+	return gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "texturedxt");
+}
+
+//static
+LLTextureDXTCache::ELoadStatus LLTextureDXTCache::load(const LLUUID& id, LLPointer<LLImageDXT>& image, S32& discard)
+{
+	if (!sEnabled)
+	{
+		return LOAD_MISS;
+	}
+
+	pending_load_map_t::iterator iter = sPendingLoads.find(id);
+	if (iter == sPendingLoads.end())
+	{
+		{
+			LLMutexLock lock(sEntriesMutex);
+			if (sEntries.find(id) == sEntries.end())
+			{
+				return LOAD_MISS;
+			}
+		}
+		LLQueuedThread::handle_t handle = sThread->read(id);
+		if (handle == LLQueuedThread::nullHandle())
+		{
+			return LOAD_MISS;
+		}
+		sPendingLoads[id] = handle;
+		return LOAD_PENDING;
+	}
+
+	LLQueuedThread::handle_t handle = iter->second;
+	LLQueuedThread::status_t status = sThread->getRequestStatus(handle);
+	if (status == LLQueuedThread::STATUS_QUEUED || status == LLQueuedThread::STATUS_INPROGRESS)
+	{
+		return LOAD_PENDING;
+	}
+
+	ELoadStatus result = LOAD_MISS;
+	if (status == LLQueuedThread::STATUS_COMPLETE)
+	{
+		ReadRequest* req = (ReadRequest*)sThread->getRequest(handle);
+		if (req->mImage.notNull())
+		{
+			image = req->mImage;
+			discard = req->mDiscard;
+			result = LOAD_DONE;
+		}
+	}
+	sThread->completeRequest(handle);
+	sPendingLoads.erase(iter);
+
+	if (result == LOAD_MISS)
+	{
+		// don't ask again, the texture is fetched as usual
+		LLMutexLock lock(sEntriesMutex);
+		sEntries.erase(id);
+	}
+	return result;
+}
+
+//static
+void LLTextureDXTCache::cancelLoad(const LLUUID& id)
+{
+	pending_load_map_t::iterator iter = sPendingLoads.find(id);
+	if (iter != sPendingLoads.end())
+	{
+		sThread->abortRequest(iter->second, false);
+		sStaleLoads.push_back(iter->second);
+		sPendingLoads.erase(iter);
+	}
+}
+
+//static
+void LLTextureDXTCache::save(const LLUUID& id, S32 discard, const LLImageRaw* raw)
+{
+	if (!sEnabled || sReadOnly || !raw || discard < 0 || discard > MAX_DISCARD_LEVEL)
+	{
+		return;
+	}
+	S32 components = raw->getComponents();
+	if ((components != 3 && components != 4) || raw->getWidth() < 4 || raw->getHeight() < 4)
+	{
+		return;
+	}
+
+	// The viewer goes on using raw, so compress a copy
+	LLPointer<LLImageRaw> copy = new LLImageRaw(const_cast<U8*>(raw->getData()), raw->getWidth(),
+												raw->getHeight(), components);
+	sThread->write(id, discard, copy);
+
+	LLMutexLock lock(sEntriesMutex);
+	sEntries.insert(id);
+}
+
+//static
+void LLTextureDXTCache::purge()
+{
+	std::string mask = gDirUtilp->getDirDelimiter() + "*" + TEXTURE_DXT_CACHE_EXTENSION;
+	gDirUtilp->deleteFilesInDir(getDirName(), mask);
+	if (sEntriesMutex)
+	{
+		LLMutexLock lock(sEntriesMutex);
+		sEntries.clear();
+	}
+}
@@ -0,0 +1,108 @@
+/** 
+ * @file lltexturedxtcache.h
+ * @brief On-disk cache of block compressed textures.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTEXTUREDXTCACHE_H
+#define LL_LLTEXTUREDXTCACHE_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "llimagedxt.h"
+#include "llqueuedthread.h"
+#include "lluuid.h"
+
+class LLImageRaw;
+
+// Secondary texture cache holding a DXT1/DXT5 copy of the desired decoded
+// level of each texture. A texture found here is uploaded compressed with
+// its mips straight from disk: no J2C decode, and a quarter (DXT5) or an
+// eighth (DXT1) of the texture memory. Compression and file I/O happen on
+// the cache's own thread, which keeps the folder under TextureDXTCacheSize
+// by dropping the least recently used entries.
+class LLTextureDXTCache
+{
+public:
+	// Creates the thread the cache works on. Like the other queued
+	// threads it is driven by update() from the main loop. A read only
+	// cache, as in a second viewer instance, never writes nor evicts.
+	static void startThread(bool threaded, bool read_only);
+	static S32 update(U32 max_time_ms);
+	static void pause();
+	static void cleanupClass();
+
+	// Indexes the cache folder. Needs the GL capabilities.
+	static void initClass();
+	static bool isEnabled() { return sEnabled; }
+
+	enum ELoadStatus
+	{
+		LOAD_MISS,		// no usable entry
+		LOAD_PENDING,	// still being read, ask again later
+		LOAD_DONE		// image holds the entry, decoded at discard
+	};
+	// Starts, or checks on, the read of the entry for id. Main thread only.
+	static ELoadStatus load(const LLUUID& id, LLPointer<LLImageDXT>& image, S32& discard);
+	// Drops a read the caller no longer wants
+	static void cancelLoad(const LLUUID& id);
+	// Queues a copy of raw, decoded at discard, to be compressed and stored
+	// unless a better entry is already there. Called from the texture
+	// fetch thread.
+	static void save(const LLUUID& id, S32 discard, const LLImageRaw* raw);
+	static void purge();
+
+private:
+	static std::string getDirName();
+
+	class ReadRequest;
+	class WriteRequest;
+	class ScanRequest;
+	class CacheThread;
+
+	typedef std::map<LLUUID, LLQueuedThread::handle_t> pending_load_map_t;
+	static pending_load_map_t sPendingLoads;
+	// Canceled reads, completed by update() once the thread is done with them
+	static std::vector<LLQueuedThread::handle_t> sStaleLoads;
+
+	// Entries the viewer believes are cached. An entry evicted on the cache
+	// thread stays here until a read for it comes back empty. save() adds
+	// to it from the fetch thread, hence the mutex.
+	static std::set<LLUUID> sEntries;
+	static LLMutex* sEntriesMutex;
+
+	static CacheThread* sThread;
+	static bool sEnabled;
+	static bool sReadOnly;
+};
+
+#endif // LL_LLTEXTUREDXTCACHE_H
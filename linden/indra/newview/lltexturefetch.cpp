@@ -49,6 +49,7 @@
 
 #include "llagent.h"
 #include "lltexturecache.h"
+#include "lltexturedxtcache.h"
 #include "llviewercontrol.h"
 #include "llviewerimagelist.h"
 #include "llviewerimage.h"
@@ -587,8 +588,11 @@ void LLTextureFetchWorker::startWork(S32 param)
 #include "llviewerimagelist.h" // debug
 
 // Called from LLWorkerThread::processRequest()
+static LLFastTimer::DeclareTimer FTM_TEXTURE_FETCH_WORK("Texture Fetch Worker");
+
 bool LLTextureFetchWorker::doWork(S32 param)
 {
+	LLFastTimer t(FTM_TEXTURE_FETCH_WORK);
 	LLMutexLock lock(&mWorkMutex);
 
 	if ((mFetcher->isQuitting() || getFlags(LLWorkerClass::WCF_DELETE_REQUESTED)))
@@ -1085,6 +1089,18 @@ bool LLTextureFetchWorker::doWork(S32 param)
 			}
 			else
 			{
+				// Only the level the viewer asked for is worth keeping, the lower
+				// ones of a progressive fetch are replaced moments later
+				if (mUrl.empty() && LLTextureDXTCache::isEnabled() && mDecodedDiscard <= mDesiredDiscard)
+				{
+					// The viewer can't take mRawImage before WAIT_ON_WRITE, so copy it
+					// for the DXT cache thread without holding the work mutex.
+					LLPointer<LLImageRaw> raw = mRawImage;
+					S32 discard = mDecodedDiscard;
+					unlockWorkMutex();
+					LLTextureDXTCache::save(mID, discard, raw);
+					lockWorkMutex();
+				}
 				setPriority(LLWorkerThread::PRIORITY_HIGH | mWorkPriority);
 				mState = WRITE_TO_CACHE;
 			}
@@ -1548,6 +1564,8 @@ LLTextureFetch::LLTextureFetch(LLTextureCache* cache, LLImageDecodeThread* image
 	  mTextureBandwidth(0),
 	  mCurlGetRequest(NULL)
 {
+	mHTTPPipelining = gSavedSettings.getBOOL("ImagePipelineHTTPPipelining");
+	mHTTPMaxHostConnections = (S32)gSavedSettings.getU32("ImagePipelineHTTPMaxHostConnections");
 	mMaxBandwidth = gSavedSettings.getF32("ThrottleBandwidthKBPS");
 	mTextureInfo.setUpLogging(gSavedSettings.getBOOL("LogTextureDownloadsToViewerLog"), gSavedSettings.getBOOL("LogTextureDownloadsToSimulator"), gSavedSettings.getU32("TextureLoggingThreshold"));
 }
@@ -1803,6 +1821,8 @@ void LLTextureFetch::startThread()
 {
 	// Construct mCurlGetRequest from Worker Thread
 	mCurlGetRequest = new LLCurlRequest();
+	mCurlGetRequest->setPipelining(mHTTPPipelining);
+	mCurlGetRequest->setMaxHostConnections(mHTTPMaxHostConnections);
 }
 
 // WORKER THREAD
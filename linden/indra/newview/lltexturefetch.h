@@ -115,6 +115,8 @@ private:
 	LLTextureCache* mTextureCache;
 	LLImageDecodeThread* mImageDecodeThread;
 	LLCurlRequest* mCurlGetRequest;
+	bool mHTTPPipelining;
+	S32 mHTTPMaxHostConnections;
 	
 	// Map of all requests by UUID
 	typedef std::map<LLUUID,LLTextureFetchWorker*> map_t;
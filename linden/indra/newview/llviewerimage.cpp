@@ -54,6 +54,7 @@
 
 // viewer includes
 #include "lldrawpool.h"
+#include "lltexturedxtcache.h"
 #include "lltexturefetch.h"
 #include "llviewerimagelist.h"
 #include "llviewercontrol.h"
@@ -100,6 +101,8 @@ S32 LLViewerImage::sLLViewerImageCount = 0 ;
 // static
 void LLViewerImage::initClass()
 {	
+	LLTextureDXTCache::initClass();
+
 	sNullImagep = new LLImageGL(1,1,3,TRUE);
 	LLPointer<LLImageRaw> raw = new LLImageRaw(1,1,3);
 	raw->clear(0x77, 0x77, 0x77, 0xFF);
@@ -343,6 +346,7 @@ void LLViewerImage::init(bool firstinit)
 	mDecodeFrame = 0;
 	mVisibleFrame = 0;
 	mForSculpt = FALSE ;
+	mFromDXTCache = FALSE;
 	mCachedRawImage = NULL ;
 	mCachedRawDiscardLevel = -1 ;
 	mCachedRawImageReady = FALSE ;
@@ -383,6 +387,7 @@ LLViewerImage::~LLViewerImage()
 	{
 		LLAppViewer::getTextureFetch()->deleteRequest(getID(), true);
 	}
+	LLTextureDXTCache::cancelLoad(getID());
 	// Explicitly call LLViewerImage::cleanup since we're in a destructor and cleanup is virtual
 	LLViewerImage::cleanup();
 	sImageCount--;
@@ -566,6 +571,12 @@ BOOL LLViewerImage::createTexture(S32 usename/*= 0*/)
 			return FALSE;
 		}
 
+		if (mFromDXTCache)
+		{
+			// Decoded data replaces the compressed upload
+			clearExplicitFormat();
+			mFromDXTCache = FALSE;
+		}
 		res = LLImageGL::createGLTexture(mRawDiscardLevel, mRawImage, usename);
 	}
 
@@ -1213,6 +1224,13 @@ bool LLViewerImage::updateFetch()
 		}
 	}
 	
+	if (make_request && current_discard < 0 && loadFromDXTCache())
+	{
+		// Waiting on the cache read, or anything better than the cached
+		// level is requested next update
+		make_request = false;
+	}
+
 	if (make_request)
 	{
 		S32 w=0, h=0, c=0;
@@ -1258,6 +1276,53 @@ bool LLViewerImage::updateFetch()
 	return mIsFetching ? true : false;
 }
 
+BOOL LLViewerImage::loadFromDXTCache()
+{
+	if (!LLTextureDXTCache::isEnabled() || gNoRender || !mUrl.empty() ||
+		mForSculpt || mForceToSaveRawImage || mNeedsAux || !mLoadedCallbackList.empty())
+	{
+		LLTextureDXTCache::cancelLoad(getID());
+		return FALSE;
+	}
+
+	// The file is read on the cache thread, only the upload happens here
+	LLPointer<LLImageDXT> image;
+	S32 discard = 0;
+	LLTextureDXTCache::ELoadStatus status = LLTextureDXTCache::load(getID(), image, discard);
+	if (status != LLTextureDXTCache::LOAD_DONE)
+	{
+		return status == LLTextureDXTCache::LOAD_PENDING;
+	}
+
+	S32 components = image->getComponents();
+	if (getComponents() != components)
+	{
+		// We've changed the number of components, so we need to move any
+		// objects using this pool to a different pool.
+		mComponents = components;
+		gImageList.dirtyImage(this);
+	}
+	mFullWidth = image->getWidth() << discard;
+	mFullHeight = image->getHeight() << discard;
+
+	// 3 channel textures are stored as opaque DXT1 blocks
+	LLGLenum format = (components == 4) ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	setExplicitFormat(format, format);
+	setSize(mFullWidth, mFullHeight, components);
+	mFromDXTCache = TRUE;
+	return LLImageGL::createGLTexture(discard, image->getData() + image->getMipOffset(0), TRUE);
+}
+
+void LLViewerImage::dropDXTCacheImage()
+{
+	if (mFromDXTCache)
+	{
+		destroyGLTexture();
+		clearExplicitFormat();
+		mFromDXTCache = FALSE;
+	}
+}
+
 //
 //force to fetch a new raw image for this texture
 //this function is to replace readBackRaw().
@@ -1393,6 +1458,20 @@ bool LLViewerImage::doLoadedCallbacks()
 		gImageList.mCallbackList.erase(this);
 	}
 
+	if (mFromDXTCache)
+	{
+		// A compressed upload has no raw data to read back; fetch it instead
+		for(callback_list_t::iterator iter = mLoadedCallbackList.begin();
+			iter != mLoadedCallbackList.end(); ++iter)
+		{
+			if ((*iter)->mNeedsImageRaw)
+			{
+				dropDXTCacheImage();
+				break;
+			}
+		}
+	}
+
 	S32 gl_discard = getDiscardLevel();
 
 	// If we don't have a legit GL image, set it to be lower than the worst discard level
@@ -1705,6 +1784,7 @@ void LLViewerImage::saveRawImage()
 
 void LLViewerImage::forceToSaveRawImage(S32 desired_discard) 
 { 
+	dropDXTCacheImage();
 	mForceToSaveRawImage = TRUE ;
 	mDesiredSavedRawDiscardLevel = desired_discard ;
 	
@@ -1816,6 +1896,7 @@ BOOL LLViewerImage::isForSculptOnly() const
 
 void LLViewerImage::setForSculpt()   
 {
+	dropDXTCacheImage();
 	mForSculpt = TRUE ;
 	if(isForSculptOnly() && !getBoundRecently())
 	{
@@ -343,6 +343,13 @@ private:
 	BOOL forceFetch() ;
 
 	void scaleDown() ;	
+
+	// Uploads the texture compressed from LLTextureDXTCache once its entry has
+	// been read. Returns TRUE while the read is pending or once it's uploaded,
+	// FALSE if there's no entry or the image needs raw data the cache can't provide.
+	BOOL loadFromDXTCache();
+	// Replaces a texture loaded from LLTextureDXTCache with a regular fetch
+	void dropDXTCacheImage();
 	void switchToCachedImage();
 	void setCachedRawImage() ;
 public:
@@ -428,6 +435,7 @@ private:
 	LLHost mTargetHost;	// if LLHost::invalid, just request from agent's simulator
 	
 	BOOL   mForSculpt ; //a flag if the texture is used for a sculpt data.
+	BOOL   mFromDXTCache; // the GL texture was uploaded compressed from LLTextureDXTCache
 	mutable BOOL    mNeedsResetMaxVirtualSize ;
 
 	ll_face_list_t    mFaceList ; //reverse pointer pointing to the faces using this image as texture
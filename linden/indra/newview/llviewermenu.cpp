@@ -159,6 +159,7 @@
 #include "llinventorymodel.h"
 #include "llinventoryview.h"
 #include "llkeyboard.h"
+#include "llkeywords.h"
 #include "lllineeditor.h"
 #include "llmenucommands.h"
 #include "llmenugl.h"
@@ -178,6 +179,7 @@
 #include "llstatview.h"
 #include "llstring.h"
 #include "llsurfacepatch.h"
+#include "lltexteditor.h"
 #include "llimview.h"
 #include "lltextureview.h"
 #include "lltool.h"
@@ -10009,6 +10011,176 @@ class LLAdvancedSaveUIToXML : public view_listener_t
 
 
 
+/////////////////////////////
+// BENCHMARK CHILD LOOKUPS //
+/////////////////////////////
+
+
+static void collect_child_names(LLView* view, std::vector<std::string>& names)
+{
+	const LLView::child_list_t* children = view->getChildList();
+	for (LLView::child_list_const_iter_t it = children->begin(); it != children->end(); ++it)
+	{
+		names.push_back((*it)->getName());
+		collect_child_names(*it, names);
+	}
+}
+
+// Builds a few of the busiest floaters from their real XML and looks up
+// every named widget in them, the way childSet*() refreshes do, with and
+// without the child name index.
+class LLAdvancedBenchmarkChildLookups : public view_listener_t
+{
+	bool handleEvent(LLPointer<LLEvent> event, const LLSD& userdata)
+	{
+		const char* files[] = { "floater_tools.xml", "floater_radar.xml", "floater_preferences.xml" };
+		const S32 PASSES = 100;
+
+		for (U32 i = 0; i < LL_ARRAY_SIZE(files); ++i)
+		{
+			LLFloater* floater = new LLFloater(std::string("lookup benchmark"));
+			LLUICtrlFactory::getInstance()->buildFloater(floater, files[i], NULL, FALSE);
+
+			std::vector<std::string> names;
+			collect_child_names(floater, names);
+
+			F64 seconds[2];
+			for (S32 indexed = 0; indexed < 2; ++indexed)
+			{
+				LLView::sUseChildNameIndex = indexed;
+				LLTimer timer;
+				for (S32 pass = 0; pass < PASSES; ++pass)
+				{
+					for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it)
+					{
+						floater->getChildView(*it, TRUE, FALSE);
+					}
+				}
+				seconds[indexed] = timer.getElapsedTimeF64();
+			}
+			LLView::sUseChildNameIndex = TRUE;
+
+			S32 lookups = llmax((S32)names.size() * PASSES, 1);
+			llinfos << files[i] << ": " << names.size() << " widgets, "
+					<< seconds[0] * 1000000.0 / lookups << " us per lookup walking, "
+					<< seconds[1] * 1000000.0 / lookups << " us indexed" << llendl;
+
+			delete floater;
+		}
+		return true;
+	}
+};
+
+
+
+///////////////////////////////////
+// BENCHMARK SCRIPT HIGHLIGHTING //
+///////////////////////////////////
+
+
+static bool same_segments(const std::vector<LLTextSegment*>& a, const std::vector<LLTextSegment*>& b)
+{
+	if (a.size() != b.size())
+	{
+		return false;
+	}
+	for (U32 i = 0; i < a.size(); ++i)
+	{
+		if (a[i]->getStart() != b[i]->getStart()
+			|| a[i]->getEnd() != b[i]->getEnd()
+			|| a[i]->getToken() != b[i]->getToken())
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Types a line of LSL into the middle of a large synthetic script one
+// keystroke at a time and times re-highlighting after each key, full
+// re-lex against the incremental path, checking both agree.
+class LLAdvancedBenchmarkScriptHighlighting : public view_listener_t
+{
+	bool handleEvent(LLPointer<LLEvent> event, const LLSD& userdata)
+	{
+		const std::string keywords_file = gDirUtilp->getExpandedFilename(LL_PATH_APP_SETTINGS, "keywords.ini");
+		LLKeywords keywords;
+		LLKeywords full_keywords;
+		if (!keywords.loadFromFile(keywords_file) || !full_keywords.loadFromFile(keywords_file))
+		{
+			llwarns << "Couldn't load keywords.ini, not benchmarking" << llendl;
+			return true;
+		}
+
+		const char* script_lines[] =
+		{
+			"integer gCount = 0; // counter\n",
+			"default\n{\n    state_entry()\n    {\n",
+			"        llSay(0, \"Hello, \\\"Avatar\\\"!\");\n",
+			"        /* block\n           comment */\n",
+			"        vector v = <1.0, 2.0, 3.0>;\n",
+			"        if (gCount > 10) llSetText(\"busy\", <1,1,1>, 1.0);\n",
+			"    }\n}\n"
+		};
+		std::string script;
+		while (script.size() < 64 * 1024)
+		{
+			for (U32 i = 0; i < LL_ARRAY_SIZE(script_lines); ++i)
+			{
+				script += script_lines[i];
+			}
+		}
+		LLWString text = utf8str_to_wstring(script);
+		const LLWString typed = utf8str_to_wstring("        llOwnerSay(\"typed \" + (string)llGetTime()); /* x */\n");
+		const LLColor4 color = LLColor4::black;
+
+		std::vector<LLTextSegment*> full_segments;
+		std::vector<LLTextSegment*> incremental_segments;
+		keywords.findSegments(&incremental_segments, text, color);
+
+		F64 full_seconds = 0.0;
+		F64 incremental_seconds = 0.0;
+		S64 relexed = 0;
+		S32 pos = text.size() / 2;
+		while (pos > 0 && text[pos - 1] != '\n')
+		{
+			--pos;
+		}
+		for (U32 i = 0; i < typed.size(); ++i)
+		{
+			text.insert(pos++, 1, typed[i]);
+
+			LLTimer timer;
+			keywords.updateSegments(&incremental_segments, text, color);
+			incremental_seconds += timer.getElapsedTimeF64();
+			relexed += keywords.getLastRelexLength();
+
+			timer.reset();
+			full_keywords.findSegments(&full_segments, text, color);
+			full_seconds += timer.getElapsedTimeF64();
+		}
+
+		// Re-lex from scratch with the same token table to check the result.
+		std::vector<LLTextSegment*> check_segments;
+		keywords.findSegments(&check_segments, text, color);
+		bool match = same_segments(check_segments, incremental_segments);
+
+		S32 keys = llmax((S32)typed.size(), 1);
+		llinfos << "Script highlighting, " << text.size() << " chars, " << full_segments.size() << " segments: "
+				<< full_seconds * 1000.0 / keys << " ms per key full, "
+				<< incremental_seconds * 1000.0 / keys << " ms incremental ("
+				<< relexed / keys << " chars re-lexed per key), results "
+				<< (match ? "match" : "DIFFER") << llendl;
+
+		std::for_each(full_segments.begin(), full_segments.end(), DeletePointer());
+		std::for_each(incremental_segments.begin(), incremental_segments.end(), DeletePointer());
+		std::for_each(check_segments.begin(), check_segments.end(), DeletePointer());
+		return true;
+	}
+};
+
+
+
 ///////////////
 // XUI NAMES //
 ///////////////
@@ -11452,6 +11624,8 @@ void initialize_menus()
 	addMenu(new LLAdvancedEditUI(), "Advanced.EditUI");
 	addMenu(new LLAdvancedLoadUIFromXML(), "Advanced.LoadUIFromXML");
 	addMenu(new LLAdvancedSaveUIToXML(), "Advanced.SaveUIToXML");
+	addMenu(new LLAdvancedBenchmarkChildLookups(), "Advanced.BenchmarkChildLookups");
+	addMenu(new LLAdvancedBenchmarkScriptHighlighting(), "Advanced.BenchmarkScriptHighlighting");
 	addMenu(new LLAdvancedToggleXUINames(), "Advanced.ToggleXUINames");
 	addMenu(new LLAdvancedCheckXUINames(), "Advanced.CheckXUINames");
 
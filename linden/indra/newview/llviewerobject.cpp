@@ -198,7 +198,8 @@ LLViewerObject::LLViewerObject(const LLUUID &id, const LLPCode pcode, LLViewerRe
 	mDead(FALSE),
 	mOrphaned(FALSE),
 	mUserSelected(FALSE),
-	mOnActiveList(FALSE),
+	mListIndex(-1),
+	mIdleUpdateFrame(0),
 	mOnMap(FALSE),
 	mStatic(FALSE),
 	mNumFaces(0),
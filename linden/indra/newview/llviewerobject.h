@@ -167,8 +167,9 @@ public:
 
 
 	virtual BOOL    isActive() const; // Whether this object needs to do an idleUpdate.
-	BOOL			onActiveList() const				{return mOnActiveList;}
-	void			setOnActiveList(BOOL on_active)		{ mOnActiveList = on_active; }
+	BOOL			onActiveList() const				{return mListIndex != -1;}
+	S32				getListIndex() const				{ return mListIndex; }
+	void			setListIndex(S32 index)				{ mListIndex = index; }
 
 	virtual BOOL	isAttachment() const { return FALSE; }
 	virtual BOOL	isHUDAttachment() const { return FALSE; }
@@ -631,7 +632,8 @@ protected:
 	BOOL			mDead;
 	BOOL			mOrphaned;					// This is an orphaned child
 	BOOL			mUserSelected;				// Cached user select information
-	BOOL			mOnActiveList;
+	S32				mListIndex;					// Index in the active object list, -1 if not on it
+	U32				mIdleUpdateFrame;			// Frame of the next scheduled idleUpdate()
 	BOOL			mOnMap;						// On the map.
 	BOOL			mStatic;					// Object doesn't move.
 	S32				mNumFaces;
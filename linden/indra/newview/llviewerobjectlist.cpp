@@ -102,6 +102,7 @@ LLViewerObjectList::LLViewerObjectList()
 {
 	mNumVisCulled = 0;
 	mNumSizeCulled = 0;
+	mNumIdleUpdates = 0;
 	mCurLazyUpdateIndex = 0;
 	mCurBin = 0;
 	mNumDeadObjects = 0;
@@ -645,6 +646,41 @@ void LLViewerObjectList::updateApparentAngles(LLAgent &agent)
 }
 
 
+// Number of frames between idleUpdate() calls for an active object.
+// Interpolation in idleUpdate() measures dt from the object's last
+// update, so an object updated less often still ends up in the right
+// place; only distant or hidden prims, whose motion and texture
+// animation nobody can follow closely, are slowed down.
+static U32 get_idle_update_interval(LLViewerObject* objectp)
+{
+	if (objectp->getPCode() != LL_PCODE_VOLUME
+		|| objectp->isFlexible()
+		|| objectp->isSelected()
+		|| objectp->mDrawable.isNull())
+	{
+		return 1;
+	}
+
+	LLDrawable* drawablep = objectp->mDrawable;
+	if (!drawablep->isVisible())
+	{
+		return 8;
+	}
+
+	// size on screen, in radians
+	F32 radius = llmax(drawablep->getRadius(), 0.1f);
+	F32 dist_squared = dist_vec_squared(drawablep->getPositionAgent(), LLViewerCamera::getInstance()->getOrigin());
+	if (dist_squared > radius * radius * 64.f * 64.f)
+	{
+		return 4;
+	}
+	if (dist_squared > radius * radius * 16.f * 16.f)
+	{
+		return 2;
+	}
+	return 1;
+}
+
 void LLViewerObjectList::update(LLAgent &agent, LLWorld &world)
 {
 	LLMemType mt(LLMemType::MTYPE_OBJECT);
@@ -679,24 +715,30 @@ void LLViewerObjectList::update(LLAgent &agent, LLWorld &world)
 	S32 num_active_objects = 0;
 	LLViewerObject *objectp = NULL;	
 	
-	// Make a copy of the list in case something in idleUpdate() messes with it
+	static BOOL* sThrottleIdleUpdates = rebind_llcontrol<BOOL>("ThrottleActiveObjectUpdates", &gSavedSettings, true);
+	const U32 frame = LLFrameTimer::getFrameCount();
+
+	// Make a copy of the objects due this frame in case something in
+	// idleUpdate() messes with the list
 	std::vector<LLViewerObject*> idle_list;
 	idle_list.reserve( mActiveObjects.size() );
 
- 	for (std::set<LLPointer<LLViewerObject> >::iterator active_iter = mActiveObjects.begin();
+	for (std::vector<LLPointer<LLViewerObject> >::iterator active_iter = mActiveObjects.begin();
 		active_iter != mActiveObjects.end(); active_iter++)
 	{
 		objectp = *active_iter;
-		if (objectp)
-		{
-			idle_list.push_back( objectp );
-		}
-		else
+		if (!objectp)
 		{	// There shouldn't be any NULL pointers in the list, but they have caused
 			// crashes before.  This may be idleUpdate() messing with the list.
 			llwarns << "LLViewerObjectList::update has a NULL objectp" << llendl;
 		}
+		else if (!(*sThrottleIdleUpdates) || (S32)(frame - objectp->mIdleUpdateFrame) >= 0)
+		{
+			idle_list.push_back( objectp );
+			objectp->mIdleUpdateFrame = frame + get_idle_update_interval(objectp);
+		}
 	}
+	mNumIdleUpdates = (S32)idle_list.size();
 
 	static BOOL* sFreezeTime = rebind_llcontrol<BOOL>("FreezeTime", &gSavedSettings, true);
 
@@ -724,11 +766,8 @@ void LLViewerObjectList::update(LLAgent &agent, LLWorld &world)
 				//  If Idle Update returns false, kill object!
 				kill_list.push_back(objectp);
 			}
-			else
-			{
-				num_active_objects++;
-			}
 		}
+		num_active_objects = (S32)(mActiveObjects.size() - kill_list.size());
 		for (std::vector<LLViewerObject*>::iterator kill_iter = kill_list.begin();
 			kill_iter != kill_list.end(); kill_iter++)
 		{
@@ -837,8 +876,7 @@ void LLViewerObjectList::cleanupReferences(LLViewerObject *objectp)
 	if (objectp->onActiveList())
 	{
 		//llinfos << "Removing " << objectp->mID << " " << objectp->getPCodeString() << " from active list in cleanupReferences." << llendl;
-		objectp->setOnActiveList(FALSE);
-		mActiveObjects.erase(objectp);
+		removeFromActiveList(objectp);
 	}
 
 	if (objectp->isOnMap())
@@ -939,6 +977,11 @@ void LLViewerObjectList::killAllObjects()
 	if (!mActiveObjects.empty())
 	{
 		llwarns << "Some objects still on active object list!" << llendl;
+		for (std::vector<LLPointer<LLViewerObject> >::iterator iter = mActiveObjects.begin();
+			 iter != mActiveObjects.end(); ++iter)
+		{
+			(*iter)->setListIndex(-1);
+		}
 		mActiveObjects.clear();
 	}
 
@@ -1002,18 +1045,39 @@ void LLViewerObjectList::updateActive(LLViewerObject *objectp)
 		if (active)
 		{
 			//llinfos << "Adding " << objectp->mID << " " << objectp->getPCodeString() << " to active list." << llendl;
-			mActiveObjects.insert(objectp);
-			objectp->setOnActiveList(TRUE);
+			objectp->setListIndex(mActiveObjects.size());
+			objectp->mIdleUpdateFrame = LLFrameTimer::getFrameCount();
+			mActiveObjects.push_back(objectp);
 		}
 		else
 		{
 			//llinfos << "Removing " << objectp->mID << " " << objectp->getPCodeString() << " from active list." << llendl;
-			mActiveObjects.erase(objectp);
-			objectp->setOnActiveList(FALSE);
+			removeFromActiveList(objectp);
 		}
 	}
 }
 
+void LLViewerObjectList::removeFromActiveList(LLViewerObject* objectp)
+{
+	S32 idx = objectp->getListIndex();
+	if (idx != -1)
+	{ //remove by moving last element to this object's position
+		llassert(mActiveObjects[idx] == objectp);
+
+		objectp->setListIndex(-1);
+
+		S32 last_index = mActiveObjects.size()-1;
+
+		if (idx != last_index)
+		{
+			mActiveObjects[idx] = mActiveObjects[last_index];
+			mActiveObjects[idx]->setListIndex(idx);
+		}
+
+		mActiveObjects.pop_back();
+	}
+}
+
 
 
 void LLViewerObjectList::shiftObjects(const LLVector3 &offset)
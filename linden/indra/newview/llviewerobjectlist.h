@@ -109,6 +109,7 @@ public:
 	void dirtyAllObjectInventory();
 
 	void updateActive(LLViewerObject *objectp);
+	S32 getNumActiveObjects() const { return (S32)mActiveObjects.size(); }
 	void updateAvatarVisibility();
 
 	// Selection related stuff
@@ -130,6 +131,11 @@ public:
 	// Only accessed by markDead in LLViewerObject
 	void cleanupReferences(LLViewerObject *objectp);
 
+protected:
+	void removeFromActiveList(LLViewerObject* objectp);
+
+public:
+
 	S32 findReferences(LLDrawable *drawablep) const; // Find references to drawable in all objects, and return value.
 
 	S32 getOrphanParentCount() const { return mOrphanParents.count(); }
@@ -168,6 +174,7 @@ public:
 
 	S32 mNumSizeCulled;
 	S32 mNumVisCulled;
+	S32 mNumIdleUpdates;	// active objects that got an idleUpdate() last frame
 
 	// if we paused in the last frame
 	// used to discount stats from this frame
@@ -196,7 +203,7 @@ protected:
 	S32 mNumOrphans;
 
 	LLDynamicArrayPtr<LLPointer<LLViewerObject>, 256> mObjects;
-	std::set<LLPointer<LLViewerObject> > mActiveObjects;
+	std::vector<LLPointer<LLViewerObject> > mActiveObjects;
 
 	LLDynamicArrayPtr<LLPointer<LLViewerObject> > mMapObjects;
 
@@ -450,6 +450,12 @@ public:
 			addText(xpos, ypos, llformat("%d Texture Matrix Ops", gPipeline.mTextureMatrixOps));
 			ypos += y_inc;
 
+			addText(xpos, ypos, llformat("%d Sculpt Builds Pending, %d Swapped In", LLVOVolume::sNumPendingSculpts, LLVOVolume::sNumSculptsBuilt));
+			ypos += y_inc;
+
+			addText(xpos, ypos, llformat("%d/%d Active Objects Updated", gObjectList.mNumIdleUpdates, gObjectList.getNumActiveObjects()));
+			ypos += y_inc;
+
 			gPipeline.mTextureMatrixOps = 0;
 			gPipeline.mMatrixOpCount = 0;
 
@@ -6361,7 +6361,10 @@ void LLVOAvatar::updateVisualParams()
 
 	setSex( (getVisualParamWeight( "male" ) > 0.5f) ? SEX_MALE : SEX_FEMALE );
 
+	// Renormalize morphed mesh normals once, after every changed param is in
+	LLPolyMesh::beginMorphBatch();
 	LLCharacter::updateVisualParams();
+	LLPolyMesh::endMorphBatch();
 
 	if (mLastSkeletonSerialNum != mSkeletonSerialNum)
 	{
@@ -316,6 +316,7 @@ public:
 	BOOL			isLocalTextureDataAvailable( LLTexLayerSet* layerset );
 	BOOL			isLocalTextureDataFinal( LLTexLayerSet* layerset );
 	LLVOAvatarDefines::ETextureIndex	getBakedTE( LLTexLayerSet* layerset );
+	LLTexLayerSet*	getLayerSet(LLVOAvatarDefines::ETextureIndex index) const;
 	void			updateComposites();
 	void			onGlobalColorChanged( LLTexGlobalColor* global_color, BOOL set_by_user );
 // Removed:	BOOL		getLocalTextureRaw( LLVOAvatarDefines::ETextureIndex index, LLImageRaw* image_raw_pp );
@@ -765,7 +766,6 @@ protected:
 	void			useBakedTexture(const LLUUID& id);
 	void			dumpAvatarTEs(const std::string& context);
 	void			removeMissingBakedTextures();
-	LLTexLayerSet*	getLayerSet(LLVOAvatarDefines::ETextureIndex index) const;
 	LLHost			getObjectHost() const;
 	S32				getLocalDiscardLevel(LLVOAvatarDefines::ETextureIndex index);
 public:
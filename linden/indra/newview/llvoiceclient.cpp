@@ -219,8 +219,13 @@ protected:
 		LLPumpIO* pump);
 	//@}
 	
-	std::string 	mInput;
-	
+	// Streaming input state. Bytes are fed to expat directly out of the
+	// buffer segments; only a trailing run of newlines is held back until
+	// we know whether it is the "\n\n\n" message delimiter.
+	S32				mPendingNewlines;
+	bool			mParserNeedsReset;
+	S32				mMessageBytes;
+
 	// Expat control members
 	XML_Parser		parser;
 	int				responseDepth;
@@ -281,6 +286,10 @@ protected:
 	
 	void			reset();
 
+	void			consumeInput(const char* data, S32 len);
+	void			feedParser(const char* data, S32 len);
+	void			finishMessage();
+
 	void			processResponse(std::string tag);
 
 static void XMLCALL ExpatStartTag(void *data, const char *el, const char **attr);
@@ -290,11 +299,83 @@ static void XMLCALL ExpatCharHandler(void *data, const XML_Char *s, int len);
 	void			StartTag(const char *tag, const char **attr);
 	void			EndTag(const char *tag);
 	void			CharData(const char *buffer, int length);
-	
+
+	// Element names we act on. Tags are interned to one of these once per
+	// callback so StartTag()/EndTag() switch on an id instead of walking a
+	// long chain of stricmp() calls for every element in every message.
+	enum ETag
+	{
+		TAG_UNKNOWN = 0,
+		TAG_EVENT,
+		TAG_RESPONSE,
+		TAG_INPUT_XML,
+		TAG_CAPTURE_DEVICES,
+		TAG_RENDER_DEVICES,
+		TAG_BUDDIES,
+		TAG_BLOCK_RULES,
+		TAG_AUTO_ACCEPT_RULES,
+		TAG_RETURN_CODE,
+		TAG_SESSION_HANDLE,
+		TAG_SESSION_GROUP_HANDLE,
+		TAG_STATUS_CODE,
+		TAG_STATUS_STRING,
+		TAG_PARTICIPANT_URI,
+		TAG_VOLUME,
+		TAG_ENERGY,
+		TAG_IS_MODERATOR_MUTED,
+		TAG_IS_SPEAKING,
+		TAG_ALIAS,
+		TAG_NUMBER_OF_ALIASES,
+		TAG_APPLICATION,
+		TAG_CONNECTOR_HANDLE,
+		TAG_VERSION_ID,
+		TAG_ACCOUNT_HANDLE,
+		TAG_STATE,
+		TAG_URI,
+		TAG_IS_CHANNEL,
+		TAG_INCOMING,
+		TAG_ENABLED,
+		TAG_NAME,
+		TAG_AUDIO_MEDIA,
+		TAG_CHANNEL_NAME,
+		TAG_DISPLAY_NAME,
+		TAG_ACCOUNT_NAME,
+		TAG_PARTICIPANT_TYPE,
+		TAG_IS_LOCALLY_MUTED,
+		TAG_MIC_ENERGY,
+		TAG_CHANNEL_URI,
+		TAG_BUDDY_URI,
+		TAG_PRESENCE,
+		TAG_DEVICE,
+		TAG_CAPTURE_DEVICE,
+		TAG_RENDER_DEVICE,
+		TAG_BUDDY,
+		TAG_BLOCK_RULE,
+		TAG_BLOCK_MASK,
+		TAG_PRESENCE_ONLY,
+		TAG_AUTO_ACCEPT_RULE,
+		TAG_AUTO_ACCEPT_MASK,
+		TAG_AUTO_ADD_AS_BUDDY,
+		TAG_MESSAGE_HEADER,
+		TAG_MESSAGE_BODY,
+		TAG_NOTIFICATION_TYPE,
+		TAG_HAS_TEXT,
+		TAG_HAS_AUDIO,
+		TAG_HAS_VIDEO,
+		TAG_TERMINATED,
+		TAG_SUBSCRIPTION_HANDLE,
+		TAG_SUBSCRIPTION_TYPE,
+	};
+
+	static ETag		lookupTag(const char *tag);
 };
 
 LLVivoxProtocolParser::LLVivoxProtocolParser()
 {
+	mPendingNewlines = 0;
+	mParserNeedsReset = true;
+	mMessageBytes = 0;
+
 	parser = NULL;
 	parser = XML_ParserCreate(NULL);
 	
@@ -340,43 +421,22 @@ LLIOPipe::EStatus LLVivoxProtocolParser::process_impl(
 	LLSD& context,
 	LLPumpIO* pump)
 {
-	LLBufferStream istr(channels, buffer.get());
-	std::ostringstream ostr;
-	while (istr.good())
+	// Feed expat straight out of the input channel segments and release
+	// each segment once it has been consumed. Partial messages stay in the
+	// parser between calls, so nothing is copied or re-scanned.
+	LLBufferArray::segment_iterator_t iter = buffer->beginSegment();
+	while(iter != buffer->endSegment())
 	{
-		char buf[1024];
-		istr.read(buf, sizeof(buf));
-		mInput.append(buf, istr.gcount());
-	}
-	
-	// Look for input delimiter(s) in the input buffer.  If one is found, send the message to the xml parser.
-	int start = 0;
-	int delim;
-	while((delim = mInput.find("\n\n\n", start)) != std::string::npos)
-	{	
-		
-		// Reset internal state of the LLVivoxProtocolParser (no effect on the expat parser)
-		reset();
-		
-		XML_ParserReset(parser, NULL);
-		XML_SetElementHandler(parser, ExpatStartTag, ExpatEndTag);
-		XML_SetCharacterDataHandler(parser, ExpatCharHandler);
-		XML_SetUserData(parser, this);	
-		XML_Parse(parser, mInput.data() + start, delim - start, false);
-		
-		// If this message isn't set to be squelched, output the raw XML received.
-		if(!squelchDebugOutput)
+		if(!(*iter).isOnChannel(channels.in()))
 		{
-			LL_DEBUGS("VivoxProtocolParser") << "parsing: " << mInput.substr(start, delim - start) << LL_ENDL;
+			++iter;
+			continue;
 		}
-		
-		start = delim + 3;
+		consumeInput((const char*)(*iter).data(), (*iter).size());
+		buffer->eraseSegment(iter++);
 	}
-	
-	if(start != 0)
-		mInput = mInput.substr(start);
 
-	LL_DEBUGS("VivoxProtocolParser") << "at end, mInput is: " << mInput << LL_ENDL;
+	LL_DEBUGS("VivoxProtocolParser") << "at end, " << mMessageBytes << " bytes of partial message buffered in parser" << LL_ENDL;
 	
 	if(!gVoiceClient->mConnected)
 	{
@@ -388,6 +448,173 @@ LLIOPipe::EStatus LLVivoxProtocolParser::process_impl(
 	return STATUS_OK;
 }
 
+void LLVivoxProtocolParser::consumeInput(const char* data, S32 len)
+{
+	// Messages are delimited by "\n\n\n". Newlines are held back (only
+	// counted) until either the delimiter completes or some other byte
+	// shows they were part of the message, which lets the delimiter
+	// straddle segment and read boundaries.
+	static const char newlines[] = "\n\n";
+	const char* run_start = data;
+	const char* end = data + len;
+	for(const char* p = data; p < end; ++p)
+	{
+		if(*p == '\n')
+		{
+			feedParser(run_start, p - run_start);
+			run_start = p + 1;
+			if(++mPendingNewlines == 3)
+			{
+				mPendingNewlines = 0;
+				finishMessage();
+			}
+		}
+		else if(mPendingNewlines)
+		{
+			feedParser(newlines, mPendingNewlines);
+			mPendingNewlines = 0;
+		}
+	}
+	feedParser(run_start, end - run_start);
+}
+
+void LLVivoxProtocolParser::feedParser(const char* data, S32 len)
+{
+	if(len <= 0)
+	{
+		return;
+	}
+
+	if(mParserNeedsReset)
+	{
+		// Reset internal state of the LLVivoxProtocolParser, and recycle the
+		// expat parser rather than creating a new one per message.
+		reset();
+		
+		XML_ParserReset(parser, NULL);
+		XML_SetElementHandler(parser, ExpatStartTag, ExpatEndTag);
+		XML_SetCharacterDataHandler(parser, ExpatCharHandler);
+		XML_SetUserData(parser, this);
+		mParserNeedsReset = false;
+		mMessageBytes = 0;
+	}
+
+	XML_Parse(parser, data, len, false);
+	mMessageBytes += len;
+
+	// If this message isn't set to be squelched, output the raw XML received.
+	// A message split across reads is logged a piece at a time.
+	if(!squelchDebugOutput)
+	{
+		LL_DEBUGS("VivoxProtocolParser") << "parsing: " << std::string(data, len) << LL_ENDL;
+	}
+}
+
+void LLVivoxProtocolParser::finishMessage()
+{
+	if(mParserNeedsReset)
+	{
+		// Empty message, nothing was fed to the parser.
+		return;
+	}
+
+	mParserNeedsReset = true;
+	mMessageBytes = 0;
+}
+
+struct LLVivoxTagEntry
+{
+	const char*	mName;
+	S32			mTag;
+};
+
+static bool vivox_tag_less(const LLVivoxTagEntry& a, const LLVivoxTagEntry& b)
+{
+	return stricmp(a.mName, b.mName) < 0;
+}
+
+// static
+LLVivoxProtocolParser::ETag LLVivoxProtocolParser::lookupTag(const char *tag)
+{
+	static LLVivoxTagEntry sTags[] =
+	{
+		{ "Event", TAG_EVENT },
+		{ "Response", TAG_RESPONSE },
+		{ "InputXml", TAG_INPUT_XML },
+		{ "CaptureDevices", TAG_CAPTURE_DEVICES },
+		{ "RenderDevices", TAG_RENDER_DEVICES },
+		{ "Buddies", TAG_BUDDIES },
+		{ "BlockRules", TAG_BLOCK_RULES },
+		{ "AutoAcceptRules", TAG_AUTO_ACCEPT_RULES },
+		{ "ReturnCode", TAG_RETURN_CODE },
+		{ "SessionHandle", TAG_SESSION_HANDLE },
+		{ "SessionGroupHandle", TAG_SESSION_GROUP_HANDLE },
+		{ "StatusCode", TAG_STATUS_CODE },
+		{ "StatusString", TAG_STATUS_STRING },
+		{ "ParticipantURI", TAG_PARTICIPANT_URI },
+		{ "Volume", TAG_VOLUME },
+		{ "Energy", TAG_ENERGY },
+		{ "IsModeratorMuted", TAG_IS_MODERATOR_MUTED },
+		{ "IsSpeaking", TAG_IS_SPEAKING },
+		{ "Alias", TAG_ALIAS },
+		{ "NumberOfAliases", TAG_NUMBER_OF_ALIASES },
+		{ "Application", TAG_APPLICATION },
+		{ "ConnectorHandle", TAG_CONNECTOR_HANDLE },
+		{ "VersionID", TAG_VERSION_ID },
+		{ "AccountHandle", TAG_ACCOUNT_HANDLE },
+		{ "State", TAG_STATE },
+		{ "URI", TAG_URI },
+		{ "IsChannel", TAG_IS_CHANNEL },
+		{ "Incoming", TAG_INCOMING },
+		{ "Enabled", TAG_ENABLED },
+		{ "Name", TAG_NAME },
+		{ "AudioMedia", TAG_AUDIO_MEDIA },
+		{ "ChannelName", TAG_CHANNEL_NAME },
+		{ "DisplayName", TAG_DISPLAY_NAME },
+		{ "AccountName", TAG_ACCOUNT_NAME },
+		{ "ParticipantType", TAG_PARTICIPANT_TYPE },
+		{ "IsLocallyMuted", TAG_IS_LOCALLY_MUTED },
+		{ "MicEnergy", TAG_MIC_ENERGY },
+		{ "ChannelURI", TAG_CHANNEL_URI },
+		{ "BuddyURI", TAG_BUDDY_URI },
+		{ "Presence", TAG_PRESENCE },
+		{ "Device", TAG_DEVICE },
+		{ "CaptureDevice", TAG_CAPTURE_DEVICE },
+		{ "RenderDevice", TAG_RENDER_DEVICE },
+		{ "Buddy", TAG_BUDDY },
+		{ "BlockRule", TAG_BLOCK_RULE },
+		{ "BlockMask", TAG_BLOCK_MASK },
+		{ "PresenceOnly", TAG_PRESENCE_ONLY },
+		{ "AutoAcceptRule", TAG_AUTO_ACCEPT_RULE },
+		{ "AutoAcceptMask", TAG_AUTO_ACCEPT_MASK },
+		{ "AutoAddAsBuddy", TAG_AUTO_ADD_AS_BUDDY },
+		{ "MessageHeader", TAG_MESSAGE_HEADER },
+		{ "MessageBody", TAG_MESSAGE_BODY },
+		{ "NotificationType", TAG_NOTIFICATION_TYPE },
+		{ "HasText", TAG_HAS_TEXT },
+		{ "HasAudio", TAG_HAS_AUDIO },
+		{ "HasVideo", TAG_HAS_VIDEO },
+		{ "Terminated", TAG_TERMINATED },
+		{ "SubscriptionHandle", TAG_SUBSCRIPTION_HANDLE },
+		{ "SubscriptionType", TAG_SUBSCRIPTION_TYPE },
+	};
+	static const S32 sNumTags = sizeof(sTags) / sizeof(sTags[0]);
+	static bool sSorted = false;
+	if(!sSorted)
+	{
+		std::sort(sTags, sTags + sNumTags, vivox_tag_less);
+		sSorted = true;
+	}
+
+	LLVivoxTagEntry key = { tag, TAG_UNKNOWN };
+	LLVivoxTagEntry* found = std::lower_bound(sTags, sTags + sNumTags, key, vivox_tag_less);
+	if(found != sTags + sNumTags && !stricmp(found->mName, tag))
+	{
+		return (ETag)found->mTag;
+	}
+	return TAG_UNKNOWN;
+}
+
 void XMLCALL LLVivoxProtocolParser::ExpatStartTag(void *data, const char *el, const char **attr)
 {
 	if (data)
@@ -424,6 +651,8 @@ void XMLCALL LLVivoxProtocolParser::ExpatCharHandler(void *data, const XML_Char
 
 void LLVivoxProtocolParser::StartTag(const char *tag, const char **attr)
 {
+	const ETag id = lookupTag(tag);
+
 	// Reset the text accumulator. We shouldn't have strings that are inturrupted by new tags
 	textBuffer.clear();
 	// only accumulate text if we're not ignoring tags.
@@ -431,9 +660,9 @@ void LLVivoxProtocolParser::StartTag(const char *tag, const char **attr)
 	
 	if (responseDepth == 0)
 	{	
-		isEvent = !stricmp("Event", tag);
+		isEvent = id == TAG_EVENT;
 		
-		if (!stricmp("Response", tag) || isEvent)
+		if (id == TAG_RESPONSE || isEvent)
 		{
 			// Grab the attributes
 			while (*attr)
@@ -468,7 +697,7 @@ void LLVivoxProtocolParser::StartTag(const char *tag, const char **attr)
 			LL_DEBUGS("VivoxProtocolParser") << tag << " (" << responseDepth << ")"  << LL_ENDL;
 	
 			// Ignore the InputXml stuff so we don't get confused
-			if (!stricmp("InputXml", tag))
+			if (id == TAG_INPUT_XML)
 			{
 				ignoringTags = true;
 				ignoreDepth = responseDepth;
@@ -476,23 +705,23 @@ void LLVivoxProtocolParser::StartTag(const char *tag, const char **attr)
 
 				LL_DEBUGS("VivoxProtocolParserTag") << "starting ignore, ignoreDepth is " << ignoreDepth << LL_ENDL;
 			}
-			else if (!stricmp("CaptureDevices", tag))
+			else if (id == TAG_CAPTURE_DEVICES)
 			{
 				gVoiceClient->clearCaptureDevices();
 			}
-			else if (!stricmp("RenderDevices", tag))
+			else if (id == TAG_RENDER_DEVICES)
 			{
 				gVoiceClient->clearRenderDevices();
 			}
-			else if (!stricmp("Buddies", tag))
+			else if (id == TAG_BUDDIES)
 			{
 				gVoiceClient->deleteAllBuddies();
 			}
-			else if (!stricmp("BlockRules", tag))
+			else if (id == TAG_BLOCK_RULES)
 			{
 				gVoiceClient->deleteAllBlockRules();
 			}
-			else if (!stricmp("AutoAcceptRules", tag))
+			else if (id == TAG_AUTO_ACCEPT_RULES)
 			{
 				gVoiceClient->deleteAllAutoAcceptRules();
 			}
@@ -506,6 +735,7 @@ void LLVivoxProtocolParser::StartTag(const char *tag, const char **attr)
 
 void LLVivoxProtocolParser::EndTag(const char *tag)
 {
+	const ETag id = lookupTag(tag);
 	const std::string& string = textBuffer;
 	bool clearbuffer = true;
 
@@ -529,122 +759,120 @@ void LLVivoxProtocolParser::EndTag(const char *tag)
 		LL_DEBUGS("VivoxProtocolParserTag") << "processing tag " << tag << " (depth = " << responseDepth << ")" << LL_ENDL;
 
 		// Closing a tag. Finalize the text we've accumulated and reset
-		if (!stricmp("ReturnCode", tag))
+		if (id == TAG_RETURN_CODE)
 			returnCode = strtol(string.c_str(), NULL, 10);
-		else if (!stricmp("SessionHandle", tag))
+		else if (id == TAG_SESSION_HANDLE)
 			sessionHandle = string;
-		else if (!stricmp("SessionGroupHandle", tag))
+		else if (id == TAG_SESSION_GROUP_HANDLE)
 			sessionGroupHandle = string;
-		else if (!stricmp("StatusCode", tag))
+		else if (id == TAG_STATUS_CODE)
 			statusCode = strtol(string.c_str(), NULL, 10);
-		else if (!stricmp("StatusString", tag))
+		else if (id == TAG_STATUS_STRING)
 			statusString = string;
-		else if (!stricmp("ParticipantURI", tag))
+		else if (id == TAG_PARTICIPANT_URI)
 			uriString = string;
-		else if (!stricmp("Volume", tag))
+		else if (id == TAG_VOLUME)
 			volume = strtol(string.c_str(), NULL, 10);
-		else if (!stricmp("Energy", tag))
+		else if (id == TAG_ENERGY)
 			energy = (F32)strtod(string.c_str(), NULL);
-		else if (!stricmp("IsModeratorMuted", tag))
+		else if (id == TAG_IS_MODERATOR_MUTED)
 			isModeratorMuted = !stricmp(string.c_str(), "true");
-		else if (!stricmp("IsSpeaking", tag))
+		else if (id == TAG_IS_SPEAKING)
 			isSpeaking = !stricmp(string.c_str(), "true");
-		else if (!stricmp("Alias", tag))
+		else if (id == TAG_ALIAS)
 			alias = string;
-		else if (!stricmp("NumberOfAliases", tag))
+		else if (id == TAG_NUMBER_OF_ALIASES)
 			numberOfAliases = strtol(string.c_str(), NULL, 10);
-		else if (!stricmp("Application", tag))
+		else if (id == TAG_APPLICATION)
 			applicationString = string;
-		else if (!stricmp("ConnectorHandle", tag))
+		else if (id == TAG_CONNECTOR_HANDLE)
 			connectorHandle = string;
-		else if (!stricmp("VersionID", tag))
+		else if (id == TAG_VERSION_ID)
 			versionID = string;
-		else if (!stricmp("AccountHandle", tag))
+		else if (id == TAG_ACCOUNT_HANDLE)
 			accountHandle = string;
-		else if (!stricmp("State", tag))
+		else if (id == TAG_STATE)
 			state = strtol(string.c_str(), NULL, 10);
-		else if (!stricmp("URI", tag))
+		else if (id == TAG_URI)
 			uriString = string;
-		else if (!stricmp("IsChannel", tag))
+		else if (id == TAG_IS_CHANNEL)
 			isChannel = !stricmp(string.c_str(), "true");
-		else if (!stricmp("Incoming", tag))
+		else if (id == TAG_INCOMING)
 			incoming = !stricmp(string.c_str(), "true");
-		else if (!stricmp("Enabled", tag))
+		else if (id == TAG_ENABLED)
 			enabled = !stricmp(string.c_str(), "true");
-		else if (!stricmp("Name", tag))
+		else if (id == TAG_NAME)
 			nameString = string;
-		else if (!stricmp("AudioMedia", tag))
+		else if (id == TAG_AUDIO_MEDIA)
 			audioMediaString = string;
-		else if (!stricmp("ChannelName", tag))
+		else if (id == TAG_CHANNEL_NAME)
 			nameString = string;
-		else if (!stricmp("DisplayName", tag))
+		else if (id == TAG_DISPLAY_NAME)
 			displayNameString = string;
-		else if (!stricmp("AccountName", tag))
+		else if (id == TAG_ACCOUNT_NAME)
 			nameString = string;
-		else if (!stricmp("ParticipantType", tag))
+		else if (id == TAG_PARTICIPANT_TYPE)
 			participantType = strtol(string.c_str(), NULL, 10);
-		else if (!stricmp("IsLocallyMuted", tag))
+		else if (id == TAG_IS_LOCALLY_MUTED)
 			isLocallyMuted = !stricmp(string.c_str(), "true");
-		else if (!stricmp("MicEnergy", tag))
+		else if (id == TAG_MIC_ENERGY)
 			energy = (F32)strtod(string.c_str(), NULL);
-		else if (!stricmp("ChannelName", tag))
-			nameString = string;
-		else if (!stricmp("ChannelURI", tag))
+		else if (id == TAG_CHANNEL_URI)
 			uriString = string;
-		else if (!stricmp("BuddyURI", tag))
+		else if (id == TAG_BUDDY_URI)
 			uriString = string;
-		else if (!stricmp("Presence", tag))
+		else if (id == TAG_PRESENCE)
 			statusString = string;
-		else if (!stricmp("Device", tag))
+		else if (id == TAG_DEVICE)
 		{
 			// This closing tag shouldn't clear the accumulated text.
 			clearbuffer = false;
 		}
-		else if (!stricmp("CaptureDevice", tag))
+		else if (id == TAG_CAPTURE_DEVICE)
 		{
 			gVoiceClient->addCaptureDevice(textBuffer);
 		}
-		else if (!stricmp("RenderDevice", tag))
+		else if (id == TAG_RENDER_DEVICE)
 		{
 			gVoiceClient->addRenderDevice(textBuffer);
 		}
-		else if (!stricmp("Buddy", tag))
+		else if (id == TAG_BUDDY)
 		{
 			gVoiceClient->processBuddyListEntry(uriString, displayNameString);
 		}
-		else if (!stricmp("BlockRule", tag))
+		else if (id == TAG_BLOCK_RULE)
 		{
 			gVoiceClient->addBlockRule(blockMask, presenceOnly);
 		}
-		else if (!stricmp("BlockMask", tag))
+		else if (id == TAG_BLOCK_MASK)
 			blockMask = string;
-		else if (!stricmp("PresenceOnly", tag))
+		else if (id == TAG_PRESENCE_ONLY)
 			presenceOnly = string;
-		else if (!stricmp("AutoAcceptRule", tag))
+		else if (id == TAG_AUTO_ACCEPT_RULE)
 		{
 			gVoiceClient->addAutoAcceptRule(autoAcceptMask, autoAddAsBuddy);
 		}
-		else if (!stricmp("AutoAcceptMask", tag))
+		else if (id == TAG_AUTO_ACCEPT_MASK)
 			autoAcceptMask = string;
-		else if (!stricmp("AutoAddAsBuddy", tag))
+		else if (id == TAG_AUTO_ADD_AS_BUDDY)
 			autoAddAsBuddy = string;
-		else if (!stricmp("MessageHeader", tag))
+		else if (id == TAG_MESSAGE_HEADER)
 			messageHeader = string;
-		else if (!stricmp("MessageBody", tag))
+		else if (id == TAG_MESSAGE_BODY)
 			messageBody = string;
-		else if (!stricmp("NotificationType", tag))
+		else if (id == TAG_NOTIFICATION_TYPE)
 			notificationType = string;
-		else if (!stricmp("HasText", tag))
+		else if (id == TAG_HAS_TEXT)
 			hasText = !stricmp(string.c_str(), "true");
-		else if (!stricmp("HasAudio", tag))
+		else if (id == TAG_HAS_AUDIO)
 			hasAudio = !stricmp(string.c_str(), "true");
-		else if (!stricmp("HasVideo", tag))
+		else if (id == TAG_HAS_VIDEO)
 			hasVideo = !stricmp(string.c_str(), "true");
-		else if (!stricmp("Terminated", tag))
+		else if (id == TAG_TERMINATED)
 			terminated = !stricmp(string.c_str(), "true");
-		else if (!stricmp("SubscriptionHandle", tag))
+		else if (id == TAG_SUBSCRIPTION_HANDLE)
 			subscriptionHandle = string;
-		else if (!stricmp("SubscriptionType", tag))
+		else if (id == TAG_SUBSCRIPTION_TYPE)
 			subscriptionType = string;
 		
 
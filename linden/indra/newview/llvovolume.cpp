@@ -41,6 +41,7 @@
 #include "llflexibleobject.h"
 #include "llmaterialtable.h"
 #include "llprimitive.h"
+#include "llsculptmeshcache.h"
 #include "llvolume.h"
 #include "llvolumemgr.h"
 #include "llvolumemessage.h"
@@ -83,6 +84,8 @@ F32 LLVOVolume::sLODFactor = 1.f;
 F32	LLVOVolume::sLODSlopDistanceFactor = 0.5f; //Changing this to zero, effectively disables the LOD transition slop 
 F32 LLVOVolume::sDistanceFactor = 1.0f;
 S32 LLVOVolume::sNumLODChanges = 0;
+S32 LLVOVolume::sNumPendingSculpts = 0;
+S32 LLVOVolume::sNumSculptsBuilt = 0;
 
 LLVOVolume::LLVOVolume(const LLUUID &id, const LLPCode pcode, LLViewerRegion *regionp)
 	: LLViewerObject(id, pcode, regionp),
@@ -113,6 +116,7 @@ LLVOVolume::~LLVOVolume()
 // static
 void LLVOVolume::initClass()
 {
+	LLSculptMeshCache::initClass();
 }
 
 
@@ -514,7 +518,10 @@ void LLVOVolume::updateTextureVirtualSize()
 												(S32)LLViewerImageBoostLevel::BOOST_SCULPTED));
 			mSculptTexture->setForSculpt() ;
 			
-			if(!mSculptTexture->isCachedRawImageReady())
+			// a sculpt already built at full resolution, e.g. from the mesh
+			// cache, has no use for the map
+			S32 sculpt_level = getVolume() ? getVolume()->getSculptLevel() : -2;
+			if(sculpt_level != 0 && !mSculptTexture->isCachedRawImageReady())
 			{
 				S32 lod = llmin(mLOD, 3);
 				F32 lodf = ((F32)(lod + 1.0f)/4.f);
@@ -531,7 +538,7 @@ void LLVOVolume::updateTextureVirtualSize()
 			}
 	
 			S32 texture_discard = mSculptTexture->getDiscardLevel(); //try to match the texture
-			S32 current_discard = getVolume() ? getVolume()->getSculptLevel() : -2;
+			S32 current_discard = getVolume() ? getVolumeManager()->getPendingSculptLevel(getVolume()) : -2;
 
 			if (texture_discard >= 0 && //texture has some data available
 				(texture_discard < current_discard || //texture has more data than last rebuild
@@ -771,7 +778,24 @@ void LLVOVolume::sculpt()
 			return;
 		}
 
-		if (current_discard == discard_level)  // no work to do here
+		// a volume that was never sculpted from its map may have a mesh in
+		// the cache; it keeps the placeholder until updateSculptBuilds()
+		// picks up the read
+		if (current_discard < 0 && LLSculptMeshCache::requestLoad(getVolume()))
+		{
+			if (current_discard == -2)
+			{
+				getVolume()->sculpt(0, 0, 0, NULL, -1);
+				markSculptVolumesForRebuild();
+			}
+			return;
+		}
+
+		// never trade sculpt geometry for a poorer map
+		if (current_discard >= 0 && (discard_level < 0 || discard_level > current_discard))
+			return;
+
+		if (getVolumeManager()->getPendingSculptLevel(getVolume()) == discard_level)  // no work to do here
 			return;
 		
 		if(!raw_image)
@@ -788,16 +812,35 @@ void LLVOVolume::sculpt()
 					   
 			sculpt_data = raw_image->getData();
 		}
-		getVolume()->sculpt(sculpt_width, sculpt_height, sculpt_components, sculpt_data, discard_level);
-
-		//notify rebuild any other VOVolumes that reference this sculpty volume
-		for (S32 i = 0; i < mSculptTexture->getNumVolumes(); ++i)
+		// the current geometry stays up until the worker thread is done;
+		// a volume that has none yet gets the placeholder meanwhile
+		if (sculpt_data && getVolumeManager()->requestSculpt(getVolume(), sculpt_width, sculpt_height,
+															 sculpt_components, sculpt_data, discard_level))
 		{
-			LLVOVolume* volume = (*(mSculptTexture->getVolumeList()))[i];
-			if (volume && volume != this && volume->getVolume() == getVolume())
+			if (current_discard == -2)
 			{
-				gPipeline.markRebuild(volume->mDrawable, LLDrawable::REBUILD_GEOMETRY, FALSE);
+				getVolume()->sculpt(0, 0, 0, NULL, -1);
+				markSculptVolumesForRebuild();
 			}
+			return;
+		}
+
+		getVolume()->sculpt(sculpt_width, sculpt_height, sculpt_components, sculpt_data, discard_level);
+		LLSculptMeshCache::save(getVolume());
+
+		markSculptVolumesForRebuild();
+	}
+}
+
+//notify rebuild any other VOVolumes that reference this sculpty volume
+void LLVOVolume::markSculptVolumesForRebuild()
+{
+	for (S32 i = 0; i < mSculptTexture->getNumVolumes(); ++i)
+	{
+		LLVOVolume* volume = (*(mSculptTexture->getVolumeList()))[i];
+		if (volume && volume != this && volume->getVolume() == getVolume())
+		{
+			gPipeline.markRebuild(volume->mDrawable, LLDrawable::REBUILD_GEOMETRY, FALSE);
 		}
 	}
 }
@@ -1807,6 +1850,46 @@ const LLMatrix4 LLVOVolume::getRenderMatrix() const
 void LLVOVolume::preUpdateGeom()
 {
 	sNumLODChanges = 0;
+	updateSculptBuilds();
+}
+
+// Picks up sculpts built on the volume thread and meshes read from the
+// sculpt mesh cache, and rebuilds every object that shares the new geometry.
+//static
+void LLVOVolume::updateSculptBuilds()
+{
+	std::vector<LLPointer<LLVolume> > built;
+	sNumPendingSculpts = LLPrimitive::getVolumeManager()->updateSculptBuilds(built);
+	sNumSculptsBuilt = (S32)built.size();
+	for (std::vector<LLPointer<LLVolume> >::iterator iter = built.begin();
+		 iter != built.end(); ++iter)
+	{
+		LLSculptMeshCache::save(*iter);
+	}
+
+	// a volume the cache had nothing usable for sculpts from its map again
+	LLSculptMeshCache::updateLoads(built);
+
+	for (std::vector<LLPointer<LLVolume> >::iterator iter = built.begin();
+		 iter != built.end(); ++iter)
+	{
+		LLVolume* volumep = *iter;
+
+		LLViewerImage* sculpt_texture = gImageList.hasImage(volumep->getParams().getSculptID());
+		if (!sculpt_texture)
+		{
+			continue;
+		}
+		for (S32 i = 0; i < sculpt_texture->getNumVolumes(); ++i)
+		{
+			LLVOVolume* volume = (*(sculpt_texture->getVolumeList()))[i];
+			if (volume && volume->getVolume() == volumep && volume->mDrawable.notNull())
+			{
+				volume->setSculptChanged(TRUE);
+				gPipeline.markRebuild(volume->mDrawable, LLDrawable::REBUILD_VOLUME, FALSE);
+			}
+		}
+	}
 }
 
 void LLVOVolume::parameterChanged(U16 param_type, bool local_origin)
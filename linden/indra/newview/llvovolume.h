@@ -79,6 +79,7 @@ protected:
 public:
 	static		void	initClass();
 	static 		void 	preUpdateGeom();
+	static		void	updateSculptBuilds();
 	
 	enum 
 	{
@@ -174,6 +175,7 @@ public:
 				void	updateSculptTexture();
 				void    setIndexInTex(S32 index) { mIndexInTex = index ;}
 				void	sculpt();
+				void	markSculptVolumesForRebuild();
 				void	updateRelativeXform();
 	/*virtual*/ BOOL	updateGeometry(LLDrawable *drawable);
 	/*virtual*/ void	updateFaceSize(S32 idx);
@@ -247,6 +249,8 @@ public:
 	static F32 sLODSlopDistanceFactor;// Changing this to zero, effectively disables the LOD transition slop 
 	static F32 sLODFactor;				// LOD scale factor
 	static F32 sDistanceFactor;			// LOD distance factor
+	static S32 sNumPendingSculpts;		// sculpts being built on the volume thread
+	static S32 sNumSculptsBuilt;		// sculpts swapped in this frame
 		
 protected:
 	static S32 sNumLODChanges;
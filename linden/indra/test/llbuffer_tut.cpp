@@ -33,11 +33,16 @@
  */
 
 #include <tut/tut.hpp>
+#include <algorithm>
+#include <sstream>
 #include "linden_common.h"
 #include "lltut.h"
 #include "llbuffer.h"
+#include "llbufferstream.h"
 #include "llerror.h"
+#include "llioutil.h"
 #include "llmemtype.h"
+#include "llsdserialize.h"
 
 
 namespace tut
@@ -274,4 +279,79 @@ namespace tut
 		it = bufferArray.constructSegmentAfter(NULL, segment);
 		ensure("constructSegmentAfter() function failed", (it == end));
 	}
+
+	// splice()
+	template<> template<>
+	void buffer_object_t::test<14>()
+	{
+		const char first[] = "SecondLife";
+		const char second[] = " is a Virtual World";
+		LLBufferArray* source = new LLBufferArray;
+		source->append(0, (U8*)first, strlen(first));
+		source->append(1, (U8*)"ignored", 7);
+		source->append(0, (U8*)second, strlen(second));
+		U8* source_data = (*source->beginSegment()).data();
+
+		LLBufferArray dest;
+		S32 moved = dest.splice(5, *source, 0);
+		ensure_equals("splice() moved wrong byte count", moved, (S32)(strlen(first) + strlen(second)));
+		ensure_equals("splice() left channel in source", source->count(0), 0);
+		ensure_equals("splice() took other channel", source->count(1), 7);
+		ensure("splice() copied the data", (*dest.beginSegment()).data() == source_data);
+
+		// The shared buffer has to outlive the source.
+		delete source;
+		char buf[255];
+		S32 len = 255;
+		dest.readAfter(5, NULL, (U8*)buf, len);
+		ensure_equals("splice() data lost", std::string(buf, len), std::string("SecondLife is a Virtual World"));
+	}
+
+	// Push a large LLSD body through the same path an LLURLRequest
+	// response takes to an LLSD parser: curl sized appends on the out
+	// channel, a channel change, and a stream parse off the in channel.
+	template<> template<>
+	void buffer_object_t::test<15>()
+	{
+		LLHeapBuffer::initClass();
+
+		const S32 BODY_SIZE = 512 * 1024;
+		const S32 CURL_CHUNK = 16384;
+		LLSD body = LLSD(std::string(BODY_SIZE, 'x'));
+		std::ostringstream ostr;
+		ostr << LLSDNotationStreamer(body);
+		const std::string wire = ostr.str();
+
+		S32 allocations[2];
+		for(S32 pass = 0; pass < 2; ++pass)
+		{
+			S32 start = LLHeapBuffer::getAllocationCount();
+			{
+				LLBufferArray buffer;
+				LLChannelDescriptors channels = buffer.nextChannel();
+				for(S32 offset = 0; offset < (S32)wire.size(); offset += CURL_CHUNK)
+				{
+					S32 bytes = llmin(CURL_CHUNK, (S32)wire.size() - offset);
+					buffer.append(channels.out(), (U8*)wire.data() + offset, bytes);
+				}
+				std::for_each(
+					buffer.beginSegment(),
+					buffer.endSegment(),
+					LLChangeChannel(channels.out(), channels.in()));
+
+				LLBufferStream istr(channels, &buffer);
+				LLSD parsed;
+				LLSDSerialize::fromNotation(parsed, istr, buffer.count(channels.in()));
+				ensure_equals("body did not survive the chain", parsed.asString().size(), (size_t)BODY_SIZE);
+			}
+			allocations[pass] = LLHeapBuffer::getAllocationCount() - start;
+			llinfos << "buffer chain pass " << pass << ": "
+				<< (allocations[pass] * 1024 * 1024 / (S32)wire.size())
+				<< " heap blocks allocated per MB" << llendl;
+		}
+		ensure("first pass should allocate", allocations[0] > 0);
+		ensure_equals("second pass should be served from the pool", allocations[1], 0);
+
+		LLHeapBuffer::cleanupClass();
+	}
 }
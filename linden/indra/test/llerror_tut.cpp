@@ -45,10 +45,13 @@ namespace
 #include <tut/tut.hpp>
 #include "lltut.h"
 
+#include <iostream>
 #include <vector>
 
 #include "llerrorcontrol.h"
+#include "llfile.h"
 #include "llsd.h"
+#include "lltimer.h"
 
 namespace
 {
@@ -88,6 +91,38 @@ namespace
 		
 		bool mWantsTime;
 	};
+
+	// Logs count messages through the logToFile() recorder and returns
+	// the seconds the logging thread spent; drained_secs also covers
+	// closing the file, which writes out whatever is still queued.
+	F32 time_file_logging(const std::string& file_name, bool async, int count, F32& drained_secs)
+	{
+		LLFile::remove(file_name);
+		LLError::setAsyncFileRecording(async);
+		LLError::logToFile(file_name);
+
+		LLTimer timer;
+		for (int i = 0; i < count; ++i)
+		{
+			llinfos << "message " << i << llendl;
+		}
+		F32 logged_secs = timer.getElapsedTimeF32();
+		LLError::logToFile("");
+		drained_secs = timer.getElapsedTimeF32();
+		return logged_secs;
+	}
+
+	int count_lines(const std::string& file_name)
+	{
+		llifstream file(file_name);
+		std::string line;
+		int lines = 0;
+		while (std::getline(file, line))
+		{
+			++lines;
+		}
+		return lines;
+	}
 }
 	
 namespace tut
@@ -750,6 +785,104 @@ namespace tut
 		ensure_message_contains(8, "big easy");
 		ensure_message_count(9);
 	}
+
+	template<> template<>
+		// several settings changes between two messages cost a single
+		// re-evaluation of the call site
+	void ErrorTestObject::test<17>()
+	{
+		LLError::setDefaultLevel(LLError::LEVEL_NONE);
+
+		TestAlpha::doInfo();
+		ensure_message_count(0);
+		ensure_equals("first check", LLError::shouldLogCallCount(), 1);
+
+		LLError::setClassLevel("TestAlpha", LLError::LEVEL_DEBUG);
+		LLError::setClassLevel("TestAlpha", LLError::LEVEL_WARN);
+		LLError::setClassLevel("TestAlpha", LLError::LEVEL_DEBUG);
+		TestAlpha::doInfo();
+		ensure_message_count(1);
+		ensure_equals("second check", LLError::shouldLogCallCount(), 2);
+		TestAlpha::doInfo();
+		ensure_message_count(2);
+		ensure_equals("third check", LLError::shouldLogCallCount(), 2);
+	}
+
+	template<> template<>
+		// async recorder keeps every message, in order, even when the
+		// ring fills up
+	void ErrorTestObject::test<18>()
+	{
+		const int COUNT = 5000;	// several times the ring size
+		LLError::removeRecorder(&mRecorder);
+
+		TestRecorder* target = new TestRecorder;
+		LLError::AsyncRecorder* async = new LLError::AsyncRecorder(target);
+		LLError::addRecorder(async);
+
+		for (int i = 0; i < COUNT; ++i)
+		{
+			llinfos << "message " << i << llendl;
+		}
+		async->flush();
+		LLError::removeRecorder(async);
+
+		ensure_equals("nothing left queued", async->getQueuedCount(), 0U);
+		ensure_equals("async message count", target->countMessages(), COUNT);
+		for (int i = 0; i < COUNT; ++i)
+		{
+			std::ostringstream expected;
+			expected << "message " << i;
+			ensure_ends_with("async message order", target->message(i), expected.str());
+		}
+		delete async;
+	}
+
+	template<> template<>
+		// an error drains the async recorder before the fatal function
+	void ErrorTestObject::test<19>()
+	{
+		LLError::removeRecorder(&mRecorder);
+
+		TestRecorder* target = new TestRecorder;
+		LLError::AsyncRecorder* async = new LLError::AsyncRecorder(target);
+		LLError::addRecorder(async);
+
+		TestAlpha::doInfo();
+		TestAlpha::doError();
+		LLError::removeRecorder(async);
+
+		ensure("fatal function called", fatalWasCalled);
+		ensure_equals("written before returning", async->getQueuedCount(), 0U);
+		ensure_equals("message count", target->countMessages(), 3);
+		ensure_contains("info first", target->message(0), "any idea");
+		ensure_contains("error last", target->message(2), "ate eels");
+		delete async;
+	}
+
+	template<> template<>
+		// log throughput to a real file, synchronous and async; the
+		// timings are printed rather than checked
+	void ErrorTestObject::test<20>()
+	{
+		const int COUNT = 20000;
+		const std::string file_name = "llerror_tut_throughput.log";
+		LLError::removeRecorder(&mRecorder);
+
+		F32 sync_drained_secs = 0.f;
+		F32 sync_secs = time_file_logging(file_name, false, COUNT, sync_drained_secs);
+		ensure_equals("sync lines written", count_lines(file_name), COUNT);
+
+		F32 async_drained_secs = 0.f;
+		F32 async_secs = time_file_logging(file_name, true, COUNT, async_drained_secs);
+		ensure_equals("async lines written", count_lines(file_name), COUNT);
+		LLFile::remove(file_name);
+
+		std::cout << "log throughput: sync " << (S32)(COUNT / (sync_secs + 0.0001f))
+				  << " msg/s, async " << (S32)(COUNT / (async_secs + 0.0001f))
+				  << " msg/s (" << (S32)(COUNT / (async_drained_secs + 0.0001f))
+				  << " msg/s including the final drain)" << std::endl;
+	}
 }	
 
 /* Tests left:
@@ -0,0 +1,115 @@
+/** 
+ * @file llfasttimer_tut.cpp
+ * @brief Tests for named, per thread fast timers
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "lltut.h"
+
+#include <sstream>
+
+#include "llfasttimer.h"
+#include "lltimer.h"
+
+static LLFastTimer::DeclareTimer FTM_TUT_OUTER("Tut Outer");
+static LLFastTimer::DeclareTimer FTM_TUT_INNER("Tut Inner");
+static LLFastTimer::DeclareTimer FTM_TUT_QUOTED("Tut \"Quoted\"\\");
+
+namespace tut
+{
+	struct fasttimer_data
+	{
+	};
+	typedef test_group<fasttimer_data> fasttimer_test;
+	typedef fasttimer_test::object fasttimer_object;
+	tut::fasttimer_test fasttimer("fasttimer");
+
+	template<> template<>
+	void fasttimer_object::test<1>()
+	{
+		ensure("named timer after fixed timers", FTM_TUT_OUTER.getIndex() >= LLFastTimer::FTM_NUM_TYPES);
+		ensure("named timers distinct", FTM_TUT_OUTER.getIndex() != FTM_TUT_INNER.getIndex());
+		ensure_equals("timer name", LLFastTimer::getTimerName(FTM_TUT_INNER.getIndex()), std::string("Tut Inner"));
+	}
+
+	template<> template<>
+	void fasttimer_object::test<2>()
+	{
+		LLFastTimer::reset();
+		{
+			LLFastTimer outer(FTM_TUT_OUTER);
+			ms_sleep(5);
+			{
+				LLFastTimer inner(FTM_TUT_INNER);
+				ms_sleep(5);
+			}
+		}
+		LLFastTimer::reset();
+
+		S32 hidx = LLFastTimer::sLastFrameIndex % LLFastTimer::FTM_HISTORY_NUM;
+		ensure_equals("outer calls", LLFastTimer::sCallHistory[hidx][FTM_TUT_OUTER.getIndex()], (U64)1);
+		ensure_equals("inner calls", LLFastTimer::sCallHistory[hidx][FTM_TUT_INNER.getIndex()], (U64)1);
+		ensure("outer counted", LLFastTimer::sCountHistory[hidx][FTM_TUT_OUTER.getIndex()] > 0);
+		ensure("inner counted", LLFastTimer::sCountHistory[hidx][FTM_TUT_INNER.getIndex()] > 0);
+	}
+
+	template<> template<>
+	void fasttimer_object::test<3>()
+	{
+		LLFastTimer::setTracing(true);
+		{
+			LLFastTimer outer(FTM_TUT_OUTER);
+			LLFastTimer inner(FTM_TUT_INNER);
+		}
+		LLFastTimer::setTracing(false);
+
+		std::ostringstream trace;
+		LLFastTimer::writeChromeTrace(trace, 1);
+		std::string json = trace.str();
+		ensure("trace header", json.find("{\"traceEvents\":[") == 0);
+		ensure("outer event", json.find("\"name\":\"Tut Outer\"") != std::string::npos);
+		ensure("inner event", json.find("\"name\":\"Tut Inner\"") != std::string::npos);
+		ensure("thread name", json.find("\"thread_name\"") != std::string::npos);
+	}
+
+	template<> template<>
+	void fasttimer_object::test<4>()
+	{
+		LLFastTimer::setTracing(true);
+		{
+			LLFastTimer quoted(FTM_TUT_QUOTED);
+		}
+		LLFastTimer::setTracing(false);
+
+		std::ostringstream trace;
+		LLFastTimer::writeChromeTrace(trace, 1);
+		ensure("name escaped", trace.str().find("\"name\":\"Tut \\\"Quoted\\\"\\\\\"") != std::string::npos);
+	}
+}
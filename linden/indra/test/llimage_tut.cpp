@@ -0,0 +1,246 @@
+/**
+ * @file llimage_tut.cpp
+ * @brief Tests for LLImageRaw scaling and LLImageBase mip generation.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ *
+ * Copyright (c) 2011, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <tut/tut.hpp>
+#include "lltut.h"
+
+#include "llimage.h"
+#include "llmemory.h"
+#include "lltimer.h"
+#include "llv4math.h"
+
+namespace
+{
+	// Gives the tests both ways of scaling an image vertically
+	class ScaleTestImage : public LLImageRaw
+	{
+	public:
+		ScaleTestImage(U16 width, U16 height, S8 components)
+			: LLImageRaw(width, height, components)
+		{
+		}
+
+		// The pass copyScaled() and scale() make on builds without
+		// LL_SCALE_IMAGE_ROWS, one column at a time
+		void scaleColumns(U8* out, S32 out_rows)
+		{
+			for (S32 col = 0; col < getWidth(); col++)
+			{
+				copyLineScaled(getData() + (getComponents() * col), out + (getComponents() * col),
+							   getHeight(), out_rows, getWidth(), getWidth());
+			}
+		}
+
+		void scaleRows(U8* out, S32 out_rows)
+		{
+			copyRowsScaled(getData(), out, getComponents() * getWidth(), getHeight(), out_rows);
+		}
+	};
+
+	// Fills data with a repeatable pattern that uses the whole byte range
+	void fill_pattern(U8* data, S32 size, U32 seed)
+	{
+		for (S32 i = 0; i < size; i++)
+		{
+			seed = seed * 1664525 + 1013904223;
+			data[i] = (U8)(seed >> 24);
+		}
+	}
+
+	LLPointer<ScaleTestImage> make_image(S32 width, S32 height, S32 components)
+	{
+		LLPointer<ScaleTestImage> image = new ScaleTestImage(width, height, components);
+		fill_pattern(image->getData(), image->getDataSize(), width * 31 + height);
+		return image;
+	}
+
+	// Per channel truncated average of each 2x2 block, what
+	// LLImageBase::generateMip() computes without SSE2
+	void reference_mip(const U8* indata, U8* mipdata, S32 width, S32 height, S32 nchannels)
+	{
+		const S32 in_stride = nchannels * width * 2;
+		for (S32 h = 0; h < height; h++)
+		{
+			const U8* top = indata + h * 2 * in_stride;
+			const U8* bottom = top + in_stride;
+			for (S32 w = 0; w < width; w++)
+			{
+				for (S32 c = 0; c < nchannels; c++)
+				{
+					S32 left = w * 2 * nchannels + c;
+					S32 right = left + nchannels;
+					*mipdata++ = (U8)(((U32)top[left] + top[right] + bottom[left] + bottom[right]) >> 2);
+				}
+			}
+		}
+	}
+}
+
+namespace tut
+{
+	struct llimage_data
+	{
+	};
+	typedef test_group<llimage_data> llimage_test;
+	typedef llimage_test::object llimage_object;
+	tut::llimage_test llimage_testcase("llimage");
+
+	template<> template<>
+		// scaling whole rows gives the same bytes as scaling each column
+	void llimage_object::test<1>()
+	{
+#if LL_SCALE_IMAGE_ROWS
+		// width, height, scaled height
+		const S32 sizes[][3] = {
+			{ 64, 64, 32 },
+			{ 128, 100, 37 },
+			{ 256, 256, 512 },
+			{ 31, 57, 64 },
+			{ 512, 512, 128 },
+			{ 17, 5, 3 },
+			{ 1, 9, 2 },
+			{ 300, 7, 7 }
+		};
+		for (S32 components = 1; components <= 4; components++)
+		{
+			for (U32 i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+			{
+				const S32 width = sizes[i][0];
+				const S32 out_rows = sizes[i][2];
+				LLPointer<ScaleTestImage> image = make_image(width, sizes[i][1], components);
+
+				const S32 out_size = width * out_rows * components;
+				std::vector<U8> by_columns(out_size);
+				std::vector<U8> by_rows(out_size);
+				image->scaleColumns(&by_columns[0], out_rows);
+				image->scaleRows(&by_rows[0], out_rows);
+
+				std::ostringstream name;
+				name << width << "x" << sizes[i][1] << " to " << out_rows << " rows, "
+					 << components << " components";
+				ensure(name.str(), by_columns == by_rows);
+			}
+		}
+#endif
+	}
+
+	template<> template<>
+		// mips match the scalar 2x2 average for every channel count,
+		// including widths that leave a tail for the scalar loop
+	void llimage_object::test<2>()
+	{
+		const S32 widths[] = { 1, 2, 3, 7, 16, 33, 128 };
+		const S32 heights[] = { 1, 5, 64 };
+		for (S32 nchannels = 1; nchannels <= 4; nchannels++)
+		{
+			for (U32 w = 0; w < sizeof(widths) / sizeof(widths[0]); w++)
+			{
+				for (U32 h = 0; h < sizeof(heights) / sizeof(heights[0]); h++)
+				{
+					const S32 width = widths[w];
+					const S32 height = heights[h];
+					std::vector<U8> in(width * 2 * height * 2 * nchannels);
+					fill_pattern(&in[0], (S32)in.size(), width + height * 7 + nchannels);
+
+					std::vector<U8> mip(width * height * nchannels);
+					std::vector<U8> expected(mip.size());
+					LLImageBase::generateMip(&in[0], &mip[0], width, height, nchannels);
+					reference_mip(&in[0], &expected[0], width, height, nchannels);
+
+					std::ostringstream name;
+					name << width << "x" << height << " mip, " << nchannels << " channels";
+					ensure(name.str(), mip == expected);
+				}
+			}
+		}
+	}
+
+	template<> template<>
+		// times both vertical scaling passes and the mip paths on
+		// typical texture sizes; prints the results rather than
+		// checking them
+	void llimage_object::test<3>()
+	{
+		const S32 sizes[] = { 64, 128, 256, 512, 1024 };
+		const S32 components = 4;
+		for (U32 i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+		{
+			const S32 size = sizes[i];
+			// about the same number of pixels whatever the size
+			const S32 iterations = llmax(1, (8 * 1024 * 1024) / (size * size));
+			LLPointer<ScaleTestImage> image = make_image(size, size, components);
+			std::vector<U8> out(size * (size / 2) * components);
+
+			LLTimer timer;
+			for (S32 n = 0; n < iterations; n++)
+			{
+				image->scaleColumns(&out[0], size / 2);
+			}
+			F32 column_secs = timer.getElapsedTimeF32();
+
+			timer.reset();
+			for (S32 n = 0; n < iterations; n++)
+			{
+				image->scaleRows(&out[0], size / 2);
+			}
+			F32 row_secs = timer.getElapsedTimeF32();
+
+			const S32 mip_size = size / 2;
+			timer.reset();
+			for (S32 n = 0; n < iterations; n++)
+			{
+				LLImageBase::generateMip(image->getData(), &out[0], mip_size, mip_size, components);
+			}
+			F32 mip_secs = timer.getElapsedTimeF32();
+
+			timer.reset();
+			for (S32 n = 0; n < iterations; n++)
+			{
+				reference_mip(image->getData(), &out[0], mip_size, mip_size, components);
+			}
+			F32 reference_mip_secs = timer.getElapsedTimeF32();
+
+			const F32 ms = 1000.f / iterations;
+			std::cout << "llimage " << size << "x" << size << ": halve by columns "
+					  << column_secs * ms << " ms, by rows " << row_secs * ms
+					  << " ms; mip " << mip_secs * ms << " ms (SSE2 "
+					  << (LL_VECTORIZE_SSE2 ? "on" : "off") << "), scalar "
+					  << reference_mip_secs * ms << " ms" << std::endl;
+		}
+	}
+}
@@ -0,0 +1,144 @@
+/** 
+ * @file llnamecachefile_tut.cpp
+ * @brief Tests for the binary name cache file
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "lltut.h"
+
+#include <sstream>
+
+#include "llavatarname.h"
+#include "llnamecachefile.h"
+
+namespace tut
+{
+	struct namecachefile_data
+	{
+	};
+	typedef test_group<namecachefile_data> namecachefile_test;
+	typedef namecachefile_test::object namecachefile_object;
+	tut::namecachefile_test namecachefile("namecachefile");
+
+	template<> template<>
+	void namecachefile_object::test<1>()
+	{
+		LLUUID agent_id("3941037e-78ab-45f0-b421-bd6e77c1804d");
+		LLUUID group_id("0012809d-7d2d-4c24-9609-af1230a37715");
+		LLUUID display_id("0019aaba-24af-4f0a-aa72-6457953cf7f0");
+
+		LLAvatarName av_name;
+		av_name.mUsername = "bobsmith123";
+		av_name.mDisplayName = "Bob";
+		av_name.mLegacyFirstName = "bobsmith123";
+		av_name.mLegacyLastName = "Resident";
+		av_name.mIsDisplayNameDefault = false;
+		av_name.mExpires = 1234567.5;
+		av_name.mNextUpdate = 7654321.25;
+
+		LLNameCacheFile out;
+		out.addAgent(agent_id, 42, "James", "Linden");
+		out.addGroup(group_id, 43, "Linden Lab");
+		out.addAvatarName(display_id, av_name);
+
+		std::stringstream stream;
+		out.write(stream);
+
+		LLNameCacheFile in;
+		ensure("read", in.read(stream));
+		ensure_equals("record count", in.getRecordCount(), 3);
+
+		LLNameCacheFile::Record record;
+		ensure("agent record", in.nextRecord(record));
+		ensure_equals("agent type", (S32)record.mType, (S32)LLNameCacheFile::RECORD_AGENT);
+		ensure_equals("agent id", record.mID, agent_id);
+		ensure_equals("agent ctime", record.mCreateTime, 42U);
+		ensure_equals("agent first", record.mFirst, std::string("James"));
+		ensure_equals("agent last", record.mLast, std::string("Linden"));
+
+		ensure("group record", in.nextRecord(record));
+		ensure_equals("group type", (S32)record.mType, (S32)LLNameCacheFile::RECORD_GROUP);
+		ensure_equals("group id", record.mID, group_id);
+		ensure_equals("group name", record.mFirst, std::string("Linden Lab"));
+
+		ensure("display name record", in.nextRecord(record));
+		ensure_equals("display type", (S32)record.mType, (S32)LLNameCacheFile::RECORD_DISPLAY_NAME);
+		ensure_equals("display id", record.mID, display_id);
+		ensure_equals("username", record.mFirst, av_name.mUsername);
+		ensure_equals("display name", record.mLast, av_name.mDisplayName);
+		ensure_equals("legacy last", record.mLegacyLast, av_name.mLegacyLastName);
+		ensure_equals("expires", record.mExpires, av_name.mExpires);
+		ensure_equals("next update", record.mNextUpdate, av_name.mNextUpdate);
+		ensure("default flag", !record.mIsDisplayNameDefault);
+
+		ensure("end of records", !in.nextRecord(record));
+
+		// A second pass over the same file sees the same records.
+		in.rewind();
+		ensure("rewind", in.nextRecord(record));
+		ensure_equals("rewound id", record.mID, agent_id);
+	}
+
+	template<> template<>
+	void namecachefile_object::test<2>()
+	{
+		LLNameCacheFile out;
+		out.addAgent(LLUUID::generateNewID(), 1, "Some", "Body");
+		std::stringstream stream;
+		out.write(stream);
+
+		// Drop the last byte of the last record
+		std::string data = stream.str();
+		data.resize(data.size() - 1);
+		std::stringstream truncated(data);
+
+		LLNameCacheFile in;
+		ensure("truncated record rejected", !in.read(truncated));
+		ensure_equals("nothing kept", in.getRecordCount(), 0);
+		LLNameCacheFile::Record record;
+		ensure("no records left", !in.nextRecord(record));
+
+		// Unknown type byte on the first record, right after the 16 byte header
+		data = stream.str();
+		data[16] = 0x7f;
+		std::stringstream bad_type(data);
+		ensure("bad record type rejected", !in.read(bad_type));
+
+		// First name length past the end of the buffer; mReadPos + length
+		// would wrap on 32 bit builds
+		data = stream.str();
+		memset(&data[16 + 1 + UUID_BYTES + 4], 0xff, 4);
+		std::stringstream bad_length(data);
+		ensure("huge string length rejected", !in.read(bad_length));
+
+		std::stringstream garbage("not a name cache at all");
+		ensure("garbage rejected", !in.read(garbage));
+	}
+}
@@ -0,0 +1,296 @@
+/**
+ * @file llprimitive_tut.cpp
+ * @brief Tests for decoding and applying LLPrimitive texture entries.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ *
+ * Copyright (c) 2011, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <iostream>
+
+#include <tut/tut.hpp>
+#include "lltut.h"
+
+#include "lldatapacker.h"
+#include "llprimitive.h"
+#include "lltextureentry.h"
+#include "lltimer.h"
+
+namespace
+{
+	// Counts the per-face setters applyParsedTEMessage() goes through
+	class CountingPrimitive : public LLPrimitive
+	{
+	public:
+		CountingPrimitive() : mSetCount(0) { }
+
+		using LLPrimitive::setTEColor;
+
+		/*virtual*/ S32 setTETexture(const U8 te, const LLUUID& tex_id)
+		{
+			++mSetCount;
+			return LLPrimitive::setTETexture(te, tex_id);
+		}
+		/*virtual*/ S32 setTEScale(const U8 te, const F32 s, const F32 t)
+		{
+			++mSetCount;
+			return LLPrimitive::setTEScale(te, s, t);
+		}
+		/*virtual*/ S32 setTEOffset(const U8 te, const F32 s, const F32 t)
+		{
+			++mSetCount;
+			return LLPrimitive::setTEOffset(te, s, t);
+		}
+		/*virtual*/ S32 setTERotation(const U8 te, const F32 r)
+		{
+			++mSetCount;
+			return LLPrimitive::setTERotation(te, r);
+		}
+		/*virtual*/ S32 setTEBumpShinyFullbright(const U8 te, const U8 bump)
+		{
+			++mSetCount;
+			return LLPrimitive::setTEBumpShinyFullbright(te, bump);
+		}
+		/*virtual*/ S32 setTEMediaTexGen(const U8 te, const U8 media)
+		{
+			++mSetCount;
+			return LLPrimitive::setTEMediaTexGen(te, media);
+		}
+		/*virtual*/ S32 setTEGlow(const U8 te, const F32 glow)
+		{
+			++mSetCount;
+			return LLPrimitive::setTEGlow(te, glow);
+		}
+		/*virtual*/ S32 setTEColor(const U8 te, const LLColor4& color)
+		{
+			++mSetCount;
+			return LLPrimitive::setTEColor(te, color);
+		}
+
+		S32 mSetCount;
+	};
+
+	// Number of setters applyParsedTEMessage() calls for a face it updates
+	const S32 SETTERS_PER_FACE = 8;
+
+	// Appends a field holding only a default value
+	U8* pack_te_default(U8* cur_ptr, const void* value, S32 size)
+	{
+		memcpy(cur_ptr, value, size);	/* Flawfinder: ignore */
+		cur_ptr += size;
+		*cur_ptr++ = 0;
+		return cur_ptr;
+	}
+
+	// A TextureEntry block as the simulator sends it, packed by
+	// LLPrimitive::packTEMessage() from faces set up like typical builds.
+	struct CapturedTE
+	{
+		U8 mBuffer[4096];
+		S32 mFaces;
+	};
+
+	void capture_te(CapturedTE& captured, const LLPrimitive& source)
+	{
+		LLDataPackerBinaryBuffer dp(captured.mBuffer, sizeof(captured.mBuffer));
+		source.packTEMessage(dp);
+		captured.mFaces = source.getNumTEs();
+	}
+
+	S32 apply_captured_te(LLPrimitive& primitive, CapturedTE& captured)
+	{
+		LLDataPackerBinaryBuffer dp(captured.mBuffer, sizeof(captured.mBuffer));
+		return primitive.unpackTEMessage(dp);
+	}
+
+	// One texture on every face, the bulk of what a region sends
+	void setup_plain_box(LLPrimitive& primitive, const LLUUID& image_id)
+	{
+		primitive.setNumTEs(6);
+		primitive.setAllTETextures(image_id);
+	}
+
+	// Every face textured, tinted and placed differently
+	void setup_detailed_prim(LLPrimitive& primitive, U32 seed)
+	{
+		primitive.setNumTEs(9);
+		for (U8 face = 0; face < 9; ++face)
+		{
+			LLUUID image_id;
+			image_id.mData[0] = (U8)(seed + face + 1);
+			image_id.mData[15] = (U8)(seed * 7 + face);
+			primitive.setTETexture(face, image_id);
+			primitive.setTEColor(face, LLColor4(face / 9.f, 1.f - face / 9.f, 0.5f, 1.f));
+			primitive.setTEScale(face, 1.f + face, 0.5f + seed);
+			primitive.setTEOffset(face, face / 18.f, -0.25f);
+			primitive.setTERotation(face, face * 0.3f);
+			primitive.setTEBumpShinyFullbright(face, (U8)(face * 5));
+			primitive.setTEMediaTexGen(face, (U8)(face & 1));
+			primitive.setTEGlow(face, face / 16.f);
+		}
+	}
+}
+
+namespace tut
+{
+	struct llprimitive_te_data
+	{
+	};
+	typedef test_group<llprimitive_te_data> llprimitive_te_test;
+	typedef llprimitive_te_test::object llprimitive_te_object;
+	tut::llprimitive_te_test llprimitive_te_testcase("llprimitive_te");
+
+	template<> template<>
+		// a hand built block lands on the right faces, and applying it
+		// again calls no setters at all
+	void llprimitive_te_object::test<1>()
+	{
+		CountingPrimitive primitive;
+		primitive.setNumTEs(6);
+
+		LLUUID default_id("c228d1cf-4b5d-4ba8-84f4-899a0796aa97");
+		LLUUID face_id("4934f1bf-3b1f-cf4f-dbdf-a72550d05bc6");
+		U8 colors[4] = { 0, 0, 0, 0 };
+		F32 scale_s = 1.f;
+		F32 scale_t = 2.f;
+		S16 zero16 = 0;
+		U8 zero8 = 0;
+
+		// wire layout: one default image id plus an exception for face 0
+		U8 blob[256];
+		U8* cur_ptr = blob;
+		memcpy(cur_ptr, default_id.mData, 16);	/* Flawfinder: ignore */
+		cur_ptr += 16;
+		*cur_ptr++ = 0x01;
+		memcpy(cur_ptr, face_id.mData, 16);	/* Flawfinder: ignore */
+		cur_ptr += 16;
+		*cur_ptr++ = 0;
+		cur_ptr = pack_te_default(cur_ptr, colors, 4);
+		cur_ptr = pack_te_default(cur_ptr, &scale_s, 4);
+		cur_ptr = pack_te_default(cur_ptr, &scale_t, 4);
+		cur_ptr = pack_te_default(cur_ptr, &zero16, 2);
+		cur_ptr = pack_te_default(cur_ptr, &zero16, 2);
+		cur_ptr = pack_te_default(cur_ptr, &zero16, 2);
+		cur_ptr = pack_te_default(cur_ptr, &zero8, 1);
+		cur_ptr = pack_te_default(cur_ptr, &zero8, 1);
+		memcpy(cur_ptr, &zero8, 1);	/* Flawfinder: ignore */
+		cur_ptr++;
+
+		LLTEContents tec;
+		primitive.parseTEMessage(blob, (S32)(cur_ptr - blob), tec);
+		ensure_equals("face count", tec.mFaceCount, (U32)6);
+
+		ensure("first apply changes faces", primitive.applyParsedTEMessage(tec) != 0);
+		ensure_equals("first apply setters", primitive.mSetCount, 6 * SETTERS_PER_FACE);
+		ensure_equals("face 0 image", primitive.getTE(0)->getID(), face_id);
+		ensure_equals("face 5 image", primitive.getTE(5)->getID(), default_id);
+		ensure_equals("face 3 scale", primitive.getTE(3)->mScaleT, 2.f);
+		ensure("face 2 color", primitive.getTE(2)->getColor() == LLColor4::white);
+
+		primitive.mSetCount = 0;
+		ensure_equals("second apply changes", primitive.applyParsedTEMessage(tec), 0);
+		ensure_equals("second apply setters", primitive.mSetCount, 0);
+
+		// only the face that differs goes through the setters
+		tec.mGlow[2] = 0x80;
+		ensure("glow apply changes", primitive.applyParsedTEMessage(tec) != 0);
+		ensure_equals("glow apply setters", primitive.mSetCount, SETTERS_PER_FACE);
+		ensure_equals("face 2 glow", primitive.getTE(2)->getGlow(), (F32)0x80 / (F32)0xFF);
+	}
+
+	template<> template<>
+		// a null image id is always passed through, even when nothing
+		// else on the face changed
+	void llprimitive_te_object::test<2>()
+	{
+		CountingPrimitive source;
+		setup_plain_box(source, LLUUID::null);
+		CapturedTE captured;
+		capture_te(captured, source);
+
+		CountingPrimitive primitive;
+		primitive.setNumTEs(captured.mFaces);
+		apply_captured_te(primitive, captured);
+		primitive.mSetCount = 0;
+		apply_captured_te(primitive, captured);
+		ensure_equals("null image faces reapplied", primitive.mSetCount, 6 * SETTERS_PER_FACE);
+	}
+
+	template<> template<>
+		// applying packed blocks, every face changing versus an update
+		// resending the same block; timings are printed, not checked
+	void llprimitive_te_object::test<3>()
+	{
+		const S32 ITERATIONS = 20000;
+
+		LLPrimitive plain_a, plain_b, detailed_a, detailed_b;
+		setup_plain_box(plain_a, LLUUID("c228d1cf-4b5d-4ba8-84f4-899a0796aa97"));
+		setup_plain_box(plain_b, LLUUID("4934f1bf-3b1f-cf4f-dbdf-a72550d05bc6"));
+		setup_detailed_prim(detailed_a, 1);
+		setup_detailed_prim(detailed_b, 2);
+
+		CapturedTE captured[4];
+		capture_te(captured[0], plain_a);
+		capture_te(captured[1], plain_b);
+		capture_te(captured[2], detailed_a);
+		capture_te(captured[3], detailed_b);
+
+		const char* names[2] = { "6 face box", "9 face detailed" };
+		for (S32 kind = 0; kind < 2; ++kind)
+		{
+			CapturedTE& first = captured[kind * 2];
+			CapturedTE& second = captured[kind * 2 + 1];
+
+			CountingPrimitive primitive;
+			primitive.setNumTEs(first.mFaces);
+
+			LLTimer timer;
+			for (S32 i = 0; i < ITERATIONS; ++i)
+			{
+				apply_captured_te(primitive, (i & 1) ? second : first);
+			}
+			F32 changed_secs = timer.getElapsedTimeF32();
+			ensure_equals("changed setters", primitive.mSetCount,
+						  ITERATIONS * first.mFaces * SETTERS_PER_FACE);
+
+			primitive.mSetCount = 0;
+			timer.reset();
+			for (S32 i = 0; i < ITERATIONS; ++i)
+			{
+				apply_captured_te(primitive, second);
+			}
+			F32 unchanged_secs = timer.getElapsedTimeF32();
+			ensure_equals("unchanged setters", primitive.mSetCount, 0);
+
+			std::cout << "texture entry apply, " << names[kind] << ": changed "
+					  << (changed_secs * 1000000.f / ITERATIONS) << " us, unchanged "
+					  << (unchanged_secs * 1000000.f / ITERATIONS) << " us" << std::endl;
+		}
+	}
+}
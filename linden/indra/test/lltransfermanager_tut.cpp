@@ -0,0 +1,72 @@
+/** 
+ * @file lltransfermanager_tut.cpp
+ * @brief Tests for the transfer target request window
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "lltut.h"
+
+#include "lltransfermanager.h"
+
+namespace tut
+{
+	struct transfermanager_data
+	{
+	};
+	typedef test_group<transfermanager_data> transfermanager_test;
+	typedef transfermanager_test::object transfermanager_object;
+	tut::transfermanager_test transfermanager("transfermanager");
+
+	template<> template<>
+	void transfermanager_object::test<1>()
+	{
+		// Without samples the window falls back to the default.
+		S32 window = LLTransferTargetChannel::computeRequestWindow(0.f, 0.f, 0.f);
+		ensure_equals("no samples", window, LLTransferTargetChannel::computeRequestWindow(0.2f, 0.f, 1000.f));
+		ensure_equals("no rtt", window, LLTransferTargetChannel::computeRequestWindow(0.f, 50000.f, 1000.f));
+		ensure("default window in range", (window >= 4) && (window <= 32));
+	}
+
+	template<> template<>
+	void transfermanager_object::test<2>()
+	{
+		// Fast circuit, large transfers: one request over the minimum of 4,
+		// since any nonzero overlap rounds up to a whole request.
+		S32 small = LLTransferTargetChannel::computeRequestWindow(0.05f, 10000.f, 100000.f);
+		// Slow circuit, small transfers: more requests need to be in flight.
+		S32 large = LLTransferTargetChannel::computeRequestWindow(0.5f, 100000.f, 5000.f);
+		ensure("window grows with bandwidth-delay product", large > small);
+		ensure_equals("minimum plus one", small, 5);
+		ensure_equals("rtt * rate / size", large, 14);
+
+		// Absurd ratios are clamped.
+		ensure_equals("ceiling", LLTransferTargetChannel::computeRequestWindow(2.f, 1.0e9f, 1.f), 32);
+	}
+}
@@ -0,0 +1,131 @@
+/** 
+ * @file llxmlnode_tut.cpp
+ * @brief Tests for LLXMLNode copying and binary serialization
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+#include "lltut.h"
+
+#include <sstream>
+
+#include "llxmlnode.h"
+
+namespace
+{
+	const char TEST_XML[] =
+		"<floater name=\"test\" title=\"Test\" width=\"200\">\n"
+		"	<button name=\"zulu\" label=\"Z\" />\n"
+		"	<check_box name=\"alpha\" />\n"
+		"	<button name=\"mike\" label=\"M\">text</button>\n"
+		"	<panel name=\"nested\">\n"
+		"		<text name=\"inner\">hello</text>\n"
+		"	</panel>\n"
+		"</floater>\n";
+
+	std::string child_names(LLXMLNodePtr node)
+	{
+		std::string names;
+		for (LLXMLNodePtr child = node->getFirstChild(); child.notNull(); child = child->getNextSibling())
+		{
+			std::string name;
+			child->getAttributeString("name", name);
+			names += name + " ";
+		}
+		return names;
+	}
+
+	std::string to_xml(LLXMLNodePtr node)
+	{
+		std::ostringstream ostr;
+		node->writeToOstream(ostr);
+		return ostr.str();
+	}
+}
+
+namespace tut
+{
+	struct xmlnode_data
+	{
+		LLXMLNodePtr mRoot;
+
+		xmlnode_data()
+		{
+			LLXMLNode::parseBuffer(TEST_XML, sizeof(TEST_XML) - 1, mRoot, NULL);
+		}
+	};
+	typedef test_group<xmlnode_data> xmlnode_test;
+	typedef xmlnode_test::object xmlnode_object;
+	tut::xmlnode_test xmlnode("xmlnode");
+
+	template<> template<>
+	void xmlnode_object::test<1>()
+		// deepCopy keeps document order, not name order
+	{
+		ensure("parsed", mRoot.notNull() && mRoot->hasName("floater"));
+		ensure_equals("source order", child_names(mRoot), "zulu alpha mike nested ");
+
+		LLXMLNodePtr copy = mRoot->deepCopy();
+		ensure_equals("copy order", child_names(copy), "zulu alpha mike nested ");
+		ensure_equals("copy text", to_xml(copy), to_xml(mRoot));
+	}
+
+	template<> template<>
+	void xmlnode_object::test<2>()
+		// binary round trip reproduces the tree
+	{
+		std::ostringstream ostr;
+		mRoot->writeBinary(ostr);
+
+		std::istringstream istr(ostr.str());
+		LLXMLNodePtr loaded;
+		ensure("read back", LLXMLNode::readBinary(istr, loaded));
+		ensure_equals("order", child_names(loaded), "zulu alpha mike nested ");
+		ensure_equals("text", to_xml(loaded), to_xml(mRoot));
+
+		std::string title;
+		loaded->getAttributeString("title", title);
+		ensure_equals("attribute", title, "Test");
+	}
+
+	template<> template<>
+	void xmlnode_object::test<3>()
+		// truncated input is rejected rather than half loaded
+	{
+		std::ostringstream ostr;
+		mRoot->writeBinary(ostr);
+		std::string data = ostr.str();
+
+		std::istringstream istr(data.substr(0, data.size() / 2));
+		LLXMLNodePtr loaded;
+		ensure("truncated", !LLXMLNode::readBinary(istr, loaded));
+		ensure("untouched", loaded.isNull());
+	}
+}